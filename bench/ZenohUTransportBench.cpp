@@ -0,0 +1,563 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Throughput and latency harness for ZenohUTransport.
+//
+// A "ping" side publishes messages and sends RPC requests that an "echo"
+// side sends straight back, so every figure is measured on the clock of the
+// ping side, whichever host the echo side runs on. Results are printed to
+// stdout as one JSON object per line. See the Benchmarks section of
+// README.md for how to run the in-process, inter-process and routed set-ups.
+
+#include <up-transport-zenoh-cpp/ZenohUTransport.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace uprotocol;
+using Clock = std::chrono::steady_clock;
+
+// Exposes sendImpl(), skipping the message checks of UTransport::send(),
+// so that only the transport itself is measured
+struct BenchTransport : public transport::ZenohUTransport {
+	using transport::ZenohUTransport::sendImpl;
+	using transport::ZenohUTransport::ZenohUTransport;
+};
+
+constexpr std::string_view AUTHORITY = "bench";
+constexpr uint32_t PING_ENTITY = 0x1000;
+constexpr uint32_t ECHO_ENTITY = 0x2000;
+constexpr uint32_t TOPIC_ID = 0x8001;
+constexpr uint32_t METHOD_ID = 0x0001;
+
+// Every payload starts with its sequence number
+constexpr size_t MIN_PAYLOAD_SIZE = sizeof(uint64_t);
+
+v1::UUri makeUri(uint32_t ue_id, uint32_t resource_id) {
+	v1::UUri uri;
+	uri.set_authority_name(std::string(AUTHORITY));
+	uri.set_ue_id(ue_id);
+	uri.set_ue_version_major(1);
+	uri.set_resource_id(resource_id);
+	return uri;
+}
+
+// A UUIDv8 that is unique within the process
+v1::UUID nextId() {
+	static std::atomic<uint64_t> counter{0};
+	const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+	const auto unix_ms =
+	    std::chrono::duration_cast<std::chrono::milliseconds>(since_epoch)
+	        .count();
+	v1::UUID id;
+	id.set_msb((static_cast<uint64_t>(unix_ms) << 16U) | 0x8000U);
+	id.set_lsb((uint64_t{2} << 62U) | counter.fetch_add(1));
+	return id;
+}
+
+std::string makePayload(size_t size, uint64_t sequence) {
+	std::string payload(std::max(size, MIN_PAYLOAD_SIZE), 'x');
+	std::memcpy(payload.data(), &sequence, sizeof(sequence));
+	return payload;
+}
+
+uint64_t sequenceOf(const std::string& payload) {
+	uint64_t sequence = 0;
+	if (payload.size() >= sizeof(sequence)) {
+		std::memcpy(&sequence, payload.data(), sizeof(sequence));
+	}
+	return sequence;
+}
+
+// Sent with a blocking congestion control, so that bursts are slowed down
+// rather than dropped
+constexpr auto PRIORITY = v1::UPriority::UPRIORITY_CS4;
+
+v1::UMessage makePublish(const v1::UUri& topic, std::string payload) {
+	v1::UMessage message;
+	auto* attributes = message.mutable_attributes();
+	attributes->set_type(v1::UMessageType::UMESSAGE_TYPE_PUBLISH);
+	*attributes->mutable_id() = nextId();
+	attributes->set_priority(PRIORITY);
+	*attributes->mutable_source() = topic;
+	message.set_payload(std::move(payload));
+	return message;
+}
+
+v1::UMessage makeRequest(const v1::UUri& source, const v1::UUri& method,
+                         std::string payload, uint32_t ttl_ms) {
+	v1::UMessage message;
+	auto* attributes = message.mutable_attributes();
+	attributes->set_type(v1::UMessageType::UMESSAGE_TYPE_REQUEST);
+	*attributes->mutable_id() = nextId();
+	attributes->set_priority(PRIORITY);
+	attributes->set_ttl(ttl_ms);
+	*attributes->mutable_source() = source;
+	*attributes->mutable_sink() = method;
+	message.set_payload(std::move(payload));
+	return message;
+}
+
+v1::UMessage makeResponse(const v1::UMessage& request) {
+	v1::UMessage message;
+	auto* attributes = message.mutable_attributes();
+	attributes->set_type(v1::UMessageType::UMESSAGE_TYPE_RESPONSE);
+	*attributes->mutable_id() = nextId();
+	attributes->set_priority(request.attributes().priority());
+	*attributes->mutable_reqid() = request.attributes().id();
+	*attributes->mutable_source() = request.attributes().sink();
+	*attributes->mutable_sink() = request.attributes().source();
+	message.set_payload(request.payload());
+	return message;
+}
+
+struct Options {
+	enum class Role { LOCAL, PING, ECHO };
+
+	Role role{Role::LOCAL};
+	std::filesystem::path config{std::filesystem::path(BENCH_CONFIG_DIR) /
+	                             "InProcess.json5"};
+	std::string label{"in_process"};
+	std::vector<size_t> payload_sizes{16, 256, 4096, 65536, 1048576};
+	size_t samples{1000};
+	size_t messages{10000};
+	std::chrono::milliseconds timeout{5000};
+};
+
+void usage(const char* program) {
+	std::cerr
+	    << "Usage: " << program << " [options]\n"
+	    << "  --role local|ping|echo  local runs both sides in this process "
+	       "(default local)\n"
+	    << "  --config FILE           Zenoh configuration of this process\n"
+	    << "  --label NAME            Set-up name written with each result\n"
+	    << "  --payload-sizes N,N,... Payload sizes in bytes\n"
+	    << "  --samples N             Round trips per latency measurement\n"
+	    << "  --messages N            Messages per throughput measurement\n"
+	    << "  --timeout-ms N          Longest wait for one echo\n";
+}
+
+std::optional<size_t> parseSize(std::string_view text) {
+	size_t value = 0;
+	if (text.empty()) {
+		return std::nullopt;
+	}
+	for (const auto digit : text) {
+		if ((digit < '0') || (digit > '9')) {
+			return std::nullopt;
+		}
+		value = (value * 10) + static_cast<size_t>(digit - '0');
+	}
+	return value;
+}
+
+std::optional<Options> parseOptions(int argc, char** argv) {
+	Options options;
+	bool labelled = false;
+	for (int i = 1; i < argc; i += 2) {
+		const std::string_view name = argv[i];
+		if (i + 1 >= argc) {
+			return std::nullopt;
+		}
+		const std::string_view value = argv[i + 1];
+
+		if (name == "--role") {
+			if (value == "local") {
+				options.role = Options::Role::LOCAL;
+			} else if (value == "ping") {
+				options.role = Options::Role::PING;
+			} else if (value == "echo") {
+				options.role = Options::Role::ECHO;
+			} else {
+				return std::nullopt;
+			}
+		} else if (name == "--config") {
+			options.config = value;
+		} else if (name == "--label") {
+			options.label = value;
+			labelled = true;
+		} else if (name == "--payload-sizes") {
+			options.payload_sizes.clear();
+			std::istringstream list{std::string(value)};
+			for (std::string item; std::getline(list, item, ',');) {
+				auto size = parseSize(item);
+				if (!size) {
+					return std::nullopt;
+				}
+				options.payload_sizes.push_back(*size);
+			}
+		} else if (auto number = parseSize(value)) {
+			if (name == "--samples") {
+				options.samples = *number;
+			} else if (name == "--messages") {
+				options.messages = *number;
+			} else if (name == "--timeout-ms") {
+				options.timeout = std::chrono::milliseconds(*number);
+			} else {
+				return std::nullopt;
+			}
+		} else {
+			return std::nullopt;
+		}
+	}
+	if (!labelled && (options.role != Options::Role::LOCAL)) {
+		options.label = options.config.stem().string();
+	}
+	return options;
+}
+
+// Sends everything it receives back to the ping side
+class Echo {
+public:
+	explicit Echo(BenchTransport& transport) : transport_(transport) {
+		const auto pong = makeUri(ECHO_ENTITY, TOPIC_ID);
+		auto topic = transport_.registerListener(
+		    makeUri(PING_ENTITY, TOPIC_ID),
+		    [this, pong](const v1::UMessage& message) {
+			    reply(makePublish(pong, message.payload()));
+		    });
+		auto method = transport_.registerListener(
+		    makeUri(ECHO_ENTITY, METHOD_ID),
+		    [this](const v1::UMessage& request) {
+			    reply(makeResponse(request));
+		    });
+		if (!topic || !method) {
+			throw std::runtime_error("Failed to register the echo listeners");
+		}
+		handles_.push_back(std::move(topic.value()));
+		handles_.push_back(std::move(method.value()));
+	}
+
+private:
+	void reply(const v1::UMessage& message) {
+		auto status = transport_.sendImpl(message);
+		if (status.code() != v1::UCode::OK) {
+			std::cerr << "Echo failed: " << status.message() << "\n";
+		}
+	}
+
+	BenchTransport& transport_;
+	std::vector<transport::ZenohUTransport::ListenHandle> handles_;
+};
+
+// Echoes received by the ping side
+class Arrivals {
+public:
+	void add(const v1::UMessage& message) {
+		std::lock_guard lock(mutex_);
+		last_sequence_ = sequenceOf(message.payload());
+		++count_;
+		cv_.notify_all();
+	}
+
+	bool waitForSequence(uint64_t sequence, Clock::duration timeout) {
+		std::unique_lock lock(mutex_);
+		return cv_.wait_for(lock, timeout, [this, sequence]() {
+			return last_sequence_ == sequence;
+		});
+	}
+
+	bool waitForCount(size_t count, Clock::duration timeout) {
+		std::unique_lock lock(mutex_);
+		return cv_.wait_for(lock, timeout,
+		                    [this, count]() { return count_ >= count; });
+	}
+
+	size_t count() {
+		std::lock_guard lock(mutex_);
+		return count_;
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	uint64_t last_sequence_{0};
+	size_t count_{0};
+};
+
+struct Latency {
+	std::vector<Clock::duration> round_trips;
+	size_t lost{0};
+};
+
+struct Throughput {
+	size_t sent{0};
+	size_t received{0};
+	Clock::duration elapsed{};
+};
+
+class Ping {
+public:
+	Ping(BenchTransport& transport, const Options& options)
+	    : transport_(transport), options_(options) {
+		auto pong = transport_.registerListener(
+		    makeUri(ECHO_ENTITY, TOPIC_ID),
+		    [this](const v1::UMessage& message) { pongs_.add(message); });
+		auto responses = transport_.registerListener(
+		    transport_.getDefaultSource(),
+		    [this](const v1::UMessage& message) { responses_.add(message); });
+		if (!pong || !responses) {
+			throw std::runtime_error("Failed to register the ping listeners");
+		}
+		handles_.push_back(std::move(pong.value()));
+		handles_.push_back(std::move(responses.value()));
+	}
+
+	/// Waits for the echo side to be reachable, which can take a while
+	/// once Zenoh has to discover a peer or go through a router
+	bool waitForEcho(Clock::duration timeout) {
+		const auto deadline = Clock::now() + timeout;
+		while (Clock::now() < deadline) {
+			if (roundTrip(false, MIN_PAYLOAD_SIZE,
+			              std::chrono::milliseconds(100))) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	Latency measureLatency(bool rpc, size_t payload_size) {
+		Latency latency;
+		latency.round_trips.reserve(options_.samples);
+		// Warms up the publisher cache and the arenas
+		for (size_t i = 0; i < std::min<size_t>(options_.samples, 100); ++i) {
+			roundTrip(rpc, payload_size, options_.timeout);
+		}
+		for (size_t i = 0; i < options_.samples; ++i) {
+			if (auto round_trip =
+			        roundTrip(rpc, payload_size, options_.timeout)) {
+				latency.round_trips.push_back(*round_trip);
+			} else {
+				++latency.lost;
+			}
+		}
+		return latency;
+	}
+
+	Throughput measureThroughput(size_t payload_size) {
+		// Payloads are built ahead, so that only sending is timed
+		std::vector<v1::UMessage> messages;
+		messages.reserve(options_.messages);
+		for (size_t i = 0; i < options_.messages; ++i) {
+			messages.push_back(makePublish(
+			    makeUri(PING_ENTITY, TOPIC_ID),
+			    makePayload(payload_size, next_sequence_++)));
+		}
+
+		Throughput throughput;
+		const auto first = pongs_.count();
+		const auto start = Clock::now();
+		for (const auto& message : messages) {
+			if (transport_.sendImpl(message).code() == v1::UCode::OK) {
+				++throughput.sent;
+			}
+		}
+		// Waits as long as the echoes keep coming
+		auto received = first;
+		while (!pongs_.waitForCount(first + throughput.sent,
+		                            options_.timeout)) {
+			const auto now_received = pongs_.count();
+			if (now_received == received) {
+				break;
+			}
+			received = now_received;
+		}
+		throughput.elapsed = Clock::now() - start;
+		throughput.received = pongs_.count() - first;
+		return throughput;
+	}
+
+private:
+	std::optional<Clock::duration> roundTrip(bool rpc, size_t payload_size,
+	                                         Clock::duration timeout) {
+		const auto sequence = next_sequence_++;
+		auto payload = makePayload(payload_size, sequence);
+		auto message =
+		    rpc ? makeRequest(transport_.getDefaultSource(),
+		                      makeUri(ECHO_ENTITY, METHOD_ID),
+		                      std::move(payload),
+		                      static_cast<uint32_t>(options_.timeout.count()))
+		        : makePublish(makeUri(PING_ENTITY, TOPIC_ID),
+		                      std::move(payload));
+		auto& arrivals = rpc ? responses_ : pongs_;
+
+		const auto start = Clock::now();
+		if (transport_.sendImpl(message).code() != v1::UCode::OK) {
+			return std::nullopt;
+		}
+		if (!arrivals.waitForSequence(sequence, timeout)) {
+			return std::nullopt;
+		}
+		return Clock::now() - start;
+	}
+
+	BenchTransport& transport_;
+	const Options& options_;
+	Arrivals pongs_;
+	Arrivals responses_;
+	uint64_t next_sequence_{1};
+	std::vector<transport::ZenohUTransport::ListenHandle> handles_;
+};
+
+int64_t nanoseconds(Clock::duration duration) {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(duration)
+	    .count();
+}
+
+// Nearest-rank percentile of sorted samples
+Clock::duration percentile(const std::vector<Clock::duration>& sorted,
+                           double fraction) {
+	if (sorted.empty()) {
+		return {};
+	}
+	auto rank = static_cast<size_t>(
+	    std::ceil(fraction * static_cast<double>(sorted.size())));
+	return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void printLatency(const Options& options, std::string_view scenario,
+                  size_t payload_size, Latency&& latency) {
+	auto& round_trips = latency.round_trips;
+	std::sort(round_trips.begin(), round_trips.end());
+	Clock::duration total{};
+	for (const auto& round_trip : round_trips) {
+		total += round_trip;
+	}
+	const auto mean =
+	    round_trips.empty()
+	        ? Clock::duration{}
+	        : total / static_cast<Clock::rep>(round_trips.size());
+
+	std::cout << "{\"scenario\":\"" << scenario << "\",\"label\":\""
+	          << options.label << "\",\"payload_size\":" << payload_size
+	          << ",\"samples\":" << round_trips.size()
+	          << ",\"lost\":" << latency.lost << ",\"min_ns\":"
+	          << nanoseconds(round_trips.empty() ? Clock::duration{}
+	                                             : round_trips.front())
+	          << ",\"mean_ns\":" << nanoseconds(mean)
+	          << ",\"p50_ns\":" << nanoseconds(percentile(round_trips, 0.5))
+	          << ",\"p99_ns\":" << nanoseconds(percentile(round_trips, 0.99))
+	          << ",\"p999_ns\":" << nanoseconds(percentile(round_trips, 0.999))
+	          << ",\"max_ns\":"
+	          << nanoseconds(round_trips.empty() ? Clock::duration{}
+	                                             : round_trips.back())
+	          << "}" << std::endl;
+}
+
+void printThroughput(const Options& options, size_t payload_size,
+                     const Throughput& throughput) {
+	const double seconds =
+	    std::chrono::duration<double>(throughput.elapsed).count();
+	const double rate =
+	    (seconds > 0) ? static_cast<double>(throughput.received) / seconds
+	                  : 0;
+	std::cout << "{\"scenario\":\"pubsub_throughput\",\"label\":\""
+	          << options.label << "\",\"payload_size\":" << payload_size
+	          << ",\"sent\":" << throughput.sent
+	          << ",\"received\":" << throughput.received
+	          << ",\"elapsed_ns\":" << nanoseconds(throughput.elapsed)
+	          << ",\"messages_per_second\":" << static_cast<uint64_t>(rate)
+	          << ",\"bytes_per_second\":"
+	          << static_cast<uint64_t>(
+	                 rate * static_cast<double>(
+	                            std::max(payload_size, MIN_PAYLOAD_SIZE)))
+	          << "}" << std::endl;
+}
+
+int runPing(BenchTransport& transport, const Options& options) {
+	Ping ping(transport, options);
+	if (!ping.waitForEcho(std::chrono::seconds(10))) {
+		std::cerr << "No echo side answered\n";
+		return EXIT_FAILURE;
+	}
+	for (const auto payload_size : options.payload_sizes) {
+		printLatency(options, "pubsub_latency", payload_size,
+		             ping.measureLatency(false, payload_size));
+		printThroughput(options, payload_size,
+		                ping.measureThroughput(payload_size));
+		printLatency(options, "rpc_round_trip", payload_size,
+		             ping.measureLatency(true, payload_size));
+	}
+	return EXIT_SUCCESS;
+}
+
+volatile std::sig_atomic_t stopping = 0;
+
+void onSignal(int /* signal */) { stopping = 1; }
+
+int runEcho(BenchTransport& transport) {
+	Echo echo(transport);
+	std::signal(SIGINT, onSignal);
+	std::signal(SIGTERM, onSignal);
+	while (stopping == 0) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	}
+	return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+	auto options = parseOptions(argc, argv);
+	if (!options) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	try {
+		switch (options->role) {
+			case Options::Role::LOCAL: {
+				// Two entities in one process, each with its own transport
+				BenchTransport echo_transport(makeUri(ECHO_ENTITY, 0),
+				                              options->config);
+				BenchTransport ping_transport(makeUri(PING_ENTITY, 0),
+				                              options->config);
+				Echo echo(echo_transport);
+				return runPing(ping_transport, *options);
+			}
+			case Options::Role::PING: {
+				BenchTransport transport(makeUri(PING_ENTITY, 0),
+				                         options->config);
+				return runPing(transport, *options);
+			}
+			case Options::Role::ECHO: {
+				BenchTransport transport(makeUri(ECHO_ENTITY, 0),
+				                         options->config);
+				return runEcho(transport);
+			}
+		}
+	} catch (const zenoh::ErrorMessage& error) {
+		std::cerr << "Benchmark failed: " << error.as_string_view() << "\n";
+	} catch (const std::exception& error) {
+		std::cerr << "Benchmark failed: " << error.what() << "\n";
+	}
+	return EXIT_FAILURE;
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_ARENAPOOL_H
+#define UP_TRANSPORT_ZENOH_CPP_ARENAPOOL_H
+
+#include <google/protobuf/arena.h>
+#include <up-transport-zenoh-cpp/BoundedQueue.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Fixed set of protobuf arenas that are reset and reused once the
+///        messages allocated on them are no longer needed.
+///
+/// Each arena starts on a block owned by the pool, which survives a reset.
+/// Messages that fit in that block are built without calling malloc at all.
+/// When every arena is in use, acquire() falls back to a fresh arena on the
+/// heap, freed once it is released.
+///
+/// @remarks acquire() and releasing leases are safe from any thread.
+class ArenaPool {
+	struct Slot;
+
+public:
+	/// @brief Shared handle on an arena. When the last copy is destroyed,
+	///        the arena is reset and returned to its pool.
+	class Lease {
+	public:
+		Lease() = default;
+		Lease(const Lease& other);
+		Lease(Lease&& other) noexcept;
+		Lease& operator=(const Lease& other);
+		Lease& operator=(Lease&& other) noexcept;
+		~Lease();
+
+		[[nodiscard]] google::protobuf::Arena* get() const;
+
+		explicit operator bool() const { return slot_ != nullptr; }
+
+	private:
+		friend class ArenaPool;
+
+		explicit Lease(Slot* slot);
+
+		void release_();
+
+		Slot* slot_{nullptr};
+	};
+
+	/// @param arenas Number of pooled arenas. Zero disables pooling, and
+	///               every lease gets an arena of its own.
+	/// @param block_size Size (in bytes) of the block each pooled arena
+	///                   starts on.
+	ArenaPool(size_t arenas, size_t block_size);
+
+	/// @remarks Every lease must have been released.
+	~ArenaPool();
+
+	ArenaPool(const ArenaPool&) = delete;
+	ArenaPool& operator=(const ArenaPool&) = delete;
+
+	/// @brief Take a pooled arena, or a new one if they are all leased.
+	Lease acquire();
+
+	/// @brief Number of pooled arenas not currently leased.
+	[[nodiscard]] size_t available() const { return free_.size(); }
+
+private:
+	struct Slot {
+		/// @brief Pool the slot returns to, or nullptr if it was allocated
+		///        because the pool was exhausted.
+		ArenaPool* pool{nullptr};
+		std::unique_ptr<char[]> block;
+		std::optional<google::protobuf::Arena> arena;
+		std::atomic<size_t> leases{0};
+	};
+
+	void release_(Slot* slot);
+
+	std::vector<std::unique_ptr<Slot>> slots_;
+	BoundedQueue<Slot*> free_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_ARENAPOOL_H
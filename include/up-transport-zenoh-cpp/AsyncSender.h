@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_ASYNCSENDER_H
+#define UP_TRANSPORT_ZENOH_CPP_ASYNCSENDER_H
+
+#include <up-transport-zenoh-cpp/BoundedQueue.h>
+#include <up-transport-zenoh-cpp/KeyExprTable.h>
+#include <up-transport-zenoh-cpp/ThreadPlacement.h>
+#include <up-transport-zenoh-cpp/TransportConfig.h>
+#include <uprotocol/v1/umessage.pb.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace uprotocol::transport {
+
+/// @brief Queue of outgoing messages drained by a dedicated I/O thread.
+///
+/// Submitting a message costs a copy and a lock-free push. The I/O thread
+/// sleeps while the queue is empty and is only woken (under a mutex) when
+/// it actually sleeps, so a busy sender never touches the mutex.
+class AsyncSender {
+public:
+	/// @brief A message waiting to be published, with its destination key
+	///        already resolved by the submitting thread.
+	struct Item {
+		std::shared_ptr<const InternedKeyExpr> zenoh_key;
+		v1::UMessage message;
+	};
+
+	/// @brief Called on the I/O thread to publish each item.
+	using Publish = std::function<void(const Item&)>;
+
+	struct Stats {
+		/// @brief Messages currently waiting in the queue.
+		size_t queued{0};
+		/// @brief Messages discarded by the "drop_oldest" policy.
+		uint64_t dropped{0};
+		/// @brief Messages refused by the "fail_fast" policy.
+		uint64_t rejected{0};
+		size_t capacity{0};
+	};
+
+	/// @brief Start the I/O thread.
+	///
+	/// @param placement Where the I/O thread runs.
+	AsyncSender(const TransportConfig::AsyncSend& config, Publish publish,
+	            const ThreadPlacement& placement = {});
+
+	/// @brief Publish everything still queued, then stop the I/O thread.
+	~AsyncSender();
+
+	AsyncSender(const AsyncSender&) = delete;
+	AsyncSender& operator=(const AsyncSender&) = delete;
+
+	/// @brief Queue an item, applying the overflow policy if the queue is
+	///        full.
+	///
+	/// @returns false if the item was refused, true otherwise (including
+	///          when an older item was dropped to make room).
+	bool submit(Item&& item);
+
+	[[nodiscard]] Stats stats() const;
+
+private:
+	using Overflow = TransportConfig::AsyncSend::Overflow;
+
+	void run_();
+	void waitForSpace_();
+	void wakeSender_();
+	void wakeSubmitters_();
+
+	BoundedQueue<Item> queue_;
+	const Overflow overflow_;
+	const Publish publish_;
+
+	std::atomic<uint64_t> dropped_{0};
+	std::atomic<uint64_t> rejected_{0};
+
+	// Only used to sleep: the queue itself is lock-free
+	std::mutex wait_mutex_;
+	std::condition_variable items_available_;
+	std::condition_variable space_available_;
+	std::atomic<bool> sender_waiting_{false};
+	std::atomic<size_t> submitters_waiting_{0};
+	std::atomic<bool> stopping_{false};
+
+	// Last, so the thread starts after everything it uses is initialized
+	std::thread thread_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_ASYNCSENDER_H
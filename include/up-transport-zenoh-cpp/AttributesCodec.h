@@ -0,0 +1,67 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_ATTRIBUTESCODEC_H
+#define UP_TRANSPORT_ZENOH_CPP_ATTRIBUTESCODEC_H
+
+#include <uprotocol/v1/uattributes.pb.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace uprotocol::transport {
+
+/// @brief Encodes the UAttributes carried in a Zenoh attachment.
+///
+/// The attachment holds two entries: a one-byte format version, followed by
+/// the encoded attributes. Receivers accept every format listed here, so a
+/// sender can pick one without coordinating with its peers.
+struct AttributesCodec {
+	/// @brief Wire format of the attributes (the attachment version byte)
+	enum class Format : uint8_t {
+		/// @brief Serialized v1::UAttributes protobuf. Understood by every
+		///        uProtocol Zenoh transport.
+		PROTOBUF = 1,
+		/// @brief Fixed-layout little-endian header followed by the string
+		///        fields. Encoding and decoding are a handful of stores and
+		///        loads, with no protobuf involved. Only understood by this
+		///        transport.
+		COMPACT = 2
+	};
+
+	/// @brief Encode attributes in the given format.
+	static std::string encode(const v1::UAttributes& attributes,
+	                          Format format);
+
+	/// @brief Decode attributes.
+	///
+	/// @param version Attachment version byte, naming the format.
+	/// @param data Encoded attributes.
+	///
+	/// @returns The attributes, or std::nullopt if the version is unknown or
+	///          the data is malformed.
+	static std::optional<v1::UAttributes> decode(uint8_t version,
+	                                             std::string_view data);
+
+	/// @brief Decode attributes into an existing, empty message, such as
+	///        one allocated on an arena.
+	///
+	/// @returns false if the version is unknown or the data is malformed,
+	///          in which case attributes may be partially filled.
+	static bool decode(uint8_t version, std::string_view data,
+	                   v1::UAttributes& attributes);
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_ATTRIBUTESCODEC_H
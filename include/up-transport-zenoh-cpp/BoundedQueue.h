@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_BOUNDEDQUEUE_H
+#define UP_TRANSPORT_ZENOH_CPP_BOUNDEDQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace uprotocol::transport {
+
+/// @brief Fixed-capacity FIFO queue that never takes a lock.
+///
+/// Any number of threads may push and pop concurrently. Each slot carries a
+/// sequence number telling whether it is free for the next push or holds a
+/// value for the next pop, so a push or pop is one compare-and-swap on the
+/// shared position plus a release store on the slot (D. Vyukov's bounded
+/// MPMC queue).
+///
+/// @remarks The capacity is rounded up to a power of two, and is at least
+///          two: with a single slot, a full slot and a free one would carry
+///          the same sequence number.
+template <typename T>
+class BoundedQueue {
+public:
+	/// @param capacity Minimum number of values the queue can hold.
+	explicit BoundedQueue(size_t capacity)
+	    : mask_(roundUp(capacity) - 1),
+	      slots_(std::make_unique<Slot[]>(mask_ + 1)) {
+		for (size_t i = 0; i <= mask_; ++i) {
+			slots_[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	BoundedQueue(const BoundedQueue&) = delete;
+	BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+	/// @brief Add a value at the back of the queue.
+	///
+	/// @returns true if the value was moved into the queue, false if the
+	///          queue is full, in which case value is left untouched.
+	bool tryPush(T& value) {
+		auto position = tail_.load(std::memory_order_relaxed);
+		for (;;) {
+			auto& slot = slots_[position & mask_];
+			const auto sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto lag = static_cast<intptr_t>(sequence - position);
+			if (lag == 0) {
+				if (tail_.compare_exchange_weak(position, position + 1,
+				                                std::memory_order_relaxed)) {
+					slot.value.emplace(std::move(value));
+					slot.sequence.store(position + 1,
+					                    std::memory_order_release);
+					return true;
+				}
+			} else if (lag < 0) {
+				return false;
+			} else {
+				position = tail_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/// @brief Remove the value at the front of the queue.
+	///
+	/// @returns The value, or std::nullopt if the queue is empty.
+	std::optional<T> tryPop() {
+		auto position = head_.load(std::memory_order_relaxed);
+		for (;;) {
+			auto& slot = slots_[position & mask_];
+			const auto sequence = slot.sequence.load(std::memory_order_acquire);
+			const auto lag = static_cast<intptr_t>(sequence - (position + 1));
+			if (lag == 0) {
+				if (head_.compare_exchange_weak(position, position + 1,
+				                                std::memory_order_relaxed)) {
+					std::optional<T> value(std::move(slot.value));
+					slot.value.reset();
+					slot.sequence.store(position + mask_ + 1,
+					                    std::memory_order_release);
+					return value;
+				}
+			} else if (lag < 0) {
+				return std::nullopt;
+			} else {
+				position = head_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/// @brief Number of values in the queue. Only a snapshot when other
+	///        threads are pushing or popping.
+	[[nodiscard]] size_t size() const {
+		const auto head = head_.load(std::memory_order_acquire);
+		const auto tail = tail_.load(std::memory_order_acquire);
+		return (tail > head) ? (tail - head) : 0;
+	}
+
+	[[nodiscard]] bool empty() const { return size() == 0; }
+
+	[[nodiscard]] bool full() const { return size() >= capacity(); }
+
+	[[nodiscard]] size_t capacity() const { return mask_ + 1; }
+
+private:
+	// Keeps the positions updated by producers and consumers, and each slot,
+	// on separate cache lines
+	static constexpr size_t CACHE_LINE_SIZE = 64;
+
+	struct alignas(CACHE_LINE_SIZE) Slot {
+		std::atomic<size_t> sequence{0};
+		std::optional<T> value;
+	};
+
+	static size_t roundUp(size_t capacity) {
+		size_t rounded = 2;
+		while (rounded < capacity) {
+			rounded <<= 1U;
+		}
+		return rounded;
+	}
+
+	const size_t mask_;
+	std::unique_ptr<Slot[]> slots_;
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> head_{0};
+	alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail_{0};
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_BOUNDEDQUEUE_H
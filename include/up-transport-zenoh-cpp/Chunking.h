@@ -0,0 +1,133 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_CHUNKING_H
+#define UP_TRANSPORT_ZENOH_CPP_CHUNKING_H
+
+#include <up-transport-zenoh-cpp/PendingRequests.h>
+#include <uprotocol/v1/umessage.pb.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace uprotocol::transport {
+
+/// @brief Position of one chunk within a message sent in chunks.
+///
+/// Carried as a third attachment entry after the UAttributes. Every chunk
+/// of a message carries the same attributes, including the message ID the
+/// chunks are reassembled under.
+struct ChunkHeader {
+	/// @brief Size (in bytes) of an encoded header.
+	static constexpr size_t ENCODED_SIZE = (2 * 4) + (2 * 8);
+
+	/// @brief Position of the chunk, from 0 to count - 1.
+	uint32_t index{0};
+	/// @brief Number of chunks in the message.
+	uint32_t count{1};
+	/// @brief Position of the chunk's first byte in the whole payload.
+	uint64_t offset{0};
+	/// @brief Size (in bytes) of the whole payload.
+	uint64_t total_size{0};
+
+	/// @brief Encode the header as fixed-layout little-endian fields.
+	[[nodiscard]] std::string encode() const;
+
+	/// @returns The header, or std::nullopt if the data is malformed.
+	static std::optional<ChunkHeader> decode(std::string_view data);
+};
+
+/// @brief One piece of a received message, as seen by a chunk listener.
+struct MessageChunk {
+	/// @brief The message attributes, with this chunk as its payload.
+	const v1::UMessage& message;
+	const ChunkHeader& header;
+};
+
+/// @brief Reassembles payloads received in chunks.
+///
+/// Chunks must arrive in order, as Zenoh delivers them from one publisher.
+/// A missing chunk abandons its message, and so does running past its
+/// expiry. Payloads grow as their chunks arrive, and the sizes they
+/// announce are counted against a limit on the messages pending at once,
+/// so that a burst of first chunks cannot tie up unbounded memory.
+///
+/// @remarks Thread-safe.
+class ChunkAssembler {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// @param max_size Largest payload that is reassembled. Messages
+	///                 announcing a larger one are dropped.
+	/// @param max_pending_size Largest total size announced by the
+	///                         messages partially received at once.
+	/// @param max_pending_messages Most messages partially received at
+	///                             once.
+	///
+	/// @remarks New messages past either limit are dropped until pending
+	///          ones complete or expire.
+	explicit ChunkAssembler(
+	    size_t max_size,
+	    size_t max_pending_size = std::numeric_limits<size_t>::max(),
+	    size_t max_pending_messages = std::numeric_limits<size_t>::max());
+
+	/// @brief Add a chunk of the message with the given ID.
+	///
+	/// @param expiry When to give up on the message if chunks are still
+	///               missing. Only read from its first chunk.
+	/// @param dropped If not null, set to whether the chunk made the
+	///                message be dropped, for being too large, past the
+	///                pending limits or out of sequence.
+	///
+	/// @returns The whole payload once its last chunk has been added, or
+	///          std::nullopt until then (or if the chunk is dropped).
+	std::optional<std::string> add(const v1::UUID& id,
+	                               const ChunkHeader& header,
+	                               std::string_view data,
+	                               Clock::time_point expiry,
+	                               bool* dropped = nullptr);
+
+	/// @brief Number of messages partially received.
+	[[nodiscard]] size_t pending() const;
+
+	/// @brief Total size (in bytes) announced by the messages partially
+	///        received.
+	[[nodiscard]] size_t pendingSize() const;
+
+private:
+	struct Partial {
+		std::string payload;
+		uint64_t total_size{0};
+		uint32_t next_index{0};
+		Clock::time_point expiry;
+	};
+
+	/// @brief Put a partial message back in the table.
+	void park_(const v1::UUID& id, Partial&& partial);
+
+	const size_t max_size_;
+	const size_t max_pending_size_;
+	const size_t max_pending_messages_;
+	PendingRequests<Partial> partials_;
+	/// @brief Sum of the total sizes of the messages in partials_.
+	size_t pending_size_{0};
+	mutable std::mutex mutex_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_CHUNKING_H
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_COMPRESSION_H
+#define UP_TRANSPORT_ZENOH_CPP_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace uprotocol::transport {
+
+struct Compression {
+	/// @brief Algorithm a payload is compressed with.
+	enum class Codec : uint8_t {
+		NONE = 0,
+		/// @brief LZ4 block format. Fast, with a modest ratio. Requires
+		///        building with UP_TRANSPORT_ZENOH_ENABLE_LZ4.
+		LZ4 = 1,
+		/// @brief Zstandard frame format. Slower, with a better ratio.
+		///        Requires building with UP_TRANSPORT_ZENOH_ENABLE_ZSTD.
+		ZSTD = 2
+	};
+
+	/// @brief How a compressed payload was compressed. Carried as an
+	///        attachment entry.
+	struct Header {
+		/// @brief Size (in bytes) of an encoded header.
+		static constexpr size_t ENCODED_SIZE = 1 + 8;
+
+		Codec codec{Codec::NONE};
+		/// @brief Size (in bytes) of the payload once decompressed.
+		uint64_t size{0};
+
+		/// @brief Encode the header as the codec byte followed by the size,
+		///        little-endian.
+		[[nodiscard]] std::string encode() const;
+
+		/// @returns The header, or std::nullopt if the data is malformed.
+		static std::optional<Header> decode(std::string_view data);
+	};
+
+	/// @brief Check whether support for a codec was built in.
+	static bool isAvailable(Codec codec);
+
+	/// @brief Check whether a codec supports a compression level.
+	///
+	/// @returns true for 0, and for any level of a codec that takes none
+	///          or was not built in.
+	static bool isValidLevel(Codec codec, int level);
+
+	/// @brief Compress data.
+	///
+	/// @param level Compression level for ZSTD, or 0 for its default.
+	///              Negative levels are its faster modes. Ignored by LZ4.
+	///
+	/// @returns The compressed data, or std::nullopt if the codec is not
+	///          available or compressing would not make the data smaller.
+	static std::optional<std::string> compress(Codec codec,
+	                                           std::string_view data,
+	                                           int level = 0);
+
+	/// @brief Decompress data into out, which is resized to hold it.
+	///
+	/// @param size Size of the decompressed data, from its Header.
+	///
+	/// @returns false if the codec is not available, or the data is
+	///          malformed or does not decompress to exactly size bytes.
+	static bool decompress(Codec codec, std::string_view data, size_t size,
+	                       std::string& out);
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_COMPRESSION_H
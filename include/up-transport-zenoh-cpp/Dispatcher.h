@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_DISPATCHER_H
+#define UP_TRANSPORT_ZENOH_CPP_DISPATCHER_H
+
+#include <up-transport-zenoh-cpp/ThreadPlacement.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Pool of worker threads running listener callbacks.
+///
+/// Each worker drains its own queue (shard). All tasks posted to a shard run
+/// on the same worker, in the order they were posted, so anything that
+/// always uses the same shard is never reordered. Different shards run in
+/// parallel, and a slow task only delays the tasks queued behind it.
+class Dispatcher {
+public:
+	using Task = std::function<void()>;
+
+	/// @brief Start the worker threads.
+	///
+	/// @param threads Number of workers (and shards). Must be non-zero.
+	/// @param placement Where each worker runs.
+	explicit Dispatcher(size_t threads, const ThreadPlacement& placement = {});
+
+	/// @brief Run every task still queued, then stop the workers.
+	~Dispatcher();
+
+	Dispatcher(const Dispatcher&) = delete;
+	Dispatcher& operator=(const Dispatcher&) = delete;
+
+	/// @brief Pick the shard used for everything posted under a key.
+	[[nodiscard]] size_t shardFor(std::string_view key) const;
+
+	/// @brief Queue a task to run on the worker of a shard.
+	void post(size_t shard, Task&& task);
+
+	[[nodiscard]] size_t threads() const { return shards_.size(); }
+
+	/// @brief Get the number of tasks posted that have not finished
+	///        running yet, in all shards.
+	[[nodiscard]] size_t queued() const;
+
+private:
+	struct Shard {
+		mutable std::mutex mutex;
+		std::condition_variable cv;
+		std::deque<Task> tasks;
+		/// @brief Tasks posted and not run yet, including the ones the
+		///        worker has taken out of tasks.
+		std::atomic<size_t> pending{0};
+		bool stopping{false};
+		std::thread worker;
+	};
+
+	static void run_(Shard& shard, const ThreadPlacement& placement);
+
+	std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_DISPATCHER_H
@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_KEYEXPRTABLE_H
+#define UP_TRANSPORT_ZENOH_CPP_KEYEXPRTABLE_H
+
+#include <uprotocol/v1/uri.pb.h>
+
+#include <zenoh.hxx>
+
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace uprotocol::transport {
+
+/// @brief Zenoh key expression for a UUri, formatted and validated once.
+struct InternedKeyExpr {
+	/// @brief The key expression as text, for logging and map lookups.
+	std::string key;
+	/// @brief The validated key expression to pass to Zenoh.
+	zenoh::KeyExpr expr;
+};
+
+/// @brief Table mapping UUris to their Zenoh key expressions.
+///
+/// Formatting a UUri as a key expression, and having Zenoh validate the
+/// result, costs a few string allocations. The table does this once per
+/// distinct UUri. After that, a lookup is one hash of the UUri fields. The
+/// table is read-mostly: concurrent lookups of known UUris share a lock.
+///
+/// Entries are never removed. Once the table holds `capacity` entries, new
+/// UUris are still converted, just without being remembered.
+class KeyExprTable {
+public:
+	/// @param default_authority_name Authority used for UUris without one.
+	/// @param capacity Maximum number of interned UUris.
+	KeyExprTable(std::string default_authority_name, size_t capacity);
+
+	/// @brief Get the key expression for a UUri.
+	///
+	/// Wildcard fields of the UUri become Zenoh wildcard chunks, so filters
+	/// may be looked up here as well.
+	///
+	/// @returns The key expression, or nullptr if the UUri does not form a
+	///          valid one (e.g. its authority contains reserved characters).
+	std::shared_ptr<const InternedKeyExpr> get(const v1::UUri& uri);
+
+	/// @brief Get the key expression for a message from a source to a sink:
+	///        the key of the sink, followed by the chunks of the source
+	///        (e.g. "up/sink/10AB/1/0/source/20CD/1/8001").
+	///
+	/// A subscriber can then select the sources it wants with the key it
+	/// subscribes to, and Zenoh drops samples from the others before they
+	/// reach it.
+	///
+	/// @returns The key expression, or nullptr if the UUris do not form a
+	///          valid one.
+	std::shared_ptr<const InternedKeyExpr> get(const v1::UUri& sink,
+	                                           const v1::UUri& source);
+
+	/// @brief Number of interned UUris.
+	[[nodiscard]] size_t size() const;
+
+	/// @brief Format a UUri as a Zenoh key, without interning it.
+	static std::string toZenohKeyString(
+	    const std::string& default_authority_name, const v1::UUri& uri);
+
+	/// @brief Format a sink and a source as a Zenoh key, without interning
+	///        it.
+	static std::string toZenohKeyString(
+	    const std::string& default_authority_name, const v1::UUri& sink,
+	    const v1::UUri& source);
+
+	/// @brief Validate a key expression, without interning it.
+	///
+	/// @returns The key expression, or nullptr if Zenoh rejects it.
+	static std::shared_ptr<const InternedKeyExpr> validate(std::string key);
+
+private:
+	struct UriHash {
+		size_t operator()(const v1::UUri& uri) const;
+	};
+
+	struct UriEqual {
+		bool operator()(const v1::UUri& lhs, const v1::UUri& rhs) const;
+	};
+
+	using Table =
+	    std::unordered_map<v1::UUri, std::shared_ptr<const InternedKeyExpr>,
+	                       UriHash, UriEqual>;
+
+	const std::string default_authority_name_;
+	const size_t capacity_;
+
+	Table table_;
+	// Keys of sink and source pairs, looked up by sink then by source
+	std::unordered_map<v1::UUri, Table, UriHash, UriEqual> routes_;
+	size_t route_count_{0};
+	mutable std::shared_mutex table_mutex_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_KEYEXPRTABLE_H
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_LATESTCACHE_H
+#define UP_TRANSPORT_ZENOH_CPP_LATESTCACHE_H
+
+#include <up-transport-zenoh-cpp/RcuCell.h>
+#include <uprotocol/v1/umessage.pb.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief The last few messages of each topic, keyed by the Zenoh key of
+///        the topic.
+///
+/// @remarks Thread-safe. Reading takes no lock. Adding a message copies the
+///          list of messages of its topic (depth shared pointers), and adding
+///          a topic copies the table of topics.
+class LatestCache {
+public:
+	/// @brief Messages of one topic, oldest first.
+	using Messages = std::vector<std::shared_ptr<const v1::UMessage>>;
+
+	/// @param depth Number of messages kept per topic. Must be non-zero.
+	/// @param max_topics Number of topics kept. Messages on further topics
+	///                   are not cached.
+	LatestCache(size_t depth, size_t max_topics);
+
+	/// @brief Add a message to its topic, evicting the oldest message of
+	///        the topic if it already holds depth of them.
+	///
+	/// A message whose ID is already cached for the topic is ignored, so
+	/// that a message received twice, such as through two subscriptions,
+	/// is kept once.
+	///
+	/// @returns true if this was the first message of the topic.
+	bool add(const std::string& key,
+	         std::shared_ptr<const v1::UMessage> message);
+
+	/// @brief Get the messages of a topic, oldest first.
+	[[nodiscard]] Messages get(const std::string& key) const;
+
+	/// @brief Number of topics cached.
+	[[nodiscard]] size_t topics() const;
+
+private:
+	struct Topic {
+		RcuCell<Messages> messages;
+	};
+
+	using Table = std::unordered_map<std::string, std::shared_ptr<Topic>>;
+
+	/// @brief Get a topic, creating it if there is room.
+	///
+	/// @returns The topic, or nullptr if the table is full.
+	std::shared_ptr<Topic> topic_(const std::string& key, bool& created);
+
+	const size_t depth_;
+	const size_t max_topics_;
+	RcuCell<Table> topics_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_LATESTCACHE_H
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_LRUCACHE_H
+#define UP_TRANSPORT_ZENOH_CPP_LRUCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace uprotocol::transport {
+
+/// @brief Counters describing how well an LruCache is doing.
+struct LruCacheStats {
+	uint64_t hits{0};
+	uint64_t misses{0};
+	uint64_t evictions{0};
+	size_t size{0};
+	size_t capacity{0};
+};
+
+/// @brief Fixed-capacity map that evicts the least recently used entry.
+///
+/// @remarks Not thread-safe. Callers are expected to serialize access.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+	using Stats = LruCacheStats;
+
+	/// @param capacity Maximum number of entries. A capacity of zero means
+	///                 nothing is ever cached.
+	explicit LruCache(size_t capacity) : capacity_(capacity) {
+		index_.reserve(capacity);
+	}
+
+	/// @brief Look up an entry, marking it as the most recently used.
+	///
+	/// @returns Pointer to the cached value, or nullptr on a miss. The
+	///          pointer remains valid until the entry is evicted or erased.
+	Value* find(const Key& key) {
+		auto entry = index_.find(key);
+		if (entry == index_.end()) {
+			++stats_.misses;
+			return nullptr;
+		}
+		++stats_.hits;
+		entries_.splice(entries_.begin(), entries_, entry->second);
+		return &entry->second->second;
+	}
+
+	/// @brief Add or replace an entry, evicting the least recently used one
+	///        if the cache is full.
+	///
+	/// @returns Pointer to the cached value, or nullptr if the capacity is
+	///          zero.
+	Value* insert(const Key& key, Value value) {
+		if (capacity_ == 0) {
+			return nullptr;
+		}
+		if (auto existing = index_.find(key); existing != index_.end()) {
+			existing->second->second = std::move(value);
+			entries_.splice(entries_.begin(), entries_, existing->second);
+			return &existing->second->second;
+		}
+		if (entries_.size() >= capacity_) {
+			index_.erase(entries_.back().first);
+			entries_.pop_back();
+			++stats_.evictions;
+		}
+		entries_.emplace_front(key, std::move(value));
+		index_.emplace(key, entries_.begin());
+		return &entries_.front().second;
+	}
+
+	/// @brief Remove an entry, if present. This is not counted as eviction.
+	void erase(const Key& key) {
+		if (auto entry = index_.find(key); entry != index_.end()) {
+			entries_.erase(entry->second);
+			index_.erase(entry);
+		}
+	}
+
+	[[nodiscard]] Stats stats() const {
+		auto stats = stats_;
+		stats.size = entries_.size();
+		stats.capacity = capacity_;
+		return stats;
+	}
+
+private:
+	using Entries = std::list<std::pair<Key, Value>>;
+
+	const size_t capacity_;
+	Entries entries_;
+	std::unordered_map<Key, typename Entries::iterator, Hash> index_;
+	Stats stats_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_LRUCACHE_H
@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_MESSAGERING_H
+#define UP_TRANSPORT_ZENOH_CPP_MESSAGERING_H
+
+#include <uprotocol/v1/umessage.pb.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Fixed-capacity ring of received messages, drained in batches.
+///
+/// When the ring is full, a new message overwrites the oldest one, so a
+/// consumer that falls behind gets the latest messages.
+///
+/// The slots are allocated once. Pushing copies a message into a slot, and
+/// popping swaps the slot with the caller's message, which hands the
+/// caller's buffers back to the ring. A consumer that keeps passing the
+/// same messages in therefore stops allocating once every buffer has grown
+/// to its largest size.
+///
+/// @remarks Thread-safe.
+class MessageRing {
+public:
+	/// @param capacity Number of messages the ring can hold. Must be
+	///                 non-zero.
+	explicit MessageRing(size_t capacity);
+
+	MessageRing(const MessageRing&) = delete;
+	MessageRing& operator=(const MessageRing&) = delete;
+
+	/// @brief Copy a message into the ring, overwriting the oldest one if
+	///        the ring is full.
+	///
+	/// @returns false if a message was overwritten.
+	bool push(const v1::UMessage& message);
+
+	/// @brief Move the oldest messages out of the ring.
+	///
+	/// @param messages First of the messages to fill.
+	/// @param count Largest number of messages to move out.
+	/// @param timeout How long to wait for a message if the ring is empty.
+	///                Zero does not wait.
+	///
+	/// @returns Number of messages moved out, zero if none arrived in time.
+	size_t pop(v1::UMessage* messages, size_t count,
+	           std::chrono::milliseconds timeout);
+
+	/// @brief Number of messages in the ring.
+	[[nodiscard]] size_t size() const;
+
+	[[nodiscard]] size_t capacity() const { return slots_.size(); }
+
+	/// @brief Number of messages overwritten before they were popped.
+	[[nodiscard]] uint64_t dropped() const;
+
+private:
+	mutable std::mutex mutex_;
+	std::condition_variable available_;
+	std::vector<v1::UMessage> slots_;
+	size_t head_{0};
+	size_t size_{0};
+	uint64_t dropped_{0};
+	/// @brief Number of consumers in pop(), which pushes wake.
+	size_t waiters_{0};
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_MESSAGERING_H
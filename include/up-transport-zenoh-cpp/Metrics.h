@@ -0,0 +1,184 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_METRICS_H
+#define UP_TRANSPORT_ZENOH_CPP_METRICS_H
+
+#include <up-transport-zenoh-cpp/RcuCell.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Durations sorted into power-of-two buckets.
+struct LatencyHistogram {
+	static constexpr size_t BUCKETS = 24;
+
+	/// @brief Bucket i counts the durations up to upperBound(i), and above
+	///        the bound of the bucket before it. The last bucket has no
+	///        upper bound.
+	std::array<uint64_t, BUCKETS> counts{};
+	std::chrono::nanoseconds sum{0};
+
+	/// @brief Bound of a bucket: 256 ns for the first one, doubling for
+	///        each next one.
+	static std::chrono::nanoseconds upperBound(size_t bucket);
+
+	/// @brief Get the bucket a duration is counted in.
+	static size_t bucketFor(std::chrono::nanoseconds duration);
+
+	[[nodiscard]] uint64_t count() const;
+
+	/// @brief Get the upper bound of the bucket holding a percentile, such
+	///        as 0.99 for the 99th percentile.
+	///
+	/// @returns The bound, or zero if nothing has been recorded. Durations
+	///          in the last bucket report the bound of the one before it.
+	[[nodiscard]] std::chrono::nanoseconds percentile(double fraction) const;
+};
+
+/// @brief Counts and timings of one key expression, at one point in time.
+struct TopicMetricsSnapshot {
+	std::string key;
+	uint64_t messages_sent{0};
+	uint64_t bytes_sent{0};
+	uint64_t send_failures{0};
+	uint64_t messages_received{0};
+	uint64_t bytes_received{0};
+	/// @brief Number of listener callbacks run with a received message.
+	uint64_t messages_delivered{0};
+	/// @brief Received messages that could not be decoded.
+	uint64_t messages_dropped{0};
+	/// @brief Messages dropped because their TTL had run out, whether
+	///        sent, waiting in a queue or received.
+	uint64_t messages_expired{0};
+	/// @brief Time spent encoding the attributes of sent messages.
+	LatencyHistogram serialize_time;
+	/// @brief Time spent handing sent messages to Zenoh, including any
+	///        compression and chunking.
+	LatencyHistogram send_time;
+	/// @brief Time spent decoding received messages.
+	LatencyHistogram decode_time;
+	/// @brief Time spent in each listener callback.
+	LatencyHistogram callback_time;
+};
+
+/// @brief Counters and latency histograms of one key expression, cheap
+///        enough to update for every message.
+///
+/// Updates go to one of several copies (shards) of the counters, picked by
+/// the updating thread, so that threads rarely write to the same cache
+/// line. Reading merges the shards.
+///
+/// @remarks Thread-safe, and lock-free.
+class TopicMetrics {
+public:
+	enum class Counter : size_t {
+		MESSAGES_SENT,
+		BYTES_SENT,
+		SEND_FAILURES,
+		MESSAGES_RECEIVED,
+		BYTES_RECEIVED,
+		MESSAGES_DELIVERED,
+		MESSAGES_DROPPED,
+		MESSAGES_EXPIRED,
+		COUNT
+	};
+
+	enum class Timer : size_t { SERIALIZE, SEND, DECODE, CALLBACK, COUNT };
+
+	static constexpr size_t SHARDS = 8;
+
+	void add(Counter counter, uint64_t amount = 1);
+
+	void record(Timer timer, std::chrono::nanoseconds duration);
+
+	/// @brief Merge the shards.
+	[[nodiscard]] TopicMetricsSnapshot snapshot(std::string key) const;
+
+private:
+	struct alignas(64) Shard {
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::COUNT)>
+		    counters{};
+		std::array<std::array<std::atomic<uint64_t>, LatencyHistogram::BUCKETS>,
+		           static_cast<size_t>(Timer::COUNT)>
+		    buckets{};
+		std::array<std::atomic<uint64_t>, static_cast<size_t>(Timer::COUNT)>
+		    sums_ns{};
+	};
+
+	/// @brief Get the shard of the calling thread.
+	Shard& shard_();
+
+	std::array<Shard, SHARDS> shards_;
+};
+
+/// @brief Metrics of a transport instance, at one point in time.
+struct MetricsSnapshot {
+	/// @brief One entry per key expression, sorted by key.
+	std::vector<TopicMetricsSnapshot> topics;
+
+	/// @brief Messages waiting in the asynchronous send queue.
+	size_t async_send_queued{0};
+	/// @brief Messages discarded by the asynchronous send queue.
+	uint64_t async_send_dropped{0};
+	/// @brief Received messages handed to the dispatch threads and not
+	///        delivered yet.
+	size_t dispatch_queued{0};
+
+	/// @brief Format the metrics in the Prometheus text exposition format.
+	///
+	/// Each topic is labelled with its key expression. Times are in
+	/// seconds, as Prometheus expects.
+	[[nodiscard]] std::string toPrometheus() const;
+};
+
+/// @brief The metrics of every key expression used by a transport.
+///
+/// @remarks Thread-safe. Looking up the metrics of a known key takes no
+///          lock.
+class MetricsRegistry {
+public:
+	/// @brief Key the metrics of every key past max_topics are kept under.
+	static constexpr std::string_view OTHER_KEY = "other";
+
+	/// @param max_topics Number of keys whose metrics are kept apart.
+	explicit MetricsRegistry(size_t max_topics);
+
+	/// @brief Get the metrics of a key, creating them on first use.
+	///
+	/// @remarks Creating them copies the table of keys, so keep the result
+	///          where the key is used repeatedly.
+	std::shared_ptr<TopicMetrics> get(const std::string& key);
+
+	[[nodiscard]] std::vector<TopicMetricsSnapshot> snapshot() const;
+
+private:
+	using Table =
+	    std::unordered_map<std::string, std::shared_ptr<TopicMetrics>>;
+
+	const size_t max_topics_;
+	RcuCell<Table> topics_;
+	const std::shared_ptr<TopicMetrics> other_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_METRICS_H
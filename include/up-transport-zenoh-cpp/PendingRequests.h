@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_PENDINGREQUESTS_H
+#define UP_TRANSPORT_ZENOH_CPP_PENDINGREQUESTS_H
+
+#include <uprotocol/v1/uuid.pb.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Table of requests waiting for their response, keyed by request
+///        ID, each expiring at its own deadline.
+///
+/// Deadlines are kept in a hierarchical timer wheel with 1 ms ticks: four
+/// levels of 64 slots, covering about 4.6 hours before entries are parked
+/// in the last level and rescheduled as time passes. Inserting, taking and
+/// expiring an entry are all constant time, however many are pending, and
+/// stretches of time with nothing due are skipped over rather than walked
+/// tick by tick.
+///
+/// @remarks Not thread-safe. Callers are expected to serialize access.
+template <typename T>
+class PendingRequests {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	/// @param now Time the wheel starts at. Deadlines before it expire on
+	///            the first call to expire().
+	explicit PendingRequests(Clock::time_point now = Clock::now())
+	    : epoch_(now) {}
+
+	/// @brief Add an entry, replacing any other with the same ID.
+	void insert(const v1::UUID& id, T value, Clock::time_point expiry) {
+		const Key key{id.msb(), id.lsb()};
+		auto [entry, added] = entries_.try_emplace(key);
+		if (!added) {
+			unlink_(entry->second);
+		}
+		entry->second.value.emplace(std::move(value));
+		entry->second.deadline = std::max(toTick(expiry), now_ + 1);
+		schedule_(key, entry->second, nullptr);
+	}
+
+	/// @brief Remove an entry before it expires.
+	///
+	/// @returns The value of the entry, or std::nullopt if there is no
+	///          entry with that ID (e.g. because it has expired).
+	std::optional<T> take(const v1::UUID& id) {
+		auto entry = entries_.find(Key{id.msb(), id.lsb()});
+		if (entry == entries_.end()) {
+			return std::nullopt;
+		}
+		unlink_(entry->second);
+		auto value = std::move(entry->second.value);
+		entries_.erase(entry);
+		return value;
+	}
+
+	/// @brief Remove every entry whose deadline is at or before now.
+	///
+	/// @returns The values of the expired entries, so that they can be
+	///          released outside of whatever lock guards the table.
+	std::vector<T> expire(Clock::time_point now) {
+		std::vector<T> expired;
+		const auto target = toFloorTick(now);
+		while (now_ < target) {
+			// Nothing can come due before the next tick at which the lowest
+			// occupied level is looked at
+			size_t level = 0;
+			while ((level < LEVELS) && (counts_[level] == 0)) {
+				++level;
+			}
+			if (level == LEVELS) {
+				now_ = target;
+				break;
+			}
+			const uint64_t step = uint64_t{1} << (LEVEL_BITS * level);
+			const uint64_t next = ((now_ / step) + 1) * step;
+			if (next > target) {
+				now_ = target;
+				break;
+			}
+			now_ = next;
+			cascade_();
+			expireSlot_(expired);
+		}
+		return expired;
+	}
+
+	[[nodiscard]] size_t size() const { return entries_.size(); }
+
+	[[nodiscard]] bool empty() const { return entries_.empty(); }
+
+private:
+	using Key = std::pair<uint64_t, uint64_t>;
+	using Slot = std::list<Key>;
+
+	static constexpr size_t LEVEL_BITS = 6;
+	static constexpr size_t SLOTS = size_t{1} << LEVEL_BITS;
+	static constexpr size_t LEVELS = 4;
+	static constexpr uint64_t HORIZON = uint64_t{1} << (LEVEL_BITS * LEVELS);
+
+	struct KeyHash {
+		size_t operator()(const Key& key) const {
+			// UUIDv7 keeps its random bits in the lsb
+			return std::hash<uint64_t>()(key.second ^
+			                             (key.first * 0x9E3779B97F4A7C15ULL));
+		}
+	};
+
+	struct Entry {
+		std::optional<T> value;
+		uint64_t deadline{0};
+		size_t level{0};
+		Slot* slot{nullptr};
+		typename Slot::iterator position;
+	};
+
+	[[nodiscard]] uint64_t toTick(Clock::time_point time) const {
+		if (time <= epoch_) {
+			return 0;
+		}
+		return std::chrono::ceil<std::chrono::milliseconds>(time - epoch_)
+		    .count();
+	}
+
+	[[nodiscard]] uint64_t toFloorTick(Clock::time_point time) const {
+		if (time <= epoch_) {
+			return 0;
+		}
+		return std::chrono::floor<std::chrono::milliseconds>(time - epoch_)
+		    .count();
+	}
+
+	/// @brief Take an entry out of its slot.
+	void unlink_(Entry& entry) {
+		entry.slot->erase(entry.position);
+		--counts_[entry.level];
+	}
+
+	/// @brief Put an entry in the slot its deadline falls in. If from is
+	///        set, the entry's list node is moved out of it rather than
+	///        allocated.
+	void schedule_(const Key& key, Entry& entry, Slot* from) {
+		// Deadlines past the horizon wait in the last level, in the slot
+		// reached furthest from now, and are placed again when it cascades
+		const uint64_t delta = std::min(entry.deadline - now_, HORIZON - 1);
+		const uint64_t when = now_ + delta;
+
+		size_t level = 0;
+		while ((level < LEVELS - 1) &&
+		       (delta >= (uint64_t{1} << (LEVEL_BITS * (level + 1))))) {
+			++level;
+		}
+		auto& slot =
+		    wheel_[level][(when >> (LEVEL_BITS * level)) & (SLOTS - 1)];
+
+		if (from == nullptr) {
+			entry.position = slot.insert(slot.end(), key);
+		} else {
+			slot.splice(slot.end(), *from, entry.position);
+		}
+		entry.level = level;
+		entry.slot = &slot;
+		++counts_[level];
+	}
+
+	/// @brief Move the entries of every higher-level slot that has come
+	///        due at the current tick down to the levels below it.
+	void cascade_() {
+		for (size_t level = 1; level < LEVELS; ++level) {
+			if ((now_ & ((uint64_t{1} << (LEVEL_BITS * level)) - 1)) != 0) {
+				break;
+			}
+			auto& slot =
+			    wheel_[level][(now_ >> (LEVEL_BITS * level)) & (SLOTS - 1)];
+			Slot due;
+			due.splice(due.end(), slot);
+			counts_[level] -= due.size();
+			while (!due.empty()) {
+				auto& entry = entries_.find(due.front())->second;
+				schedule_(due.front(), entry, &due);
+			}
+		}
+	}
+
+	/// @brief Remove the entries in the level-0 slot of the current tick.
+	void expireSlot_(std::vector<T>& expired) {
+		auto& slot = wheel_[0][now_ & (SLOTS - 1)];
+		while (!slot.empty()) {
+			auto entry = entries_.find(slot.front());
+			slot.pop_front();
+			--counts_[0];
+			expired.push_back(std::move(*entry->second.value));
+			entries_.erase(entry);
+		}
+	}
+
+	const Clock::time_point epoch_;
+	// Every deadline up to and including this tick has expired
+	uint64_t now_{0};
+	std::unordered_map<Key, Entry, KeyHash> entries_;
+	std::array<std::array<Slot, SLOTS>, LEVELS> wheel_;
+	// Number of entries in each level of the wheel
+	std::array<size_t, LEVELS> counts_{};
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_PENDINGREQUESTS_H
@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_RCUCELL_H
+#define UP_TRANSPORT_ZENOH_CPP_RCUCELL_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace uprotocol::transport {
+
+/// @brief A value read without locks and replaced by copy-on-write.
+///
+/// Readers see an immutable snapshot of the value. A read increments and
+/// decrements a reader counter, and never waits for anything. Writers are
+/// serialized by a mutex: each one copies the current snapshot, modifies
+/// the copy, publishes it, and then waits for every reader that could still
+/// hold the previous snapshot before deleting it (read-copy-update).
+///
+/// Reader counters are spread over shards on separate cache lines, each
+/// thread counting itself in the same one, so that threads reading at once
+/// do not contend on one counter. Each shard has two counters, picked by a
+/// generation bit. A writer flips the bit and waits for the old counters of
+/// every shard to drain, twice, so that a reader that picked its counter
+/// just before a flip is still waited for.
+///
+/// @remarks Writes are expensive and must not happen from inside read().
+///          Keep read sections short, since writers wait for them.
+template <typename T>
+class RcuCell {
+public:
+	explicit RcuCell(T initial = T()) : current_(new T(std::move(initial))) {}
+
+	~RcuCell() { delete current_.load(); }
+
+	RcuCell(const RcuCell&) = delete;
+	RcuCell& operator=(const RcuCell&) = delete;
+
+	/// @brief Call reader with the current snapshot.
+	///
+	/// @returns Whatever reader returns.
+	template <typename Reader>
+	auto read(Reader&& reader) const {
+		auto& readers = shards_[shard_()].readers[generation_.load() & 1U];
+		readers.fetch_add(1);
+		struct Exit {
+			std::atomic<size_t>& readers;
+			~Exit() { readers.fetch_sub(1, std::memory_order_release); }
+		} exit{readers};
+		return std::forward<Reader>(reader)(*current_.load());
+	}
+
+	/// @brief Replace the value with a modified copy of it.
+	///
+	/// @param writer Called with the copy, which it may modify.
+	template <typename Writer>
+	void update(Writer&& writer) {
+		std::lock_guard lock(writer_mutex_);
+		auto next = std::make_unique<T>(*current_.load());
+		std::forward<Writer>(writer)(*next);
+		std::unique_ptr<T> previous(current_.exchange(next.release()));
+		synchronize_();
+	}
+
+private:
+	static constexpr size_t SHARDS = 8;
+
+	struct alignas(64) Shard {
+		std::array<std::atomic<size_t>, 2> readers{};
+	};
+
+	// Picks the reader counters of the calling thread, spreading threads
+	// over the shards as they first read
+	static size_t shard_() {
+		static std::atomic<size_t> next_shard{0};
+		thread_local const size_t thread_shard =
+		    next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+		return thread_shard;
+	}
+
+	// Blocks until no reader can still be looking at a replaced snapshot
+	void synchronize_() {
+		for (int phase = 0; phase < 2; ++phase) {
+			const auto drained = generation_.fetch_xor(1U) & 1U;
+			for (const auto& shard : shards_) {
+				while (shard.readers[drained].load() != 0) {
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+
+	std::atomic<T*> current_;
+	mutable std::atomic<unsigned> generation_{0};
+	mutable std::array<Shard, SHARDS> shards_{};
+	std::mutex writer_mutex_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_RCUCELL_H
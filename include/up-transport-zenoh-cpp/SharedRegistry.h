@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_SHAREDREGISTRY_H
+#define UP_TRANSPORT_ZENOH_CPP_SHAREDREGISTRY_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace uprotocol::transport {
+
+/// @brief Reference-counted instances shared by key, such as one Zenoh
+///        session per configuration file.
+///
+/// The registry only holds weak references. An instance lives as long as
+/// one of its users, and the next acquire() after the last one lets go
+/// creates a new one.
+///
+/// @remarks Thread-safe. Instances are created while holding the registry
+///          lock, so that concurrent users of one key never create two,
+///          at the cost of serializing creation across keys.
+template <typename Key, typename T>
+class SharedRegistry {
+public:
+	/// @brief Get the instance for a key, or create one by calling make()
+	///        if there is none alive.
+	///
+	/// @param make Returns a std::shared_ptr<T>. If it throws, nothing is
+	///             registered and the exception propagates.
+	template <typename Make>
+	std::shared_ptr<T> acquire(const Key& key, Make&& make) {
+		std::lock_guard lock(mutex_);
+		auto& entry = instances_[key];
+		if (auto instance = entry.lock()) {
+			return instance;
+		}
+
+		// Entries of released instances are swept here, since nothing is
+		// told when an instance goes away
+		for (auto it = instances_.begin(); it != instances_.end();) {
+			if ((&it->second != &entry) && it->second.expired()) {
+				it = instances_.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		try {
+			std::shared_ptr<T> instance = std::forward<Make>(make)();
+			entry = instance;
+			return instance;
+		} catch (...) {
+			instances_.erase(key);
+			throw;
+		}
+	}
+
+	/// @brief Get the number of keys with a live instance.
+	[[nodiscard]] size_t size() const {
+		std::lock_guard lock(mutex_);
+		size_t live = 0;
+		for (const auto& [key, instance] : instances_) {
+			live += instance.expired() ? 0 : 1;
+		}
+		return live;
+	}
+
+private:
+	std::map<Key, std::weak_ptr<T>> instances_;
+	mutable std::mutex mutex_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_SHAREDREGISTRY_H
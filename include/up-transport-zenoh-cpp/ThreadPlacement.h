@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_THREADPLACEMENT_H
+#define UP_TRANSPORT_ZENOH_CPP_THREADPLACEMENT_H
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Where a thread runs: the CPUs it may use, its real-time priority
+///        and the NUMA node it belongs to.
+///
+/// @remarks Linux only. Placing a thread only affects the threads it
+///          starts afterwards, which inherit its CPUs and scheduling.
+struct ThreadPlacement {
+	/// @brief Largest SCHED_FIFO priority.
+	static constexpr size_t MAX_FIFO_PRIORITY = 99;
+
+	/// @brief CPUs the thread may run on. Empty leaves every CPU allowed.
+	std::vector<size_t> cpus;
+	/// @brief SCHED_FIFO priority, from 1 to MAX_FIFO_PRIORITY. Zero keeps
+	///        the default time-sharing policy.
+	///
+	/// @remarks Needs CAP_SYS_NICE, or a large enough RLIMIT_RTPRIO.
+	size_t fifo_priority{0};
+	/// @brief NUMA node the thread runs on, and prefers to allocate memory
+	///        from. Its CPUs are intersected with `cpus` when both are set.
+	std::optional<size_t> numa_node;
+
+	/// @brief Whether the placement leaves the thread as it is.
+	[[nodiscard]] bool empty() const;
+
+	/// @brief Place the calling thread.
+	///
+	/// @param thread_name Name of the thread in log messages.
+	///
+	/// @returns false if any part of the placement could not be applied,
+	///          which is logged. The thread keeps its previous setting for
+	///          that part.
+	bool apply(std::string_view thread_name) const;
+
+	/// @brief Get the CPUs of a NUMA node, from sysfs.
+	///
+	/// @returns The CPUs, or std::nullopt if the node does not exist.
+	static std::optional<std::vector<size_t>> nodeCpus(size_t node);
+
+	/// @brief Parse a Linux CPU list, such as "0-3,8".
+	///
+	/// @returns The CPUs, or std::nullopt if the list is malformed.
+	static std::optional<std::vector<size_t>> parseCpuList(
+	    std::string_view list);
+};
+
+/// @brief Places the calling thread while it lives, and puts its previous
+///        CPUs, scheduling and memory policy back afterwards.
+///
+/// Threads started meanwhile keep the placement, which is how the threads
+/// a library starts on its own are placed.
+class ScopedThreadPlacement {
+public:
+	ScopedThreadPlacement(const ThreadPlacement& placement,
+	                      std::string_view thread_name);
+	~ScopedThreadPlacement();
+
+	ScopedThreadPlacement(const ScopedThreadPlacement&) = delete;
+	ScopedThreadPlacement& operator=(const ScopedThreadPlacement&) = delete;
+
+private:
+	struct Saved;
+
+	/// @brief What the thread had before, or nullptr if the placement was
+	///        empty.
+	std::unique_ptr<Saved> saved_;
+	std::string thread_name_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_THREADPLACEMENT_H
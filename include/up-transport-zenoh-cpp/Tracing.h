@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_TRACING_H
+#define UP_TRANSPORT_ZENOH_CPP_TRACING_H
+
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+/// @brief Tracepoints at the entry and exit of the main stages a message goes
+///        through in the transport.
+///
+/// The tracepoints are only compiled in when building with
+/// -DUP_TRANSPORT_ZENOH_ENABLE_TRACING=ON. Otherwise UP_TRANSPORT_ZENOH_TRACE
+/// expands to nothing, and the transport never calls the hook.
+namespace uprotocol::transport::tracing {
+
+#ifdef UP_TRANSPORT_ZENOH_TRACING
+inline constexpr bool ENABLED = true;
+#else
+inline constexpr bool ENABLED = false;
+#endif
+
+enum class Stage : uint8_t {
+	/// @brief Looking up the Zenoh key expression of a destination UUri.
+	KEY_EXPR,
+	/// @brief Encoding the attributes of a sent message.
+	SERIALIZE,
+	/// @brief Handing a message to Zenoh, as a put, query or reply.
+	PUT,
+	/// @brief Handling a sample, query or reply received from Zenoh, which
+	///        contains the DECODE, FILTER and DISPATCH stages of that
+	///        message when callbacks run on the Zenoh receive thread.
+	RECEIVE,
+	/// @brief Decoding the attributes or the payload of a received message.
+	DECODE,
+	/// @brief Matching a received message against the filters of a
+	///        listener.
+	FILTER,
+	/// @brief Running a listener callback.
+	DISPATCH
+};
+
+enum class Event : uint8_t { BEGIN, END };
+
+/// @brief Called at each tracepoint, on the thread running the stage.
+///
+/// BEGIN and END events of a thread nest like the stages they bracket.
+/// Hooks run on the hot path, so they should only record the event (e.g.
+/// with a timestamp in a thread-local buffer) and return.
+using Hook = void (*)(Stage stage, Event event, void* context);
+
+/// @brief Set the hook every tracepoint calls, for every transport in the
+///        process.
+///
+/// @param hook Hook to call, or nullptr to stop tracing.
+/// @param context Passed to every call of the hook.
+///
+/// @remarks Safe to call while transports are running. Each stage reports
+///          both of its events to the hook and context set when it began,
+///          which are always a pair passed to the same call.
+void setHook(Hook hook, void* context = nullptr);
+
+/// @brief Get the name of a stage, such as "key_expr".
+std::string_view toString(Stage stage);
+
+namespace detail {
+
+/// @brief A hook together with its context. Never modified or freed once
+///        published, so that a stage can keep using the one it loaded.
+struct HookState {
+	Hook hook;
+	void* context;
+};
+
+/// @brief The current hook, or nullptr when not tracing.
+extern std::atomic<const HookState*> hook_state;
+
+}  // namespace detail
+
+/// @brief Reports the BEGIN event of a stage when created and its END event
+///        when destroyed, to the hook set when it was created.
+class Scope {
+public:
+	explicit Scope(Stage stage)
+	    : stage_(stage),
+	      state_(detail::hook_state.load(std::memory_order_acquire)) {
+		if (state_ != nullptr) {
+			state_->hook(stage_, Event::BEGIN, state_->context);
+		}
+	}
+
+	~Scope() {
+		if (state_ != nullptr) {
+			state_->hook(stage_, Event::END, state_->context);
+		}
+	}
+
+	Scope(const Scope&) = delete;
+	Scope& operator=(const Scope&) = delete;
+
+private:
+	const Stage stage_;
+	const detail::HookState* const state_;
+};
+
+}  // namespace uprotocol::transport::tracing
+
+#define UP_TRANSPORT_ZENOH_TRACE_CONCAT_(a, b) a##b
+#define UP_TRANSPORT_ZENOH_TRACE_NAME_(line) \
+	UP_TRANSPORT_ZENOH_TRACE_CONCAT_(trace_scope_, line)
+
+/// @brief Trace a stage from here to the end of the enclosing scope.
+#ifdef UP_TRANSPORT_ZENOH_TRACING
+#define UP_TRANSPORT_ZENOH_TRACE(stage)                               \
+	const ::uprotocol::transport::tracing::Scope                      \
+	UP_TRANSPORT_ZENOH_TRACE_NAME_(__LINE__)(                         \
+	    ::uprotocol::transport::tracing::Stage::stage)
+#else
+#define UP_TRANSPORT_ZENOH_TRACE(stage) static_cast<void>(0)
+#endif
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_TRACING_H
@@ -0,0 +1,513 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_TRANSPORTCONFIG_H
+#define UP_TRANSPORT_ZENOH_CPP_TRANSPORTCONFIG_H
+
+#include <up-transport-zenoh-cpp/AttributesCodec.h>
+#include <up-transport-zenoh-cpp/Compression.h>
+#include <up-transport-zenoh-cpp/ThreadPlacement.h>
+#include <uprotocol/v1/uri.pb.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace uprotocol::transport {
+
+/// @brief Transport-level settings for ZenohUTransport.
+///
+/// These settings live in the Zenoh configuration file passed to the
+/// ZenohUTransport constructor, under the section named by ZENOH_CONFIG_KEY.
+/// Every setting is optional. Anything left out keeps the default shown here.
+///
+/// Example:
+///
+///     plugins: {
+///       uprotocol: {
+///         async_send: {
+///           enabled: true,
+///           queue_capacity: 4096,
+///           overflow: "fail_fast",
+///         },
+///         attributes_encoding: "compact",
+///         chunking: {
+///           chunk_size: 32768,
+///           max_message_size: 16777216,
+///           max_pending_messages: 256,
+///           max_pending_size: 268435456,
+///         },
+///         compression: {
+///           rules: [
+///             { pattern: "//*/10AB/*/8001", codec: "lz4" },
+///             { pattern: "//*/*/*/*", codec: "zstd", threshold: 4096 },
+///           ],
+///         },
+///         dispatch: {
+///           threads: 4,
+///         },
+///         key_expr_table: {
+///           capacity: 8192,
+///         },
+///         key_format: "destination_and_source",
+///         latest_cache: {
+///           depth: 1,
+///           query: true,
+///         },
+///         loopback: {
+///           enabled: true,
+///         },
+///         matching: {
+///           skip_unmatched: true,
+///         },
+///         metrics: {
+///           enabled: true,
+///           max_topics: 256,
+///         },
+///         publisher_cache: {
+///           capacity: 1024,
+///         },
+///         receive_arenas: {
+///           count: 64,
+///           block_size: 16384,
+///         },
+///         qos: {
+///           cs0: { priority: "background", congestion_control: "drop" },
+///           cs6: { priority: "real_time", congestion_control: "block" },
+///         },
+///         reliability: {
+///           rules: [
+///             { pattern: "//*/10AB/*/8001", mode: "best_effort" },
+///           ],
+///         },
+///         rpc: {
+///           queries: true,
+///         },
+///         session: {
+///           lazy: true,
+///           shared: true,
+///         },
+///         shared_memory: {
+///           enabled: true,
+///           segment_size: 67108864,
+///           threshold: 65536,
+///         },
+///         threads: {
+///           dispatch: { cpus: [2, 3], fifo_priority: 20 },
+///           zenoh: { numa_node: 0 },
+///         },
+///       },
+///     },
+struct TransportConfig {
+	/// @brief Location of the transport section in the Zenoh configuration.
+	static constexpr std::string_view ZENOH_CONFIG_KEY = "plugins/uprotocol";
+
+	/// @brief Publishing of large payloads through Zenoh shared memory.
+	///
+	/// @remarks When enabled, payloads of at least `threshold` bytes are
+	///          written into a shared-memory segment owned by the transport.
+	///          Zenoh then hands subscribers on the same host a reference to
+	///          the segment, and serializes the bytes for remote peers.
+	struct SharedMemory {
+		/// @brief Publish large payloads from shared memory.
+		bool enabled{false};
+		/// @brief Size (in bytes) of the segment owned by each instance.
+		size_t segment_size{64UL * 1024 * 1024};
+		/// @brief Payloads smaller than this are published from the heap.
+		size_t threshold{64UL * 1024};
+	};
+
+	/// @brief Format of the UAttributes attached to outgoing messages, as
+	///        "protobuf" or "compact". Incoming messages are accepted in
+	///        either format.
+	///
+	/// @remarks Only select "compact" when every peer uses this transport.
+	AttributesCodec::Format attributes_encoding{
+	    AttributesCodec::Format::PROTOBUF};
+
+	/// @brief Zenoh keys of outgoing messages, and of subscriptions.
+	enum class KeyFormat : uint8_t {
+		/// @brief The key of the sink, or of the source for messages
+		///        without one ("destination").
+		DESTINATION,
+		/// @brief For messages with a sink, the key of the sink followed by
+		///        the chunks of the source, so that listeners with a source
+		///        filter subscribe to those sources only
+		///        ("destination_and_source"). Listeners without a source
+		///        filter receive messages in either format.
+		DESTINATION_AND_SOURCE
+	};
+
+	/// @brief Format of the Zenoh keys, as "destination" or
+	///        "destination_and_source".
+	///
+	/// @remarks Only select "destination_and_source" when every peer uses
+	///          this transport with the same setting.
+	KeyFormat key_format{KeyFormat::DESTINATION};
+
+	SharedMemory shared_memory;
+
+	/// @brief Cache of Zenoh publishers declared by sendImpl().
+	///
+	/// @remarks A declared publisher lets Zenoh resolve its key expression
+	///          and matching routes once, instead of on every put. When the
+	///          cache is full, the least recently used publisher is
+	///          undeclared.
+	struct PublisherCache {
+		/// @brief Maximum number of declared publishers. Zero disables
+		///        the cache, and every message is put through the session.
+		size_t capacity{256};
+	};
+
+	PublisherCache publisher_cache;
+
+	/// @brief Table of UUris already converted to Zenoh key expressions.
+	///
+	/// @remarks Entries are kept for the lifetime of the transport. Beyond
+	///          the capacity, UUris are converted on every use.
+	struct KeyExprTable {
+		/// @brief Maximum number of interned UUris.
+		size_t capacity{4096};
+	};
+
+	KeyExprTable key_expr_table;
+
+	/// @brief Sending from a dedicated I/O thread.
+	///
+	/// @remarks When enabled, sendImpl() only places the message in a
+	///          bounded queue and returns. The I/O thread publishes queued
+	///          messages in order. Errors found at that point are logged,
+	///          since the caller already has its status.
+	struct AsyncSend {
+		/// @brief What sendImpl() does when the queue is full.
+		enum class Overflow : uint8_t {
+			/// @brief Wait until the I/O thread makes room ("block").
+			BLOCK,
+			/// @brief Discard the oldest queued message ("drop_oldest").
+			DROP_OLDEST,
+			/// @brief Return RESOURCE_EXHAUSTED ("fail_fast").
+			FAIL_FAST
+		};
+
+		/// @brief Queue messages instead of publishing them in sendImpl().
+		bool enabled{false};
+		/// @brief Number of messages the queue holds, rounded up to a
+		///        power of two.
+		size_t queue_capacity{1024};
+		Overflow overflow{Overflow::BLOCK};
+	};
+
+	AsyncSend async_send;
+
+	/// @brief Threads running listener callbacks.
+	///
+	/// @remarks Without dispatch threads, callbacks run on the Zenoh thread
+	///          that received the message, and a slow callback delays every
+	///          other listener of the session. With them, each sink filter
+	///          is assigned to one thread: callbacks of different filters
+	///          run in parallel, while messages matching the same filter
+	///          keep their order.
+	struct Dispatch {
+		/// @brief Number of dispatch threads. Zero runs callbacks on the
+		///        Zenoh receive thread.
+		size_t threads{0};
+	};
+
+	Dispatch dispatch;
+
+	/// @brief Transport of RPC requests and responses.
+	struct Rpc {
+		/// @brief Send each request as a Zenoh query, received by a
+		///        queryable declared for the method, and its response as
+		///        the reply to that query. When false, requests and
+		///        responses are put and subscribed to like any other
+		///        message.
+		///
+		/// @remarks Both sides of a call must agree on this setting.
+		bool queries{true};
+	};
+
+	Rpc rpc;
+
+	/// @brief Zenoh priority and congestion control of outgoing messages,
+	///        for each UPriority class of service.
+	///
+	/// @remarks Zenoh keeps a separate queue for each priority, so messages
+	///          of a high class of service are not held up behind bulk
+	///          traffic of a lower one. Messages without a priority are
+	///          sent as CS1, the uProtocol default. RPC requests and their
+	///          replies use the Zenoh defaults, since Zenoh queries have no
+	///          QoS settings.
+	struct Qos {
+		/// @brief Zenoh priority, from highest to lowest.
+		enum class Priority : uint8_t {
+			REAL_TIME,         ///< "real_time"
+			INTERACTIVE_HIGH,  ///< "interactive_high"
+			INTERACTIVE_LOW,   ///< "interactive_low"
+			DATA_HIGH,         ///< "data_high"
+			DATA,              ///< "data"
+			DATA_LOW,          ///< "data_low"
+			BACKGROUND         ///< "background"
+		};
+
+		/// @brief What Zenoh does with a message when its queue is full.
+		enum class CongestionControl : uint8_t {
+			/// @brief Wait until there is room ("block").
+			BLOCK,
+			/// @brief Discard the message ("drop").
+			DROP
+		};
+
+		/// @brief Settings of one class of service.
+		struct Lane {
+			Priority priority;
+			CongestionControl congestion_control;
+		};
+
+		/// @brief Number of classes of service, CS0 to CS6.
+		static constexpr size_t CLASSES = 7;
+
+		/// @brief Lanes indexed by class of service, set in the
+		///        configuration as "cs0" to "cs6".
+		std::array<Lane, CLASSES> lanes{{
+		    {Priority::BACKGROUND, CongestionControl::DROP},
+		    {Priority::DATA_LOW, CongestionControl::DROP},
+		    {Priority::DATA, CongestionControl::DROP},
+		    {Priority::DATA_HIGH, CongestionControl::DROP},
+		    {Priority::INTERACTIVE_LOW, CongestionControl::BLOCK},
+		    {Priority::INTERACTIVE_HIGH, CongestionControl::BLOCK},
+		    {Priority::REAL_TIME, CongestionControl::BLOCK},
+		}};
+	};
+
+	Qos qos;
+
+	/// @brief Zenoh reliability, chosen by UUri.
+	///
+	/// @remarks Zenoh 0.11 only sets reliability on subscribers. Publishers
+	///          get the nearest equivalent: "best_effort" messages are sent
+	///          with the "drop" congestion control, so that a full queue
+	///          drops a sample instead of holding up the ones behind it,
+	///          and "reliable" ones with "block". Messages and sink filters
+	///          matching no rule keep their class of service settings and
+	///          the Zenoh default.
+	struct Reliability {
+		enum class Mode : uint8_t {
+			BEST_EFFORT,  ///< "best_effort"
+			RELIABLE      ///< "reliable"
+		};
+
+		/// @brief Reliability of the UUris matching a pattern.
+		struct Rule {
+			/// @brief Pattern matched against the sink of a message, or
+			///        its source if it has no sink, and against the sink
+			///        filter of a listener. Written as a uProtocol URI, see
+			///        UriFilter::parse().
+			v1::UUri pattern;
+			Mode mode{Mode::RELIABLE};
+		};
+
+		/// @brief Rules in order of precedence. The first one matching
+		///        decides.
+		std::vector<Rule> rules;
+	};
+
+	Reliability reliability;
+
+	/// @brief Protobuf arenas that received messages are allocated on.
+	///
+	/// @remarks Each received message, with its attributes and payload, is
+	///          built on an arena taken from a pool, which is reset and
+	///          returned once every listener has seen the message. A message
+	///          that fits in the arena's block takes no heap allocation.
+	///          Larger ones, or messages received while every arena is in
+	///          use, fall back to the heap.
+	struct ReceiveArenas {
+		/// @brief Number of pooled arenas. It bounds how many received
+		///        messages can be in flight (e.g. queued for dispatch
+		///        threads) without touching the heap. Zero disables the
+		///        pool.
+		size_t count{16};
+		/// @brief Size (in bytes) of the block each arena is built on.
+		size_t block_size{64UL * 1024};
+	};
+
+	ReceiveArenas receive_arenas;
+
+	/// @brief Splitting of large payloads into several Zenoh messages.
+	struct Chunking {
+		/// @brief Largest payload (in bytes) published as one message.
+		///        Larger ones are published in chunks of this size. Zero
+		///        publishes every payload whole.
+		size_t chunk_size{0};
+		/// @brief Largest payload (in bytes) reassembled from received
+		///        chunks. Larger messages are dropped.
+		size_t max_message_size{256UL * 1024 * 1024};
+		/// @brief Most messages partially received at once, per sink
+		///        filter. New chunked messages past it are dropped.
+		size_t max_pending_messages{1024};
+		/// @brief Largest total size (in bytes) announced by the messages
+		///        partially received at once, per sink filter. New chunked
+		///        messages past it are dropped.
+		size_t max_pending_size{1024UL * 1024 * 1024};
+	};
+
+	Chunking chunking;
+
+	/// @brief Compression of published payloads, chosen by the UUri they
+	///        are published on.
+	///
+	/// @remarks Payloads are compressed chunk by chunk when sent in chunks.
+	///          Received payloads are decompressed whatever these settings
+	///          are, as long as their codec was built in.
+	struct Compression {
+		/// @brief Compression of the payloads published on the UUris
+		///        matching a pattern.
+		struct Rule {
+			/// @brief Pattern matched against the sink of a message, or its
+			///        source if it has no sink. Written as a uProtocol URI,
+			///        see UriFilter::parse().
+			v1::UUri pattern;
+			transport::Compression::Codec codec{
+			    transport::Compression::Codec::NONE};
+			/// @brief ZSTD compression level, or 0 for its default.
+			///        Negative levels are its faster modes.
+			int level{0};
+			/// @brief Payloads smaller than this (in bytes) are sent
+			///        uncompressed.
+			size_t threshold{1024};
+		};
+
+		/// @brief Rules in order of precedence. The first one matching a
+		///        message decides, and messages matching none are sent
+		///        uncompressed.
+		std::vector<Rule> rules;
+		/// @brief Largest size (in bytes) a received payload is
+		///        decompressed to. Larger payloads are dropped.
+		size_t max_decompressed_size{256UL * 1024 * 1024};
+	};
+
+	Compression compression;
+
+	/// @brief How the Zenoh session is opened and shared.
+	struct Session {
+		/// @brief Return from the constructor before the session is open,
+		///        instead of waiting for scouting and router connection.
+		///        Sends and registrations are queued until it is open.
+		///        See ZenohUTransport::getReadyFuture().
+		bool lazy{false};
+		/// @brief Share one session between every instance in the process
+		///        built from this configuration file, instead of opening
+		///        one per instance. That saves each one the scouting,
+		///        links and router state of its own session.
+		bool shared{false};
+	};
+
+	Session session;
+
+	/// @brief CPUs, real-time priority and NUMA node of the threads the
+	///        transport runs, each written as an object with `cpus` (an
+	///        array of CPU numbers), `fifo_priority` and `numa_node`.
+	///
+	/// @remarks Zenoh starts its own threads, which cannot be placed
+	///          directly. They inherit the placement of the thread that
+	///          starts them instead, so the thread opening the session
+	///          takes the "zenoh" placement while it does. That places the
+	///          Zenoh runtime when the first session of the process opens
+	///          it. Failures to apply a placement, such as a SCHED_FIFO
+	///          priority without the right to it, are logged and leave the
+	///          thread as it was.
+	struct Threads {
+		/// @brief Each dispatch thread.
+		ThreadPlacement dispatch;
+		/// @brief The I/O thread of the asynchronous send queue.
+		ThreadPlacement async_send;
+		/// @brief The threads Zenoh starts while the session opens.
+		ThreadPlacement zenoh;
+	};
+
+	Threads threads;
+
+	/// @brief Per key expression counters and latency histograms, read with
+	///        ZenohUTransport::getMetrics().
+	///
+	/// @remarks Off by default, since they cost a few clock reads and
+	///          atomic increments per message.
+	struct Metrics {
+		bool enabled{false};
+		/// @brief Number of key expressions whose metrics are kept apart.
+		///        Further keys are counted together.
+		size_t max_topics{1024};
+	};
+
+	Metrics metrics;
+
+	/// @brief Delivery of sent messages to listeners in the same process.
+	///
+	/// @remarks When enabled, a message sent by a transport is handed
+	///          straight to the matching listeners of every transport on
+	///          the same Zenoh session (see Session::shared), without being
+	///          encoded or going through Zenoh. It is still put on Zenoh
+	///          for remote subscribers. RPC messages sent as Zenoh queries
+	///          always go through Zenoh.
+	struct Loopback {
+		bool enabled{false};
+	};
+
+	Loopback loopback;
+
+	/// @brief The last messages published on each topic, kept for
+	///        ZenohUTransport::getLatest().
+	///
+	/// @remarks Off by default, since every cached message is copied off
+	///          its receive arena. With query set, the transport also keeps
+	///          the last messages it published, answers Zenoh queries for
+	///          them, and queries the topics of each listener registered,
+	///          so that a late joiner gets the current values right away.
+	struct LatestCache {
+		/// @brief Number of messages kept per topic. 0 disables the cache.
+		size_t depth{0};
+		/// @brief Number of topics cached. Further topics are not cached.
+		size_t max_topics{1024};
+		bool query{false};
+	};
+
+	LatestCache latest_cache;
+
+	/// @brief Use of the matching listeners registered with
+	///        ZenohUTransport::registerMatchingListener().
+	struct Matching {
+		/// @brief Return UNAVAILABLE from sendImpl() instead of sending a
+		///        message on a topic its matching listener reports has no
+		///        subscribers. Topics without a matching listener are
+		///        always sent.
+		///
+		/// @remarks Skipped messages are not kept for latest_cache
+		///          queries either.
+		bool skip_unmatched{false};
+	};
+
+	Matching matching;
+
+	/// @brief Parse the transport section of a Zenoh configuration.
+	///
+	/// @param json The section as a JSON object.
+	///
+	/// @throws std::invalid_argument if the JSON is malformed, contains an
+	///         unknown setting, or a setting has an invalid type or value.
+	static TransportConfig fromJson(std::string_view json);
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_TRANSPORTCONFIG_H
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef UP_TRANSPORT_ZENOH_CPP_URIFILTER_H
+#define UP_TRANSPORT_ZENOH_CPP_URIFILTER_H
+
+#include <uprotocol/v1/uri.pb.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace uprotocol::transport {
+
+/// @brief A UUri filter, compiled once so that matching against it is a few
+///        integer comparisons.
+///
+/// Any field of the filter may be a wildcard, matching every value of that
+/// field. An empty authority stands for the transport's default authority,
+/// both in the filter and in the UUris matched against it.
+class UriFilter {
+public:
+	static constexpr std::string_view WILDCARD_AUTHORITY = "*";
+	static constexpr uint32_t WILDCARD_ENTITY_ID = 0xFFFF;
+	static constexpr uint32_t WILDCARD_ENTITY_VERSION = 0xFF;
+	static constexpr uint32_t WILDCARD_RESOURCE_ID = 0xFFFF;
+
+	/// @param default_authority_name Authority assumed for UUris that do not
+	///                               name one.
+	/// @param filter UUri to match against, possibly containing wildcards.
+	UriFilter(const std::string& default_authority_name,
+	          const v1::UUri& filter);
+
+	/// @brief Check whether a UUri matches this filter.
+	[[nodiscard]] bool matches(const v1::UUri& uri) const;
+
+	/// @brief Parse a UUri pattern written as a uProtocol URI, such as
+	///        "//vehicle/10AB/1/8001" or "up://*/10AB/*/*".
+	///
+	/// The entity ID, version and resource ID are hexadecimal. Any field
+	/// can be "*", which stands for its wildcard value. A pattern with no
+	/// authority (e.g. "/10AB/1/8001") leaves the authority name empty, so
+	/// that it matches the default authority.
+	///
+	/// @returns The UUri, or std::nullopt if the text is malformed.
+	static std::optional<v1::UUri> parse(std::string_view text);
+
+private:
+	// Each field is std::nullopt when it is a wildcard
+	std::optional<std::string> authority_name_;
+	std::optional<uint32_t> ue_id_;
+	std::optional<uint32_t> ue_version_major_;
+	std::optional<uint32_t> resource_id_;
+
+	std::string default_authority_name_;
+};
+
+}  // namespace uprotocol::transport
+
+#endif  // UP_TRANSPORT_ZENOH_CPP_URIFILTER_H
@@ -13,9 +13,41 @@
 #define UP_TRANSPORT_ZENOH_CPP_ZENOHUTRANSPORT_H
 
 #include <up-cpp/transport/UTransport.h>
+#include <up-transport-zenoh-cpp/ArenaPool.h>
+#include <up-transport-zenoh-cpp/AsyncSender.h>
+#include <up-transport-zenoh-cpp/AttributesCodec.h>
+#include <up-transport-zenoh-cpp/Chunking.h>
+#include <up-transport-zenoh-cpp/Compression.h>
+#include <up-transport-zenoh-cpp/Dispatcher.h>
+#include <up-transport-zenoh-cpp/KeyExprTable.h>
+#include <up-transport-zenoh-cpp/LatestCache.h>
+#include <up-transport-zenoh-cpp/LruCache.h>
+#include <up-transport-zenoh-cpp/MessageRing.h>
+#include <up-transport-zenoh-cpp/Metrics.h>
+#include <up-transport-zenoh-cpp/PendingRequests.h>
+#include <up-transport-zenoh-cpp/RcuCell.h>
+#include <up-transport-zenoh-cpp/TransportConfig.h>
+#include <up-transport-zenoh-cpp/UriFilter.h>
 
+#include <zenoh.hxx>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace uprotocol::transport {
 
@@ -36,17 +68,354 @@ namespace uprotocol::transport {
 ///
 /// * [MUST] Throw an exception if the transport fails to initialize or the
 ///          configuration is invalid.
+///
+/// Messages are published on the Zenoh key expression derived from the UUri
+/// they are addressed to: the sink when the message has one, otherwise the
+/// source (i.e. the topic of a publish message). The UAttributes ride along
+/// as a Zenoh attachment, and the payload is sent as the Zenoh value.
+///
+/// Each instance opens its own Zenoh session, unless session.shared is set
+/// in its TransportConfig. Instances built from the same configuration file
+/// then share one session, which is closed when the last of them is
+/// destroyed. Each instance still has its own default UUri and listeners.
 struct ZenohUTransport : public UTransport {
 	/// @brief Constructor
 	///
 	/// @param defaultUri Default Authority and Entity (as a UUri) for
 	///                   clients using this transport instance.
 	/// @param configFile Path to a configuration file containing the Zenoh
-	///                   transport configuration.
+	///                   transport configuration. Settings specific to this
+	///                   transport are read from the section described in
+	///                   TransportConfig.
+	///
+	/// @throws std::invalid_argument if the transport settings are invalid.
+	/// @throws zenoh::ErrorMessage if the configuration file cannot be loaded
+	///         or the Zenoh session cannot be opened. With session.lazy,
+	///         the session is opened after the constructor returns, and a
+	///         failure to open it is reported by getReadyFuture() instead.
 	ZenohUTransport(const v1::UUri& defaultUri,
 	                const std::filesystem::path& configFile);
 
-	virtual ~ZenohUTransport() = default;
+	/// @brief Publishes anything still queued for sending, and stops
+	///        delivering replies to requests that are still outstanding.
+	///
+	/// @remarks Waits for the session to finish opening if it is still
+	///          being opened.
+	virtual ~ZenohUTransport();
+
+	/// @brief Get a future that is ready once the Zenoh session is open.
+	///
+	/// With session.lazy, the session opens in the background. Messages
+	/// sent and listeners registered in the meantime are queued, then
+	/// published and declared in order once it is open.
+	///
+	/// @returns A future holding OKSTATUS once the session is open, or
+	///          UNAVAILABLE if it could not be opened. It is ready on return
+	///          from the constructor unless session.lazy is set.
+	[[nodiscard]] std::shared_future<v1::UStatus> getReadyFuture() const;
+
+	using ReadyCallback = std::function<void(const v1::UStatus&)>;
+
+	/// @brief Call a function once the Zenoh session is open, or once it
+	///        has failed to open, with the same status as getReadyFuture().
+	///
+	/// @remarks Called right away if the session is already open (or has
+	///          failed), and on the thread that opened it otherwise.
+	void onReady(ReadyCallback&& callback);
+
+	using PublisherCacheStats = LruCacheStats;
+
+	/// @brief Get the hit, miss and eviction counts of the cache of
+	///        declared Zenoh publishers used by sendImpl().
+	[[nodiscard]] PublisherCacheStats getPublisherCacheStats() const;
+
+	/// @brief Get the number of Zenoh subscribers currently declared.
+	///
+	/// @remarks Listeners registered with the same sink filter share one
+	///          subscriber, as do the ones merged by registerListeners(),
+	///          so this can be lower than the listener count.
+	[[nodiscard]] size_t getSubscriptionCount() const;
+
+	/// @brief Get the state of the asynchronous send queue.
+	///
+	/// @returns The queue statistics, or std::nullopt if asynchronous
+	///          sending is disabled.
+	[[nodiscard]] std::optional<AsyncSender::Stats> getAsyncSendStats() const;
+
+	/// @brief Get the counters and latency histograms of every key
+	///        expression messages were sent or received on, along with the
+	///        depths of the send and dispatch queues.
+	///
+	/// @remarks Counters are updated without synchronizing with each other,
+	///          so a snapshot taken while messages flow may be off by the
+	///          messages in flight.
+	///
+	/// @returns The metrics, or std::nullopt if metrics are disabled.
+	[[nodiscard]] std::optional<MetricsSnapshot> getMetrics() const;
+
+	/// @brief Get the last messages received on a topic, as kept when
+	///        latest_cache is set in the TransportConfig.
+	///
+	/// @remarks Only messages received for a registered listener are kept.
+	///          Takes no lock.
+	///
+	/// @returns The messages, oldest first. Empty if the cache is disabled
+	///          or nothing has been received on the topic.
+	[[nodiscard]] LatestCache::Messages getLatest(const v1::UUri& topic) const;
+
+	/// @brief Send several messages with the overhead of a single call.
+	///
+	/// Each message is published exactly as sendImpl() would publish it, in
+	/// order. The destinations of the whole batch are resolved with one
+	/// acquisition of the publisher cache lock.
+	///
+	/// @remarks As with sendImpl(), the messages are not validated. Use
+	///          UTransport::send() for messages that need checking.
+	///
+	/// @param messages First of the messages to send.
+	/// @param count Number of messages to send.
+	///
+	/// @returns One status per message, in the same order, with the same
+	///          meaning as the status returned by sendImpl().
+	[[nodiscard]] std::vector<v1::UStatus> sendBatch(
+	    const v1::UMessage* messages, size_t count);
+
+	/// @brief Send several messages with the overhead of a single call.
+	///
+	/// @see sendBatch(const v1::UMessage*, size_t)
+	[[nodiscard]] std::vector<v1::UStatus> sendBatch(
+	    const std::vector<v1::UMessage>& messages) {
+		return sendBatch(messages.data(), messages.size());
+	}
+
+	/// @brief A listener to register with registerListeners().
+	struct ListenerRegistration {
+		v1::UUri sink_filter;
+		ListenCallback callback;
+		std::optional<v1::UUri> source_filter{};
+	};
+
+	/// @brief Register several listeners with the overhead of a single call.
+	///
+	/// Every listener is added with one update of the listener registry,
+	/// and the Zenoh subscribers of the new sink filters are declared
+	/// together. A sink filter covered by a wider one registered before or
+	/// in the same call, such as "//vehicle/10AB/1/8001" by
+	/// "//vehicle/10AB/1/*", shares the subscription of the wider filter
+	/// instead of declaring its own. Its listener still only receives the
+	/// messages matching its own filter.
+	///
+	/// @remarks As with sendBatch(), the filters are not validated. Use
+	///          UTransport::registerListener() for filters that need
+	///          checking.
+	///
+	/// @remarks A subscription keeps its wider key expression until its last
+	///          listener is gone, including the ones merged into it.
+	///
+	/// @param registrations First of the listeners to register. Their
+	///                      callbacks are moved from.
+	/// @param count Number of listeners to register.
+	///
+	/// @returns One result per listener, in the same order: the handle
+	///          keeping it registered, or the reason it could not be
+	///          registered.
+	[[nodiscard]] std::vector<utils::Expected<ListenHandle, v1::UStatus>>
+	registerListeners(ListenerRegistration* registrations, size_t count);
+
+	/// @brief Register several listeners with the overhead of a single call.
+	///
+	/// @see registerListeners(ListenerRegistration*, size_t)
+	[[nodiscard]] std::vector<utils::Expected<ListenHandle, v1::UStatus>>
+	registerListeners(std::vector<ListenerRegistration>&& registrations) {
+		return registerListeners(registrations.data(), registrations.size());
+	}
+
+	/// @brief Called with each chunk of a message as it arrives.
+	using ChunkCallback = std::function<void(const MessageChunk&)>;
+
+	/// @brief Keeps a chunk listener registered until it is reset or
+	///        destroyed.
+	///
+	/// @remarks Must be reset or destroyed before the transport that
+	///          issued it.
+	class ChunkListenerHandle {
+	public:
+		ChunkListenerHandle() = default;
+		ChunkListenerHandle(ChunkListenerHandle&& other) noexcept;
+		ChunkListenerHandle& operator=(ChunkListenerHandle&& other) noexcept;
+		ChunkListenerHandle(const ChunkListenerHandle&) = delete;
+		ChunkListenerHandle& operator=(const ChunkListenerHandle&) = delete;
+		~ChunkListenerHandle();
+
+		/// @brief Unregister the listener, stopping delivery to it.
+		void reset();
+
+		explicit operator bool() const { return callback_ != nullptr; }
+
+	private:
+		friend struct ZenohUTransport;
+
+		ChunkListenerHandle(ZenohUTransport* transport,
+		                    std::shared_ptr<ChunkCallback> callback)
+		    : transport_(transport), callback_(std::move(callback)) {}
+
+		ZenohUTransport* transport_{nullptr};
+		std::shared_ptr<ChunkCallback> callback_;
+	};
+
+	/// @brief Register a listener that is handed each chunk of a message
+	///        sent in chunks as soon as it arrives, instead of the whole
+	///        message once it is reassembled.
+	///
+	/// Chunks of a message arrive in order, each with the attributes of the
+	/// whole message. A message that was not sent in chunks arrives as a
+	/// single chunk.
+	///
+	/// @param sink_filter Same as for UTransport::registerListener().
+	/// @param callback Called with each chunk received.
+	/// @param source_filter Same as for UTransport::registerListener().
+	///
+	/// @returns The handle keeping the listener registered, or the reason
+	///          it could not be registered.
+	[[nodiscard]] utils::Expected<ChunkListenerHandle, v1::UStatus>
+	registerChunkListener(const v1::UUri& sink_filter,
+	                      ChunkCallback&& callback,
+	                      std::optional<v1::UUri>&& source_filter = {});
+
+	/// @brief Keeps a pull listener registered, and holds the messages it
+	///        received until they are taken with receive().
+	class PullSubscription {
+	public:
+		PullSubscription() = default;
+
+		/// @brief Take the oldest messages received.
+		///
+		/// @param messages First of the messages to fill. Passing the same
+		///                 messages on every call lets their buffers be
+		///                 reused.
+		/// @param count Largest number of messages to take.
+		/// @param timeout How long to wait if no message is buffered. Zero
+		///                does not wait.
+		///
+		/// @returns Number of messages taken, zero if none arrived in time
+		///          or the subscription has been reset.
+		size_t receive(v1::UMessage* messages, size_t count,
+		               std::chrono::milliseconds timeout);
+
+		/// @brief Take the oldest messages received, filling the vector up
+		///        to its current size.
+		///
+		/// @see receive(v1::UMessage*, size_t, std::chrono::milliseconds)
+		size_t receive(std::vector<v1::UMessage>& messages,
+		               std::chrono::milliseconds timeout) {
+			return receive(messages.data(), messages.size(), timeout);
+		}
+
+		/// @brief Number of messages buffered.
+		[[nodiscard]] size_t pending() const;
+
+		/// @brief Number of messages overwritten by newer ones before they
+		///        were taken.
+		[[nodiscard]] uint64_t dropped() const;
+
+		/// @brief Unregister the listener and discard the messages still
+		///        buffered.
+		void reset();
+
+		explicit operator bool() const { return ring_ != nullptr; }
+
+	private:
+		friend struct ZenohUTransport;
+
+		PullSubscription(ListenHandle&& handle,
+		                 std::shared_ptr<MessageRing> ring)
+		    : handle_(std::move(handle)), ring_(std::move(ring)) {}
+
+		ListenHandle handle_;
+		std::shared_ptr<MessageRing> ring_;
+	};
+
+	/// @brief Register a listener whose messages are buffered for the
+	///        application to take in batches, instead of being passed to a
+	///        callback one at a time.
+	///
+	/// Messages go through the same filtering, reassembly and dispatch as
+	/// for any other listener, then are copied into a ring of the given
+	/// capacity. Once the ring is full, each new message overwrites the
+	/// oldest one.
+	///
+	/// @param sink_filter Same as for UTransport::registerListener().
+	/// @param capacity Number of messages buffered. Must be non-zero.
+	/// @param source_filter Same as for UTransport::registerListener().
+	///
+	/// @returns The subscription to receive the messages from, or the
+	///          reason it could not be registered.
+	[[nodiscard]] utils::Expected<PullSubscription, v1::UStatus>
+	registerPullListener(const v1::UUri& sink_filter, size_t capacity,
+	                     std::optional<v1::UUri>&& source_filter = {});
+
+	/// @brief Called with whether a topic has subscribers.
+	using MatchingCallback = std::function<void(bool matching)>;
+
+	/// @brief Keeps a matching listener registered until it is reset or
+	///        destroyed.
+	///
+	/// @remarks Must be reset or destroyed before the transport that
+	///          issued it.
+	class MatchingHandle {
+	public:
+		MatchingHandle() = default;
+		MatchingHandle(MatchingHandle&& other) noexcept;
+		MatchingHandle& operator=(MatchingHandle&& other) noexcept;
+		MatchingHandle(const MatchingHandle&) = delete;
+		MatchingHandle& operator=(const MatchingHandle&) = delete;
+		~MatchingHandle();
+
+		/// @brief Unregister the listener, stopping calls to it.
+		void reset();
+
+		explicit operator bool() const { return callback_ != nullptr; }
+
+	private:
+		friend struct ZenohUTransport;
+
+		MatchingHandle(ZenohUTransport* transport, std::string zenoh_key,
+		               std::shared_ptr<MatchingCallback> callback)
+		    : transport_(transport),
+		      zenoh_key_(std::move(zenoh_key)),
+		      callback_(std::move(callback)) {}
+
+		ZenohUTransport* transport_{nullptr};
+		std::string zenoh_key_;
+		std::shared_ptr<MatchingCallback> callback_;
+	};
+
+	/// @brief Register a callback told whether anyone subscribes to a
+	///        topic this transport publishes on, so that a producer can
+	///        stop generating messages nobody receives.
+	///
+	/// The callback is called once right away with the current status, then
+	/// on a Zenoh thread each time it changes. Subscribers of every session,
+	/// this one included, are counted.
+	///
+	/// @param topic The source of the messages published.
+	/// @param callback Called with true once the topic has subscribers, and
+	///                 with false once it has none left.
+	///
+	/// @returns The handle keeping the callback registered, or
+	///          UNAVAILABLE if the session is not open yet, INVALID_ARGUMENT
+	///          if the topic does not form a valid Zenoh key, or INTERNAL if
+	///          Zenoh could not declare the listener.
+	[[nodiscard]] utils::Expected<MatchingHandle, v1::UStatus>
+	registerMatchingListener(const v1::UUri& topic,
+	                         MatchingCallback&& callback);
+
+	/// @brief Get whether a topic has subscribers.
+	///
+	/// @returns The status, or std::nullopt if no matching listener is
+	///          registered for the topic, in which case it is not tracked.
+	[[nodiscard]] std::optional<bool> hasSubscribers(
+	    const v1::UUri& topic) const;
 
 protected:
 	/// @brief Send a message.
@@ -54,7 +423,13 @@ protected:
 	/// @param message UMessage to be sent.
 	///
 	/// @returns * OKSTATUS if the payload has been successfully
-	///            sent (ACK'ed)
+	///            sent (ACK'ed), or queued for the I/O thread when
+	///            asynchronous sending is enabled
+	///          * RESOURCE_EXHAUSTED if the send queue is full and its
+	///            overflow policy is "fail_fast"
+	///          * UNAVAILABLE if matching.skip_unmatched is set and a
+	///            matching listener reports that the topic has no
+	///            subscribers
 	///          * FAILSTATUS with the appropriate failure otherwise.
 	[[nodiscard]] virtual v1::UStatus sendImpl(
 	    const v1::UMessage& message) override;
@@ -95,6 +470,672 @@ protected:
 	virtual void cleanupListener(CallableConn listener) override;
 
 private:
+	/// @brief Delegated constructor once the Zenoh config has been loaded.
+	ZenohUTransport(const v1::UUri& defaultUri,
+	                const std::filesystem::path& configFile,
+	                zenoh::Config&& config);
+
+	static v1::UStatus uError(v1::UCode code, std::string_view message);
+
+	using Attachment = std::vector<std::pair<std::string, std::string>>;
+
+	static Attachment uattributesToAttachment(
+	    const v1::UAttributes& attributes, AttributesCodec::Format format);
+
+	/// @brief How a received payload was sent, from the optional entries
+	///        of its attachment.
+	struct PayloadFormat {
+		/// @brief Set when the payload is one chunk of the message.
+		std::optional<ChunkHeader> chunk;
+		/// @brief Set when the payload is compressed.
+		std::optional<Compression::Header> compression;
+	};
+
+	/// @brief Decode attributes from an attachment into an empty message.
+	///
+	/// @param format Where to decode the optional entries. Attachments
+	///               with optional entries are rejected when this is
+	///               nullptr.
+	static bool attachmentToUAttributes(
+	    const zenoh::AttachmentView& attachment, v1::UAttributes& attributes,
+	    PayloadFormat* format = nullptr);
+
+	/// @brief Decode only the UAttributes (and payload format, if any)
+	///        attached to a sample.
+	static bool sampleToUAttributes(const zenoh::Sample& sample,
+	                                v1::UAttributes& attributes,
+	                                PayloadFormat* format = nullptr);
+
+	/// @brief Copy a received payload into a message.
+	static void setPayload(v1::UMessage& message,
+	                       const zenoh::BytesView& payload);
+
+	/// @brief Copy a received payload into a message, decompressing it if
+	///        it is compressed.
+	///
+	/// @returns false if the payload could not be decompressed, or would
+	///          exceed the decompressed size limit.
+	bool setPayload_(
+	    v1::UMessage& message, const zenoh::BytesView& payload,
+	    const std::optional<Compression::Header>& compression) const;
+
+	const TransportConfig config_;
+
+	/// @brief The session of this instance, or the one it shares with
+	///        every instance built from the same configuration file. Set
+	///        under subscriptions_mutex_, and null until it is open.
+	std::shared_ptr<zenoh::Session> session_;
+
+	enum class SessionState { OPENING, OPEN, FAILED };
+
+	/// @brief Read without a lock on every send. Only leaves OPENING under
+	///        startup_mutex_, once the messages queued meanwhile are sent.
+	std::atomic<SessionState> session_state_{SessionState::OPENING};
+
+	/// @brief Open the session and declare the subscriptions registered
+	///        meanwhile, then finish startup.
+	///
+	/// @throws zenoh::ErrorMessage if the session cannot be opened, unless
+	///         session.lazy is set.
+	void openSession_(const std::filesystem::path& configFile,
+	                  zenoh::Config&& config);
+
+	/// @brief Send the messages queued while opening, then mark the
+	///        session open (or failed) and tell whoever is waiting.
+	void finishStartup_(const v1::UStatus& status);
+
+	/// @brief Queue a message until the session is open.
+	///
+	/// @returns The status for the caller, or std::nullopt if the session is
+	///          now open and the message should be sent right away.
+	std::optional<v1::UStatus> deferSend_(const v1::UMessage& message);
+
+	std::mutex startup_mutex_;
+	std::vector<v1::UMessage> deferred_sends_;
+	std::vector<ReadyCallback> ready_callbacks_;
+	std::optional<v1::UStatus> startup_status_;
+	std::promise<v1::UStatus> ready_promise_;
+	std::shared_future<v1::UStatus> ready_future_;
+
+	KeyExprTable key_exprs_;
+
+	/// @brief Set when metrics are enabled.
+	std::optional<MetricsRegistry> metrics_;
+
+	/// @brief Get the metrics of a key expression.
+	///
+	/// @returns The metrics, or nullptr if metrics are disabled.
+	std::shared_ptr<TopicMetrics> metricsFor_(const std::string& zenoh_key);
+
+	/// @brief Check whether a message about to be sent has outlived its
+	///        TTL, counting it in the metrics of its key if so.
+	///
+	/// @returns true if the message is expired and must not be sent.
+	bool dropExpired_(const v1::UMessage& message,
+	                  const InternedKeyExpr& zenoh_key);
+
+	/// @brief Get the key expression a message is published on.
+	///
+	/// @returns The key expression, or nullptr if the destination does not
+	///          form a valid one.
+	std::shared_ptr<const InternedKeyExpr> destinationKey_(
+	    const v1::UAttributes& attributes);
+
+	/// @brief A compression rule, with its pattern compiled.
+	struct CompressionRule {
+		UriFilter filter;
+		Compression::Codec codec;
+		int level;
+		size_t threshold;
+	};
+
+	static std::vector<CompressionRule> makeCompressionRules(
+	    const std::string& default_authority_name,
+	    const TransportConfig::Compression& config);
+
+	const std::vector<CompressionRule> compression_rules_;
+
+	/// @brief Get the rule a message payload of the given size is
+	///        compressed by.
+	///
+	/// @returns The rule, or nullptr if the payload is sent uncompressed.
+	[[nodiscard]] const CompressionRule* compressionFor_(
+	    const v1::UAttributes& attributes, size_t size) const;
+
+	/// @brief Compress a payload, or one chunk of it, by a rule.
+	///
+	/// @returns The compressed payload, whose header has been added to the
+	///          attachment, or std::nullopt if the payload is to be sent as
+	///          it is.
+	static std::optional<std::string> compress(const CompressionRule* rule,
+	                                           std::string_view payload,
+	                                           Attachment& attachment);
+
+	/// @brief A reliability rule, with its pattern compiled.
+	struct ReliabilityRule {
+		UriFilter filter;
+		TransportConfig::Reliability::Mode mode;
+	};
+
+	static std::vector<ReliabilityRule> makeReliabilityRules(
+	    const std::string& default_authority_name,
+	    const TransportConfig::Reliability& config);
+
+	const std::vector<ReliabilityRule> reliability_rules_;
+
+	/// @brief Get the reliability chosen for a destination or sink filter.
+	///
+	/// @returns The mode of the first rule matching, or std::nullopt if
+	///          none does.
+	[[nodiscard]] std::optional<TransportConfig::Reliability::Mode>
+	reliabilityFor_(const v1::UUri& uri) const;
+
+	/// @brief Get the QoS settings messages of a priority are sent with.
+	[[nodiscard]] const TransportConfig::Qos::Lane& laneFor_(
+	    v1::UPriority priority) const;
+
+	/// @brief Get the QoS settings a message is sent with: those of its
+	///        priority, with the congestion control of its reliability.
+	[[nodiscard]] TransportConfig::Qos::Lane laneFor_(
+	    const v1::UAttributes& attributes) const;
+
+	/// @brief Get the declared publisher for a key and the priority of a
+	///        message, declaring it on a cache miss.
+	///
+	/// @returns The publisher, or nullptr if caching is disabled or the
+	///          publisher could not be declared.
+	std::shared_ptr<zenoh::Publisher> getPublisher_(
+	    const InternedKeyExpr& zenoh_key, const v1::UAttributes& attributes);
+
+	/// @brief Same as getPublisher_(), for callers already holding
+	///        publisher_cache_mutex_.
+	std::shared_ptr<zenoh::Publisher> getPublisherLocked_(
+	    const InternedKeyExpr& zenoh_key, const v1::UAttributes& attributes);
+
+	/// @brief Send a message once its key is known and the session open.
+	v1::UStatus send_(const v1::UMessage& message,
+	                  std::shared_ptr<const InternedKeyExpr> zenoh_key);
+
+	/// @brief Publish a message on its key, through the given publisher if
+	///        there is one and directly on the session otherwise.
+	v1::UStatus publish_(const v1::UMessage& message,
+	                     const InternedKeyExpr& zenoh_key,
+	                     zenoh::Publisher* publisher);
+
+	/// @brief Hand a message to Zenoh, once its attributes are encoded, as
+	///        a query, reply or put.
+	v1::UStatus transmit_(const v1::UMessage& message,
+	                      const InternedKeyExpr& zenoh_key,
+	                      zenoh::Publisher* publisher, Attachment& attachment);
+
+	/// @brief Put a payload larger than the chunk size as a sequence of
+	///        chunks, each carrying the attachment and its chunk header.
+	v1::UStatus putChunked_(const v1::UMessage& message,
+	                        const InternedKeyExpr& zenoh_key,
+	                        zenoh::Publisher* publisher,
+	                        const Attachment& attachment,
+	                        const CompressionRule* compression);
+
+	/// @brief Put a payload on a key, through the publisher if there is one
+	///        and directly on the session otherwise.
+	///
+	/// @param lane QoS of the put. A publisher already has its own.
+	bool put_(const InternedKeyExpr& zenoh_key, zenoh::Publisher* publisher,
+	          const TransportConfig::Qos::Lane& lane,
+	          std::string_view payload, const Attachment& attachment,
+	          zenoh::ErrNo& error);
+
+#ifdef UP_TRANSPORT_ZENOH_SHM
+	/// @brief Copy a payload into the shared-memory segment.
+	///
+	/// @returns The shared-memory payload, or std::nullopt if the payload is
+	///          below the threshold or the segment is full. In either case
+	///          the payload should be published from the heap instead.
+	std::optional<zenoh::Payload> toShmPayload_(std::string_view payload);
+
+	std::optional<zenoh::ShmManager> shm_manager_;
+	std::mutex shm_manager_mutex_;
+#endif
+
+	/// @brief Zenoh sets the QoS of a publisher when declaring it, so a key
+	///        gets one publisher per class of service it is sent with.
+	struct PublisherKey {
+		std::string key;
+		size_t service_class;
+
+		bool operator==(const PublisherKey& other) const {
+			return (service_class == other.service_class) &&
+			       (key == other.key);
+		}
+	};
+
+	struct PublisherKeyHash {
+		size_t operator()(const PublisherKey& key) const {
+			return std::hash<std::string>()(key.key) ^ key.service_class;
+		}
+	};
+
+	// Publishers are shared so that one evicted mid-put stays alive until
+	// the put completes.
+	LruCache<PublisherKey, std::shared_ptr<zenoh::Publisher>,
+	         PublisherKeyHash>
+	    publisher_cache_;
+	mutable std::mutex publisher_cache_mutex_;
+
+	/// @brief Arenas received messages are built on.
+	ArenaPool arena_pool_;
+
+	/// @brief A received message, allocated on a pooled arena that is
+	///        recycled once every copy of the lease is gone.
+	struct ReceivedMessage {
+		ArenaPool::Lease arena;
+		v1::UMessage* message;
+		/// @brief Set when the payload is one chunk of the message.
+		std::optional<ChunkHeader> chunk{};
+		/// @brief Set when the payload was reassembled from chunks that
+		///        chunk listeners have already been handed.
+		bool reassembled{false};
+		/// @brief Owns the message when it is not on an arena, such as a
+		///        copy handed over by loopBack_().
+		std::shared_ptr<v1::UMessage> owned{};
+	};
+
+	/// @brief Create an empty message on a pooled arena.
+	ReceivedMessage newMessage_();
+
+	// Declared before the subscribers, so that no subscriber is left to
+	// post to it once it is destroyed. Declared after arena_pool_, so that
+	// queued deliveries release their arenas first.
+	std::optional<Dispatcher> dispatcher_;
+
+	/// @brief A registered listener, as seen by the receive path.
+	/// @brief What a listener was handed on each topic while the messages
+	///        queryLatest_() asked for on its behalf may still arrive, so
+	///        that none of them is delivered twice, or after a newer one.
+	struct LatestReplies {
+		struct Topic {
+			v1::UUri source;
+			/// @brief Creation time of the newest message delivered whose
+			///        ID holds one.
+			std::optional<std::chrono::system_clock::time_point> newest;
+			std::vector<v1::UUID> ids;
+		};
+
+		std::mutex mutex;
+		std::vector<Topic> topics;
+		/// @brief Set once every reply has been delivered, after which
+		///        nothing is tracked any more.
+		std::atomic<bool> done{false};
+
+		/// @brief Note a message about to be delivered to the listener.
+		///
+		/// @param reply Whether the message is a reply to the query.
+		///
+		/// @returns false if the message is a reply that was delivered
+		///          already, or is older than one that was.
+		bool admit(const v1::UAttributes& attributes, bool reply);
+
+		/// @brief Stop tracking, once the query is done.
+		void finish();
+	};
+
+	struct Listener {
+		CallableConn callback;
+		std::optional<UriFilter> source_filter;
+		/// @brief Set for chunk listeners, instead of callback. Weak, so
+		///        that nothing is delivered once the handle lets go.
+		std::weak_ptr<ChunkCallback> chunk_callback{};
+		bool wants_chunks{false};
+		/// @brief Set when the listener shares the subscription of a wider
+		///        sink filter than its own.
+		std::optional<UriFilter> sink_filter{};
+		/// @brief Set for listeners queried by queryLatest_(). Shared by
+		///        every copy of the listener.
+		std::shared_ptr<LatestReplies> latest_replies{};
+
+		/// @brief Check whether the listener wants a message, from its
+		///        attributes alone.
+		[[nodiscard]] bool accepts(const v1::UAttributes& attributes) const;
+	};
+
+	/// @brief Every listener sharing one Zenoh subscription.
+	struct ListenerGroup {
+		/// @brief The sink filter the listeners were registered with.
+		UriFilter sink_filter;
+		/// @brief Dispatch shard of the sink filter, if dispatching.
+		size_t shard{0};
+		std::vector<Listener> listeners;
+		/// @brief Reassembles chunked messages for the listeners that want
+		///        them whole. Shared by every copy of the group.
+		std::shared_ptr<ChunkAssembler> assembler;
+		/// @brief Metrics of the subscription key, or nullptr if metrics
+		///        are disabled.
+		std::shared_ptr<TopicMetrics> metrics{};
+
+		/// @brief Check whether any listener wants a message.
+		[[nodiscard]] bool accepts(const v1::UAttributes& attributes) const;
+
+		/// @brief Check whether any listener wanting chunks (or wanting
+		///        whole messages, if chunks is false) accepts a message.
+		[[nodiscard]] bool accepts(const v1::UAttributes& attributes,
+		                           bool chunks) const;
+	};
+
+	using ListenerRegistry =
+	    std::unordered_map<uint64_t, std::shared_ptr<const ListenerGroup>>;
+
+	/// @brief Listener groups by subscription ID. Read on every received
+	///        sample without taking a lock, and updated by copy-on-write.
+	RcuCell<ListenerRegistry> listeners_;
+
+	/// @brief Remove the listeners matching a predicate from the
+	///        subscription of a key, undeclaring it if none are left.
+	///
+	/// @remarks Requires subscriptions_mutex_ to be held.
+	void unsubscribe_(const std::string& zenoh_key,
+	                  const std::function<bool(const Listener&)>& matches);
+
+	/// @brief Unregister a chunk listener, for ChunkListenerHandle.
+	void cleanupChunkListener_(const ChunkCallback* callback);
+
+	/// @brief Get the listener group of a subscription.
+	///
+	/// @returns The group, or nullptr if it has been cleaned up.
+	std::shared_ptr<const ListenerGroup> getListeners_(
+	    uint64_t subscription_id) const;
+
+	/// @brief Decode a sample once and deliver it to every listener of a
+	///        subscription.
+	void onSample_(uint64_t subscription_id, const zenoh::Sample& sample);
+
+	/// @brief Hand a chunk to the chunk listeners of a subscription, and
+	///        its reassembled message to the others once it is complete.
+	void onChunk_(std::shared_ptr<const ListenerGroup> listeners,
+	              ReceivedMessage&& received);
+
+	/// @brief Deliver an RPC request received by a queryable, keeping the
+	///        query so that the response can be sent as its reply.
+	void onQuery_(uint64_t subscription_id, const zenoh::Query& query);
+
+	/// @brief Deliver an RPC response received as the reply to a query to
+	///        every listener whose sink filter matches it.
+	void onReply_(zenoh::Reply&& reply);
+
+	/// @brief Deliver a message to a listener group, on its dispatch thread
+	///        if there are dispatch threads.
+	void dispatch_(std::shared_ptr<const ListenerGroup> listeners,
+	               const ReceivedMessage& received);
+
+	/// @brief Deliver a message to the listeners whose source filter it
+	///        matches.
+	static void deliver_(const ListenerGroup& listeners,
+	                     const ReceivedMessage& received);
+
+	/// @brief Messages received on each topic, or std::nullopt if the
+	///        latest value cache is disabled.
+	std::optional<LatestCache> latest_;
+
+	/// @brief Messages this transport published on each topic, kept to
+	///        answer queries when latest_cache.query is set.
+	std::optional<LatestCache> published_;
+
+	/// @brief One queryable per topic in published_. Declared after it,
+	///        so that they are undeclared before it is destroyed.
+	std::vector<zenoh::Queryable> published_queryables_;
+	std::mutex published_queryables_mutex_;
+
+	/// @brief The matching listener of a topic, shared by the callbacks
+	///        registered for it.
+	struct MatchingWatch {
+		std::atomic<bool> matching{false};
+		RcuCell<std::vector<std::shared_ptr<MatchingCallback>>> callbacks;
+		/// @brief Declared only to be matched against, never put on.
+		std::optional<zenoh::Publisher> publisher;
+		std::optional<zenoh::MatchingListener> listener;
+	};
+
+	/// @brief Watched topics, by Zenoh key. Declared after session_, so
+	///        that they are undeclared before it is closed.
+	std::unordered_map<std::string, std::shared_ptr<MatchingWatch>>
+	    matching_;
+	mutable std::mutex matching_mutex_;
+
+	/// @brief Pass a new matching status to the callbacks of a topic.
+	static void onMatching_(MatchingWatch& watch, bool matching);
+
+	/// @brief Get whether the topic of a key has subscribers, if watched.
+	[[nodiscard]] std::optional<bool> hasSubscribers_(
+	    const std::string& zenoh_key) const;
+
+	/// @brief Check whether a message would be sent to nobody, and is to
+	///        be skipped as matching.skip_unmatched asks.
+	[[nodiscard]] bool skipUnmatched_(const v1::UMessage& message,
+	                                  const InternedKeyExpr& zenoh_key) const;
+
+	void cleanupMatchingListener_(const std::string& zenoh_key,
+	                              const MatchingCallback* callback);
+
+	/// @brief Cache a received message, if it was published on a topic.
+	void cacheLatest_(const ReceivedMessage& received);
+
+	/// @brief Keep a message published by this transport, declaring the
+	///        queryable answering for its topic the first time.
+	void cachePublished_(const v1::UMessage& message,
+	                     const InternedKeyExpr& zenoh_key);
+
+	/// @brief Reply to a query with the messages published on a topic.
+	void onLatestQuery_(const InternedKeyExpr& zenoh_key,
+	                    const zenoh::Query& query);
+
+	/// @brief Query the last messages published on the topics of a sink
+	///        filter, and deliver them to a newly registered listener.
+	///
+	/// @param subscription_key Key of the subscription of the listener,
+	///                         whose dispatch thread and metrics the
+	///                         messages go through.
+	///
+	/// @remarks Requires the session to be open.
+	void queryLatest_(const v1::UUri& sink_filter,
+	                  const std::string& subscription_key, Listener listener);
+
+	/// @brief Deliver a message received in reply to queryLatest_().
+	void onLatestReply_(const Listener& listener, size_t shard,
+	                    std::shared_ptr<TopicMetrics> metrics,
+	                    zenoh::Reply&& reply);
+
+	/// @brief A queryLatest_() call waiting for the session to open.
+	struct LatestQuery {
+		v1::UUri sink_filter;
+		std::string subscription_key;
+		Listener listener;
+	};
+
+	/// @brief Queries of the listeners registered while the session was
+	///        opening. Guarded by subscriptions_mutex_.
+	std::vector<LatestQuery> deferred_latest_queries_;
+
+	/// @brief Make a listener track what it is handed, if registering it
+	///        queries the last messages of its topics.
+	///
+	/// @returns Whether the listener is to be queried.
+	bool trackLatestReplies_(const v1::UUri& sink_filter,
+	                         Listener& listener) const;
+
+	/// @brief Query the last messages for a listener now, or once the
+	///        session is open.
+	///
+	/// @remarks Requires subscriptions_mutex_ to be held.
+	///
+	/// @returns Whether the query is to be made now, once the lock is
+	///          released.
+	bool scheduleLatestQuery_(const v1::UUri& sink_filter,
+	                          const std::string& subscription_key,
+	                          const Listener& listener);
+
+	/// @brief One Zenoh subscriber and/or queryable, shared by every
+	///        listener registered with the same sink filter key.
+	struct Subscription {
+		uint64_t id;
+		/// @brief Number of listeners using the subscription.
+		size_t listeners;
+		std::shared_ptr<const InternedKeyExpr> zenoh_key;
+		UriFilter sink_filter;
+		/// @brief Sources selected by the key, or std::nullopt if it
+		///        receives from every source.
+		std::optional<UriFilter> source_filter;
+		/// @brief Reliability of the subscriber, or std::nullopt for the
+		///        Zenoh default.
+		std::optional<TransportConfig::Reliability::Mode> reliability;
+		bool wants_samples;
+		bool wants_queries;
+		/// @brief Receives published messages and notifications.
+		std::optional<zenoh::Subscriber> subscriber;
+		/// @brief Receives RPC requests sent as queries.
+		std::optional<zenoh::Queryable> queryable;
+	};
+
+	// Only used by registration and cleanup, never on the receive path
+	std::unordered_map<std::string, Subscription> subscriptions_;
+	std::map<CallableConn, std::string> listener_keys_;
+	std::map<const ChunkCallback*, std::string> chunk_listener_keys_;
+	uint64_t next_subscription_id_{0};
+	mutable std::mutex subscriptions_mutex_;
+
+	/// @brief Declare whatever subscriber and queryable a subscription
+	///        wants and does not have yet.
+	///
+	/// @remarks Requires subscriptions_mutex_ to be held, and the session
+	///          to be open.
+	v1::UStatus declare_(Subscription& subscription);
+
+	/// @brief A listener to add with subscribe_().
+	struct NewListener {
+		const v1::UUri& sink_filter;
+		const v1::UUri* source_filter;
+		Listener listener;
+	};
+
+	/// @brief Get the key expression to subscribe to for a sink filter,
+	///        selecting the sources of a source filter when the key format
+	///        carries them.
+	///
+	/// @returns The key expression, or nullptr if the filters do not form
+	///          a valid one.
+	std::shared_ptr<const InternedKeyExpr> subscriptionKey_(
+	    const v1::UUri& sink_filter, const v1::UUri* source_filter);
+
+	/// @brief Add listeners to the subscriptions of their sink filters,
+	///        declaring the subscriptions that do not exist yet.
+	///
+	/// @remarks Requires subscriptions_mutex_ to be held.
+	///
+	/// @param merge Add a listener whose sink filter is covered by the
+	///              filter of another subscription to that subscription,
+	///              instead of declaring one of its own.
+	///
+	/// @returns For each listener, the key of its subscription, or the
+	///          failure status.
+	std::vector<utils::Expected<std::string, v1::UStatus>> subscribe_(
+	    std::vector<NewListener>&& listeners, bool merge);
+
+	/// @brief Add a single listener, without merging.
+	utils::Expected<std::string, v1::UStatus> subscribe_(
+	    const v1::UUri& sink_filter, const v1::UUri* source_filter,
+	    Listener&& listener);
+
+	/// @brief Find a subscription whose filters cover those of a listener,
+	///        and that receives everything it needs to with the same
+	///        reliability.
+	///
+	/// @returns The subscription, or nullptr if there is none.
+	Subscription* coveringSubscription_(
+	    const v1::UUri& sink_filter, const v1::UUri* source_filter,
+	    bool wants_samples, bool wants_queries,
+	    std::optional<TransportConfig::Reliability::Mode> reliability);
+
+	/// @brief Add listeners to the groups of their subscriptions with one
+	///        update of the registry, creating each group on its first
+	///        listener.
+	void addListeners_(
+	    std::vector<std::pair<const Subscription*, Listener>>&& additions);
+
+	/// @brief Check whether a message goes through a Zenoh query instead
+	///        of a put.
+	[[nodiscard]] bool isQueryMessage_(const v1::UAttributes& attributes) const;
+
+	/// @brief Send an RPC request as a Zenoh query on its key.
+	v1::UStatus query_(const v1::UMessage& message,
+	                   const InternedKeyExpr& zenoh_key,
+	                   const Attachment& attachment);
+
+	/// @brief Send an RPC response as the reply to the query that carried
+	///        its request.
+	///
+	/// @returns The status of the reply, or std::nullopt if no query is
+	///          waiting for this response.
+	std::optional<v1::UStatus> reply_(const v1::UMessage& message,
+	                                  const Attachment& attachment);
+
+	/// @brief Forget a request sent as a query once Zenoh reports that
+	///        no more replies will come for it.
+	void onQueryDone_(const v1::UUID& request_id);
+
+	/// @brief Received queries, kept until their response is sent or their
+	///        request expires.
+	PendingRequests<zenoh::OwnedQuery> pending_queries_;
+	std::mutex pending_queries_mutex_;
+
+	/// @brief When each request sent as a query went out, kept until its
+	///        first reply arrives or it expires. Later replies are dropped.
+	PendingRequests<std::chrono::steady_clock::time_point>
+	    outstanding_requests_;
+	std::mutex outstanding_requests_mutex_;
+
+	/// @brief Lets callbacks that can outlive the transport, such as the
+	///        replies to outstanding queries, check that it still exists.
+	struct CallbackGuard {
+		std::shared_mutex mutex;
+		ZenohUTransport* transport;
+	};
+
+	std::shared_ptr<CallbackGuard> callback_guard_;
+
+	/// @brief The transports on one Zenoh session that have loopback
+	///        enabled, which hand each other the messages they send.
+	struct LoopbackBus {
+		RcuCell<std::vector<std::shared_ptr<CallbackGuard>>> members;
+	};
+
+	/// @brief Bus of the session, set once it is open when loopback is
+	///        enabled. Declared after session_, so that it is released
+	///        first.
+	std::shared_ptr<LoopbackBus> loopback_;
+
+	/// @brief Join the loopback bus of the session, creating it for the
+	///        first transport.
+	void joinLoopback_();
+
+	/// @brief Hand a message that was sent, or queued for the I/O thread,
+	///        to the matching listeners of every transport on the loopback
+	///        bus.
+	void loopBack_(const v1::UMessage& message);
+
+	/// @brief Find the listener groups of this transport that accept a
+	///        message sent by a transport on the same session.
+	std::vector<std::shared_ptr<const ListenerGroup>> loopbackGroups_(
+	    const v1::UAttributes& attributes) const;
+
+	/// @brief Queue a message for the I/O thread of async_sender_.
+	v1::UStatus enqueue_(const v1::UMessage& message,
+	                     std::shared_ptr<const InternedKeyExpr> zenoh_key);
+
+	// Destroyed first, so queued messages are published while the session
+	// and publisher cache still exist
+	std::optional<AsyncSender> async_sender_;
+
+	/// @brief Opens the session when session.lazy is set. Joined by the
+	///        destructor before anything else is torn down.
+	std::thread startup_thread_;
 };
 
 }  // namespace uprotocol::transport
@@ -0,0 +1,107 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/ArenaPool.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace uprotocol::transport {
+
+ArenaPool::ArenaPool(size_t arenas, size_t block_size)
+    : free_(std::max<size_t>(arenas, 1)) {
+	slots_.reserve(arenas);
+	for (size_t i = 0; i < arenas; ++i) {
+		auto slot = std::make_unique<Slot>();
+		slot->pool = this;
+		google::protobuf::ArenaOptions options;
+		if (block_size > 0) {
+			slot->block = std::make_unique<char[]>(block_size);
+			options.initial_block = slot->block.get();
+			options.initial_block_size = block_size;
+		}
+		slot->arena.emplace(options);
+
+		Slot* free_slot = slot.get();
+		free_.tryPush(free_slot);
+		slots_.push_back(std::move(slot));
+	}
+}
+
+ArenaPool::~ArenaPool() = default;
+
+ArenaPool::Lease ArenaPool::acquire() {
+	if (auto slot = free_.tryPop()) {
+		return Lease(*slot);
+	}
+	auto* slot = new Slot();
+	slot->arena.emplace();
+	return Lease(slot);
+}
+
+void ArenaPool::release_(Slot* slot) {
+	// Frees everything allocated on the arena, apart from its initial block
+	slot->arena->Reset();
+	free_.tryPush(slot);
+}
+
+ArenaPool::Lease::Lease(Slot* slot) : slot_(slot) {
+	slot_->leases.fetch_add(1, std::memory_order_relaxed);
+}
+
+ArenaPool::Lease::Lease(const Lease& other) : slot_(other.slot_) {
+	if (slot_ != nullptr) {
+		slot_->leases.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+ArenaPool::Lease::Lease(Lease&& other) noexcept
+    : slot_(std::exchange(other.slot_, nullptr)) {}
+
+ArenaPool::Lease& ArenaPool::Lease::operator=(const Lease& other) {
+	if (this != &other) {
+		Lease copy(other);
+		*this = std::move(copy);
+	}
+	return *this;
+}
+
+ArenaPool::Lease& ArenaPool::Lease::operator=(Lease&& other) noexcept {
+	if (this != &other) {
+		release_();
+		slot_ = std::exchange(other.slot_, nullptr);
+	}
+	return *this;
+}
+
+ArenaPool::Lease::~Lease() { release_(); }
+
+google::protobuf::Arena* ArenaPool::Lease::get() const {
+	return (slot_ == nullptr) ? nullptr : &*slot_->arena;
+}
+
+void ArenaPool::Lease::release_() {
+	if (slot_ == nullptr) {
+		return;
+	}
+	// Whoever drops the last lease resets the arena, and must see every
+	// write made through the others
+	if (slot_->leases.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		if (slot_->pool != nullptr) {
+			slot_->pool->release_(slot_);
+		} else {
+			delete slot_;
+		}
+	}
+	slot_ = nullptr;
+}
+
+}  // namespace uprotocol::transport
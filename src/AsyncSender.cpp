@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/AsyncSender.h"
+
+#include <utility>
+
+namespace uprotocol::transport {
+
+AsyncSender::AsyncSender(const TransportConfig::AsyncSend& config,
+                         Publish publish, const ThreadPlacement& placement)
+    : queue_(config.queue_capacity),
+      overflow_(config.overflow),
+      publish_(std::move(publish)),
+      thread_([this, placement]() {
+	      if (!placement.empty()) {
+		      placement.apply("async send");
+	      }
+	      run_();
+      }) {}
+
+AsyncSender::~AsyncSender() {
+	{
+		std::lock_guard lock(wait_mutex_);
+		stopping_ = true;
+	}
+	items_available_.notify_one();
+	space_available_.notify_all();
+	thread_.join();
+}
+
+bool AsyncSender::submit(Item&& item) {
+	while (!queue_.tryPush(item)) {
+		switch (overflow_) {
+			case Overflow::FAIL_FAST:
+				++rejected_;
+				return false;
+			case Overflow::DROP_OLDEST:
+				// Another thread may have emptied a slot in the meantime, in
+				// which case there is nothing to drop and the push is retried
+				if (queue_.tryPop()) {
+					++dropped_;
+				}
+				break;
+			case Overflow::BLOCK:
+				waitForSpace_();
+				break;
+		}
+	}
+	wakeSender_();
+	return true;
+}
+
+AsyncSender::Stats AsyncSender::stats() const {
+	Stats stats;
+	stats.queued = queue_.size();
+	stats.dropped = dropped_;
+	stats.rejected = rejected_;
+	stats.capacity = queue_.capacity();
+	return stats;
+}
+
+void AsyncSender::run_() {
+	for (;;) {
+		while (auto item = queue_.tryPop()) {
+			wakeSubmitters_();
+			publish_(*item);
+		}
+
+		std::unique_lock lock(wait_mutex_);
+		if (stopping_ && queue_.empty()) {
+			return;
+		}
+		sender_waiting_ = true;
+		// Pairs with the fence in wakeSender_(): either the submitter sees
+		// sender_waiting_, or this thread sees the item it pushed
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		items_available_.wait(
+		    lock, [this]() { return stopping_ || !queue_.empty(); });
+		sender_waiting_ = false;
+	}
+}
+
+void AsyncSender::waitForSpace_() {
+	std::unique_lock lock(wait_mutex_);
+	++submitters_waiting_;
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	space_available_.wait(lock,
+	                      [this]() { return stopping_ || !queue_.full(); });
+	--submitters_waiting_;
+}
+
+void AsyncSender::wakeSender_() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (sender_waiting_) {
+		std::lock_guard lock(wait_mutex_);
+		items_available_.notify_one();
+	}
+}
+
+void AsyncSender::wakeSubmitters_() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (submitters_waiting_ > 0) {
+		std::lock_guard lock(wait_mutex_);
+		space_available_.notify_all();
+	}
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,283 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/AttributesCodec.h"
+
+#include <limits>
+
+namespace uprotocol::transport {
+
+namespace {
+
+// Compact format layout (all integers little-endian):
+//
+//   u16  flags (see below)
+//   u8   type
+//   u8   priority
+//   u8   payload_format
+//   u8   reserved, always 0
+//   u64  id.msb          u64  id.lsb
+//   u64  reqid.msb       u64  reqid.lsb
+//   u32  ttl             u32  permission_level     u32  commstatus
+//   u32  source.ue_id    u32  source.ue_version_major
+//   u32  source.resource_id
+//   u32  sink.ue_id      u32  sink.ue_version_major
+//   u32  sink.resource_id
+//   --- end of fixed header ---
+//   u32 length + bytes, for each of: source.authority_name,
+//   sink.authority_name, token, traceparent
+//
+// Fields whose flag is clear are written as zero and ignored when decoding.
+enum Flags : uint16_t {
+	HAS_ID = 1U << 0U,
+	HAS_REQID = 1U << 1U,
+	HAS_SOURCE = 1U << 2U,
+	HAS_SINK = 1U << 3U,
+	HAS_TTL = 1U << 4U,
+	HAS_PERMISSION_LEVEL = 1U << 5U,
+	HAS_COMMSTATUS = 1U << 6U,
+	HAS_TOKEN = 1U << 7U,
+	HAS_TRACEPARENT = 1U << 8U,
+};
+
+constexpr size_t FIXED_HEADER_SIZE = 6 + (4 * 8) + (9 * 4);
+
+class Writer {
+public:
+	explicit Writer(size_t reserve) { out_.reserve(reserve); }
+
+	template <typename T>
+	void put(T value) {
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			out_.push_back(static_cast<char>(
+			    (static_cast<uint64_t>(value) >> (8 * i)) & 0xFFU));
+		}
+	}
+
+	void putString(const std::string& value) {
+		put(static_cast<uint32_t>(value.size()));
+		out_.append(value);
+	}
+
+	std::string take() { return std::move(out_); }
+
+private:
+	std::string out_;
+};
+
+class Reader {
+public:
+	explicit Reader(std::string_view in) : in_(in) {}
+
+	template <typename T>
+	bool get(T& value) {
+		if (in_.size() < sizeof(T)) {
+			return false;
+		}
+		uint64_t result = 0;
+		for (size_t i = 0; i < sizeof(T); ++i) {
+			result |= static_cast<uint64_t>(static_cast<uint8_t>(in_[i]))
+			          << (8 * i);
+		}
+		value = static_cast<T>(result);
+		in_.remove_prefix(sizeof(T));
+		return true;
+	}
+
+	/// Reads a length-prefixed string as a view into the input
+	bool getString(std::string_view& value) {
+		uint32_t size = 0;
+		if (!get(size) || (in_.size() < size)) {
+			return false;
+		}
+		value = in_.substr(0, size);
+		in_.remove_prefix(size);
+		return true;
+	}
+
+	[[nodiscard]] bool empty() const { return in_.empty(); }
+
+private:
+	std::string_view in_;
+};
+
+std::string encodeCompact(const v1::UAttributes& attributes) {
+	uint16_t flags = 0;
+	flags |= attributes.has_id() ? HAS_ID : 0;
+	flags |= attributes.has_reqid() ? HAS_REQID : 0;
+	flags |= attributes.has_source() ? HAS_SOURCE : 0;
+	flags |= attributes.has_sink() ? HAS_SINK : 0;
+	flags |= attributes.has_ttl() ? HAS_TTL : 0;
+	flags |= attributes.has_permission_level() ? HAS_PERMISSION_LEVEL : 0;
+	flags |= attributes.has_commstatus() ? HAS_COMMSTATUS : 0;
+	flags |= attributes.has_token() ? HAS_TOKEN : 0;
+	flags |= attributes.has_traceparent() ? HAS_TRACEPARENT : 0;
+
+	const auto& source = attributes.source();
+	const auto& sink = attributes.sink();
+
+	Writer writer(FIXED_HEADER_SIZE + (4 * sizeof(uint32_t)) +
+	              source.authority_name().size() +
+	              sink.authority_name().size() + attributes.token().size() +
+	              attributes.traceparent().size());
+
+	writer.put(flags);
+	writer.put(static_cast<uint8_t>(attributes.type()));
+	writer.put(static_cast<uint8_t>(attributes.priority()));
+	writer.put(static_cast<uint8_t>(attributes.payload_format()));
+	writer.put(uint8_t{0});
+	writer.put(attributes.id().msb());
+	writer.put(attributes.id().lsb());
+	writer.put(attributes.reqid().msb());
+	writer.put(attributes.reqid().lsb());
+	writer.put(attributes.ttl());
+	writer.put(attributes.permission_level());
+	writer.put(static_cast<uint32_t>(attributes.commstatus()));
+	writer.put(source.ue_id());
+	writer.put(source.ue_version_major());
+	writer.put(source.resource_id());
+	writer.put(sink.ue_id());
+	writer.put(sink.ue_version_major());
+	writer.put(sink.resource_id());
+
+	writer.putString(source.authority_name());
+	writer.putString(sink.authority_name());
+	writer.putString(attributes.token());
+	writer.putString(attributes.traceparent());
+
+	return writer.take();
+}
+
+bool decodeCompact(std::string_view data, v1::UAttributes& attributes) {
+	Reader reader(data);
+
+	uint16_t flags = 0;
+	uint8_t type = 0;
+	uint8_t priority = 0;
+	uint8_t payload_format = 0;
+	uint8_t reserved = 0;
+	uint64_t id_msb = 0;
+	uint64_t id_lsb = 0;
+	uint64_t reqid_msb = 0;
+	uint64_t reqid_lsb = 0;
+	uint32_t ttl = 0;
+	uint32_t permission_level = 0;
+	uint32_t commstatus = 0;
+	uint32_t source_ue_id = 0;
+	uint32_t source_version = 0;
+	uint32_t source_resource = 0;
+	uint32_t sink_ue_id = 0;
+	uint32_t sink_version = 0;
+	uint32_t sink_resource = 0;
+	std::string_view source_authority;
+	std::string_view sink_authority;
+	std::string_view token;
+	std::string_view traceparent;
+
+	const bool complete =
+	    reader.get(flags) && reader.get(type) && reader.get(priority) &&
+	    reader.get(payload_format) && reader.get(reserved) &&
+	    reader.get(id_msb) && reader.get(id_lsb) && reader.get(reqid_msb) &&
+	    reader.get(reqid_lsb) && reader.get(ttl) &&
+	    reader.get(permission_level) && reader.get(commstatus) &&
+	    reader.get(source_ue_id) && reader.get(source_version) &&
+	    reader.get(source_resource) && reader.get(sink_ue_id) &&
+	    reader.get(sink_version) && reader.get(sink_resource) &&
+	    reader.getString(source_authority) &&
+	    reader.getString(sink_authority) && reader.getString(token) &&
+	    reader.getString(traceparent) && reader.empty();
+	if (!complete || (reserved != 0)) {
+		return false;
+	}
+
+	attributes.set_type(static_cast<v1::UMessageType>(type));
+	attributes.set_priority(static_cast<v1::UPriority>(priority));
+	attributes.set_payload_format(
+	    static_cast<v1::UPayloadFormat>(payload_format));
+
+	if ((flags & HAS_ID) != 0) {
+		attributes.mutable_id()->set_msb(id_msb);
+		attributes.mutable_id()->set_lsb(id_lsb);
+	}
+	if ((flags & HAS_REQID) != 0) {
+		attributes.mutable_reqid()->set_msb(reqid_msb);
+		attributes.mutable_reqid()->set_lsb(reqid_lsb);
+	}
+	if ((flags & HAS_SOURCE) != 0) {
+		auto* source = attributes.mutable_source();
+		source->set_authority_name(source_authority.data(),
+		                           source_authority.size());
+		source->set_ue_id(source_ue_id);
+		source->set_ue_version_major(source_version);
+		source->set_resource_id(source_resource);
+	}
+	if ((flags & HAS_SINK) != 0) {
+		auto* sink = attributes.mutable_sink();
+		sink->set_authority_name(sink_authority.data(), sink_authority.size());
+		sink->set_ue_id(sink_ue_id);
+		sink->set_ue_version_major(sink_version);
+		sink->set_resource_id(sink_resource);
+	}
+	if ((flags & HAS_TTL) != 0) {
+		attributes.set_ttl(ttl);
+	}
+	if ((flags & HAS_PERMISSION_LEVEL) != 0) {
+		attributes.set_permission_level(permission_level);
+	}
+	if ((flags & HAS_COMMSTATUS) != 0) {
+		attributes.set_commstatus(static_cast<v1::UCode>(commstatus));
+	}
+	if ((flags & HAS_TOKEN) != 0) {
+		attributes.set_token(token.data(), token.size());
+	}
+	if ((flags & HAS_TRACEPARENT) != 0) {
+		attributes.set_traceparent(traceparent.data(), traceparent.size());
+	}
+	return true;
+}
+
+}  // namespace
+
+std::string AttributesCodec::encode(const v1::UAttributes& attributes,
+                                    Format format) {
+	if (format == Format::COMPACT) {
+		return encodeCompact(attributes);
+	}
+	std::string data;
+	attributes.SerializeToString(&data);
+	return data;
+}
+
+std::optional<v1::UAttributes> AttributesCodec::decode(uint8_t version,
+                                                       std::string_view data) {
+	v1::UAttributes attributes;
+	if (!decode(version, data, attributes)) {
+		return std::nullopt;
+	}
+	return attributes;
+}
+
+bool AttributesCodec::decode(uint8_t version, std::string_view data,
+                             v1::UAttributes& attributes) {
+	switch (static_cast<Format>(version)) {
+		case Format::PROTOBUF:
+			return (data.size() <=
+			        static_cast<size_t>(std::numeric_limits<int>::max())) &&
+			       attributes.ParseFromArray(data.data(),
+			                                 static_cast<int>(data.size()));
+		case Format::COMPACT:
+			return decodeCompact(data, attributes);
+		default:
+			return false;
+	}
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/Chunking.h"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace uprotocol::transport {
+
+namespace {
+
+template <typename T>
+void putLittleEndian(std::string& out, T value) {
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		out.push_back(static_cast<char>(
+		    (static_cast<uint64_t>(value) >> (8 * i)) & 0xFFU));
+	}
+}
+
+template <typename T>
+T getLittleEndian(std::string_view& in) {
+	uint64_t result = 0;
+	for (size_t i = 0; i < sizeof(T); ++i) {
+		result |= static_cast<uint64_t>(static_cast<uint8_t>(in[i]))
+		          << (8 * i);
+	}
+	in.remove_prefix(sizeof(T));
+	return static_cast<T>(result);
+}
+
+}  // namespace
+
+std::string ChunkHeader::encode() const {
+	std::string out;
+	out.reserve(ENCODED_SIZE);
+	putLittleEndian(out, index);
+	putLittleEndian(out, count);
+	putLittleEndian(out, offset);
+	putLittleEndian(out, total_size);
+	return out;
+}
+
+std::optional<ChunkHeader> ChunkHeader::decode(std::string_view data) {
+	if (data.size() != ENCODED_SIZE) {
+		return std::nullopt;
+	}
+	ChunkHeader header;
+	header.index = getLittleEndian<uint32_t>(data);
+	header.count = getLittleEndian<uint32_t>(data);
+	header.offset = getLittleEndian<uint64_t>(data);
+	header.total_size = getLittleEndian<uint64_t>(data);
+	if ((header.count == 0) || (header.index >= header.count) ||
+	    (header.offset > header.total_size)) {
+		return std::nullopt;
+	}
+	return header;
+}
+
+ChunkAssembler::ChunkAssembler(size_t max_size, size_t max_pending_size,
+                               size_t max_pending_messages)
+    : max_size_(max_size),
+      max_pending_size_(max_pending_size),
+      max_pending_messages_(max_pending_messages) {}
+
+std::optional<std::string> ChunkAssembler::add(const v1::UUID& id,
+                                               const ChunkHeader& header,
+                                               std::string_view data,
+                                               Clock::time_point expiry,
+                                               bool* dropped) {
+	if (dropped != nullptr) {
+		*dropped = false;
+	}
+	const auto drop = [dropped]() -> std::optional<std::string> {
+		if (dropped != nullptr) {
+			*dropped = true;
+		}
+		return std::nullopt;
+	};
+
+	const auto now = Clock::now();
+	std::lock_guard lock(mutex_);
+	for (const auto& expired : partials_.expire(now)) {
+		pending_size_ -= expired.total_size;
+	}
+
+	auto partial = partials_.take(id);
+	if (partial) {
+		pending_size_ -= partial->total_size;
+		if (partial->expiry <= now) {
+			// Expired within the last tick of the table
+			return std::nullopt;
+		}
+	} else {
+		if (header.index != 0) {
+			// Its first chunk was lost, or it has already expired
+			return std::nullopt;
+		}
+		if (header.total_size > max_size_) {
+			spdlog::warn("Dropping chunked message of {} bytes, above the "
+			             "limit of {}",
+			             header.total_size, max_size_);
+			return drop();
+		}
+		if ((partials_.size() >= max_pending_messages_) ||
+		    (header.total_size > max_pending_size_ - pending_size_)) {
+			spdlog::warn("Dropping chunked message of {} bytes, {} messages "
+			             "of {} bytes are already pending",
+			             header.total_size, partials_.size(), pending_size_);
+			return drop();
+		}
+		partial.emplace();
+		partial->total_size = header.total_size;
+		partial->expiry = expiry;
+	}
+
+	if ((header.index != partial->next_index) ||
+	    (header.total_size != partial->total_size) ||
+	    (header.offset != partial->payload.size()) ||
+	    (data.size() > header.total_size - header.offset)) {
+		spdlog::warn("Chunk {} of {} is out of sequence, dropping its "
+		             "message",
+		             header.index, header.count);
+		return drop();
+	}
+
+	// Grown as chunks arrive rather than to the announced size up front,
+	// and never past it
+	auto& payload = partial->payload;
+	const auto needed = payload.size() + data.size();
+	if (needed > payload.capacity()) {
+		payload.reserve(std::min<uint64_t>(
+		    std::max(needed, 2 * payload.capacity()), header.total_size));
+	}
+	payload.append(data);
+	++partial->next_index;
+
+	if (partial->next_index == header.count) {
+		if (payload.size() != header.total_size) {
+			spdlog::warn("Chunked message is {} bytes, expected {}",
+			             payload.size(), header.total_size);
+			return drop();
+		}
+		return std::move(payload);
+	}
+
+	park_(id, std::move(*partial));
+	return std::nullopt;
+}
+
+size_t ChunkAssembler::pending() const {
+	std::lock_guard lock(mutex_);
+	return partials_.size();
+}
+
+size_t ChunkAssembler::pendingSize() const {
+	std::lock_guard lock(mutex_);
+	return pending_size_;
+}
+
+void ChunkAssembler::park_(const v1::UUID& id, Partial&& partial) {
+	pending_size_ += partial.total_size;
+	const auto expiry = partial.expiry;
+	partials_.insert(id, std::move(partial), expiry);
+}
+
+}  // namespace uprotocol::transport
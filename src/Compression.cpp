@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/Compression.h"
+
+#include <spdlog/spdlog.h>
+
+#ifdef UP_TRANSPORT_ZENOH_LZ4
+#include <lz4.h>
+#endif
+#ifdef UP_TRANSPORT_ZENOH_ZSTD
+#include <zstd.h>
+#endif
+
+#include <limits>
+
+namespace uprotocol::transport {
+
+std::string Compression::Header::encode() const {
+	std::string out;
+	out.reserve(ENCODED_SIZE);
+	out.push_back(static_cast<char>(codec));
+	for (size_t i = 0; i < sizeof(size); ++i) {
+		out.push_back(static_cast<char>((size >> (8 * i)) & 0xFFU));
+	}
+	return out;
+}
+
+std::optional<Compression::Header> Compression::Header::decode(
+    std::string_view data) {
+	if (data.size() != ENCODED_SIZE) {
+		return std::nullopt;
+	}
+	Header header;
+	header.codec = static_cast<Codec>(data[0]);
+	for (size_t i = 0; i < sizeof(header.size); ++i) {
+		header.size |= static_cast<uint64_t>(static_cast<uint8_t>(data[1 + i]))
+		               << (8 * i);
+	}
+	return header;
+}
+
+bool Compression::isAvailable(Codec codec) {
+	switch (codec) {
+#ifdef UP_TRANSPORT_ZENOH_LZ4
+		case Codec::LZ4:
+			return true;
+#endif
+#ifdef UP_TRANSPORT_ZENOH_ZSTD
+		case Codec::ZSTD:
+			return true;
+#endif
+		default:
+			return false;
+	}
+}
+
+bool Compression::isValidLevel([[maybe_unused]] Codec codec,
+                               [[maybe_unused]] int level) {
+#ifdef UP_TRANSPORT_ZENOH_ZSTD
+	if (codec == Codec::ZSTD) {
+		return (level == 0) ||
+		       ((level >= ZSTD_minCLevel()) && (level <= ZSTD_maxCLevel()));
+	}
+#endif
+	return true;
+}
+
+std::optional<std::string> Compression::compress(Codec codec,
+                                                 std::string_view data,
+                                                 [[maybe_unused]] int level) {
+	std::string out;
+	switch (codec) {
+#ifdef UP_TRANSPORT_ZENOH_LZ4
+		case Codec::LZ4: {
+			if (data.size() >
+			    static_cast<size_t>(std::numeric_limits<int>::max())) {
+				return std::nullopt;
+			}
+			const auto size = static_cast<int>(data.size());
+			out.resize(static_cast<size_t>(LZ4_compressBound(size)));
+			const int written =
+			    LZ4_compress_default(data.data(), out.data(), size,
+			                         static_cast<int>(out.size()));
+			if (written <= 0) {
+				return std::nullopt;
+			}
+			out.resize(static_cast<size_t>(written));
+			break;
+		}
+#endif
+#ifdef UP_TRANSPORT_ZENOH_ZSTD
+		case Codec::ZSTD: {
+			out.resize(ZSTD_compressBound(data.size()));
+			const size_t written = ZSTD_compress(
+			    out.data(), out.size(), data.data(), data.size(),
+			    (level == 0) ? ZSTD_CLEVEL_DEFAULT : level);
+			if (ZSTD_isError(written) != 0) {
+				spdlog::debug("zstd compression failed: {}",
+				              ZSTD_getErrorName(written));
+				return std::nullopt;
+			}
+			out.resize(written);
+			break;
+		}
+#endif
+		default:
+			return std::nullopt;
+	}
+
+	if (out.size() >= data.size()) {
+		// Already compressed, or too small to gain anything
+		return std::nullopt;
+	}
+	return out;
+}
+
+bool Compression::decompress(Codec codec,
+                             [[maybe_unused]] std::string_view data,
+                             [[maybe_unused]] size_t size,
+                             [[maybe_unused]] std::string& out) {
+	switch (codec) {
+#ifdef UP_TRANSPORT_ZENOH_LZ4
+		case Codec::LZ4: {
+			constexpr auto MAX_SIZE =
+			    static_cast<size_t>(std::numeric_limits<int>::max());
+			if ((data.size() > MAX_SIZE) || (size > MAX_SIZE)) {
+				return false;
+			}
+			out.resize(size);
+			const int read = LZ4_decompress_safe(
+			    data.data(), out.data(), static_cast<int>(data.size()),
+			    static_cast<int>(size));
+			return (read >= 0) && (static_cast<size_t>(read) == size);
+		}
+#endif
+#ifdef UP_TRANSPORT_ZENOH_ZSTD
+		case Codec::ZSTD: {
+			out.resize(size);
+			const size_t read =
+			    ZSTD_decompress(out.data(), size, data.data(), data.size());
+			return (ZSTD_isError(read) == 0) && (read == size);
+		}
+#endif
+		default:
+			return false;
+	}
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/Dispatcher.h"
+
+#include <spdlog/spdlog.h>
+
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+namespace uprotocol::transport {
+
+Dispatcher::Dispatcher(size_t threads, const ThreadPlacement& placement) {
+	if (threads == 0) {
+		throw std::invalid_argument("Dispatcher needs at least one thread");
+	}
+	shards_.reserve(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		auto shard = std::make_unique<Shard>();
+		shard->worker = std::thread(run_, std::ref(*shard), placement);
+		shards_.push_back(std::move(shard));
+	}
+}
+
+Dispatcher::~Dispatcher() {
+	for (auto& shard : shards_) {
+		{
+			std::lock_guard lock(shard->mutex);
+			shard->stopping = true;
+		}
+		shard->cv.notify_one();
+	}
+	for (auto& shard : shards_) {
+		shard->worker.join();
+	}
+}
+
+size_t Dispatcher::shardFor(std::string_view key) const {
+	return std::hash<std::string_view>()(key) % shards_.size();
+}
+
+void Dispatcher::post(size_t shard, Task&& task) {
+	auto& target = *shards_[shard % shards_.size()];
+	target.pending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard lock(target.mutex);
+		target.tasks.push_back(std::move(task));
+	}
+	target.cv.notify_one();
+}
+
+size_t Dispatcher::queued() const {
+	size_t tasks = 0;
+	for (const auto& shard : shards_) {
+		tasks += shard->pending.load(std::memory_order_relaxed);
+	}
+	return tasks;
+}
+
+void Dispatcher::run_(Shard& shard, const ThreadPlacement& placement) {
+	if (!placement.empty()) {
+		placement.apply("dispatch");
+	}
+
+	std::deque<Task> batch;
+	for (;;) {
+		{
+			std::unique_lock lock(shard.mutex);
+			shard.cv.wait(lock, [&shard]() {
+				return shard.stopping || !shard.tasks.empty();
+			});
+			if (shard.tasks.empty()) {
+				return;
+			}
+			// Take everything queued at once, so posting only contends with
+			// this worker once per batch rather than once per task
+			batch.swap(shard.tasks);
+		}
+
+		for (auto& task : batch) {
+			try {
+				task();
+			} catch (const std::exception& e) {
+				spdlog::error("Listener callback threw: {}", e.what());
+			} catch (...) {
+				spdlog::error("Listener callback threw an unknown exception");
+			}
+			shard.pending.fetch_sub(1, std::memory_order_relaxed);
+		}
+		batch.clear();
+	}
+}
+
+}  // namespace uprotocol::transport
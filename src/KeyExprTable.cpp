@@ -0,0 +1,170 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/KeyExprTable.h"
+
+#include <up-transport-zenoh-cpp/UriFilter.h>
+
+#include <functional>
+#include <mutex>
+#include <sstream>
+
+namespace uprotocol::transport {
+
+namespace {
+
+// Writes the authority, entity ID, version and resource ID chunks of a UUri
+void appendUri(std::ostringstream& zenoh_key,
+               const std::string& default_authority_name,
+               const v1::UUri& uri) {
+	if (uri.authority_name().empty()) {
+		zenoh_key << default_authority_name;
+	} else {
+		zenoh_key << uri.authority_name();
+	}
+	zenoh_key << "/" << std::uppercase << std::hex;
+
+	if (uri.ue_id() == UriFilter::WILDCARD_ENTITY_ID) {
+		zenoh_key << "*";
+	} else {
+		zenoh_key << uri.ue_id();
+	}
+	zenoh_key << "/";
+
+	if (uri.ue_version_major() == UriFilter::WILDCARD_ENTITY_VERSION) {
+		zenoh_key << "*";
+	} else {
+		zenoh_key << uri.ue_version_major();
+	}
+	zenoh_key << "/";
+
+	if (uri.resource_id() == UriFilter::WILDCARD_RESOURCE_ID) {
+		zenoh_key << "*";
+	} else {
+		zenoh_key << uri.resource_id();
+	}
+}
+
+}  // namespace
+
+KeyExprTable::KeyExprTable(std::string default_authority_name,
+                           size_t capacity)
+    : default_authority_name_(std::move(default_authority_name)),
+      capacity_(capacity) {
+	table_.reserve(capacity);
+}
+
+std::shared_ptr<const InternedKeyExpr> KeyExprTable::get(
+    const v1::UUri& uri) {
+	{
+		std::shared_lock lock(table_mutex_);
+		if (auto entry = table_.find(uri); entry != table_.end()) {
+			return entry->second;
+		}
+	}
+
+	auto interned = validate(toZenohKeyString(default_authority_name_, uri));
+	if (!interned) {
+		return nullptr;
+	}
+
+	std::unique_lock lock(table_mutex_);
+	if ((table_.size() + route_count_) >= capacity_) {
+		return interned;
+	}
+	// Another thread may have interned the same UUri in the meantime
+	return table_.emplace(uri, std::move(interned)).first->second;
+}
+
+std::shared_ptr<const InternedKeyExpr> KeyExprTable::get(
+    const v1::UUri& sink, const v1::UUri& source) {
+	{
+		std::shared_lock lock(table_mutex_);
+		if (auto by_sink = routes_.find(sink); by_sink != routes_.end()) {
+			if (auto entry = by_sink->second.find(source);
+			    entry != by_sink->second.end()) {
+				return entry->second;
+			}
+		}
+	}
+
+	auto interned =
+	    validate(toZenohKeyString(default_authority_name_, sink, source));
+	if (!interned) {
+		return nullptr;
+	}
+
+	std::unique_lock lock(table_mutex_);
+	if ((table_.size() + route_count_) >= capacity_) {
+		return interned;
+	}
+	auto [entry, added] = routes_[sink].emplace(source, std::move(interned));
+	if (added) {
+		++route_count_;
+	}
+	return entry->second;
+}
+
+size_t KeyExprTable::size() const {
+	std::shared_lock lock(table_mutex_);
+	return table_.size() + route_count_;
+}
+
+std::string KeyExprTable::toZenohKeyString(
+    const std::string& default_authority_name, const v1::UUri& uri) {
+	std::ostringstream zenoh_key;
+
+	zenoh_key << "up/";
+	appendUri(zenoh_key, default_authority_name, uri);
+	return zenoh_key.str();
+}
+
+std::string KeyExprTable::toZenohKeyString(
+    const std::string& default_authority_name, const v1::UUri& sink,
+    const v1::UUri& source) {
+	std::ostringstream zenoh_key;
+	zenoh_key << "up/";
+	appendUri(zenoh_key, default_authority_name, sink);
+	zenoh_key << "/";
+	appendUri(zenoh_key, default_authority_name, source);
+	return zenoh_key.str();
+}
+
+std::shared_ptr<const InternedKeyExpr> KeyExprTable::validate(
+    std::string key) {
+	zenoh::KeyExpr expr(key.c_str());
+	if (!expr.check()) {
+		return nullptr;
+	}
+	return std::make_shared<const InternedKeyExpr>(
+	    InternedKeyExpr{std::move(key), std::move(expr)});
+}
+
+size_t KeyExprTable::UriHash::operator()(const v1::UUri& uri) const {
+	constexpr size_t MIX = 0x9E3779B97F4A7C15ULL;
+	size_t hash = std::hash<std::string>()(uri.authority_name());
+	for (uint64_t field : {uint64_t{uri.ue_id()},
+	                       uint64_t{uri.ue_version_major()},
+	                       uint64_t{uri.resource_id()}}) {
+		hash ^= field + MIX + (hash << 6U) + (hash >> 2U);
+	}
+	return hash;
+}
+
+bool KeyExprTable::UriEqual::operator()(const v1::UUri& lhs,
+                                        const v1::UUri& rhs) const {
+	return (lhs.ue_id() == rhs.ue_id()) &&
+	       (lhs.resource_id() == rhs.resource_id()) &&
+	       (lhs.ue_version_major() == rhs.ue_version_major()) &&
+	       (lhs.authority_name() == rhs.authority_name());
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/LatestCache.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace uprotocol::transport {
+
+namespace {
+
+bool sameId(const v1::UUID& lhs, const v1::UUID& rhs) {
+	return (lhs.msb() == rhs.msb()) && (lhs.lsb() == rhs.lsb());
+}
+
+}  // namespace
+
+LatestCache::LatestCache(size_t depth, size_t max_topics)
+    : depth_(depth), max_topics_(max_topics) {
+	if (depth == 0) {
+		throw std::invalid_argument("LatestCache needs a non-zero depth");
+	}
+}
+
+bool LatestCache::add(const std::string& key,
+                      std::shared_ptr<const v1::UMessage> message) {
+	bool created = false;
+	auto topic = topic_(key, created);
+	if (!topic) {
+		return false;
+	}
+
+	topic->messages.update([this, &message](Messages& messages) {
+		const auto& id = message->attributes().id();
+		if (std::any_of(messages.begin(), messages.end(),
+		                [&id](const auto& cached) {
+			                return sameId(cached->attributes().id(), id);
+		                })) {
+			return;
+		}
+		if (messages.size() >= depth_) {
+			messages.erase(messages.begin(),
+			               messages.end() - static_cast<ptrdiff_t>(depth_ - 1));
+		}
+		messages.push_back(std::move(message));
+	});
+	return created;
+}
+
+LatestCache::Messages LatestCache::get(const std::string& key) const {
+	auto topic = topics_.read(
+	    [&key](const Table& table) -> std::shared_ptr<Topic> {
+		    auto entry = table.find(key);
+		    return (entry == table.end()) ? nullptr : entry->second;
+	    });
+	if (!topic) {
+		return {};
+	}
+	return topic->messages.read(
+	    [](const Messages& messages) { return messages; });
+}
+
+size_t LatestCache::topics() const {
+	return topics_.read([](const Table& table) { return table.size(); });
+}
+
+std::shared_ptr<LatestCache::Topic> LatestCache::topic_(
+    const std::string& key, bool& created) {
+	bool full = false;
+	auto found = topics_.read(
+	    [this, &key, &full](const Table& table) -> std::shared_ptr<Topic> {
+		    auto entry = table.find(key);
+		    if (entry != table.end()) {
+			    return entry->second;
+		    }
+		    full = (table.size() >= max_topics_);
+		    return nullptr;
+	    });
+	if (found || full) {
+		return found;
+	}
+
+	topics_.update([this, &key, &found, &created](Table& table) {
+		// Another thread may have added the topic in the meantime
+		if (auto entry = table.find(key); entry != table.end()) {
+			found = entry->second;
+		} else if (table.size() < max_topics_) {
+			found = table.emplace(key, std::make_shared<Topic>())
+			            .first->second;
+			created = true;
+		}
+	});
+	return found;
+}
+
+}  // namespace uprotocol::transport
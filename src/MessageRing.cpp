@@ -0,0 +1,81 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/MessageRing.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace uprotocol::transport {
+
+MessageRing::MessageRing(size_t capacity) {
+	if (capacity == 0) {
+		throw std::invalid_argument("MessageRing needs a non-zero capacity");
+	}
+	slots_.resize(capacity);
+}
+
+bool MessageRing::push(const v1::UMessage& message) {
+	bool overwritten = false;
+	bool waiting = false;
+	{
+		std::lock_guard lock(mutex_);
+		waiting = (waiters_ > 0);
+		if (size_ == slots_.size()) {
+			head_ = (head_ + 1) % slots_.size();
+			--size_;
+			++dropped_;
+			overwritten = true;
+		}
+		slots_[(head_ + size_) % slots_.size()].CopyFrom(message);
+		++size_;
+	}
+	// Every message wakes a consumer, so that with several of them waiting
+	// one is woken for each message even if the ring was not empty
+	if (waiting) {
+		available_.notify_one();
+	}
+	return !overwritten;
+}
+
+size_t MessageRing::pop(v1::UMessage* messages, size_t count,
+                        std::chrono::milliseconds timeout) {
+	if (count == 0) {
+		return 0;
+	}
+	std::unique_lock lock(mutex_);
+	++waiters_;
+	const bool available =
+	    available_.wait_for(lock, timeout, [this] { return size_ > 0; });
+	--waiters_;
+	if (!available) {
+		return 0;
+	}
+	const auto popped = std::min(count, size_);
+	for (size_t i = 0; i < popped; ++i) {
+		messages[i].Swap(&slots_[head_]);
+		head_ = (head_ + 1) % slots_.size();
+	}
+	size_ -= popped;
+	return popped;
+}
+
+size_t MessageRing::size() const {
+	std::lock_guard lock(mutex_);
+	return size_;
+}
+
+uint64_t MessageRing::dropped() const {
+	std::lock_guard lock(mutex_);
+	return dropped_;
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,301 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/Metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <utility>
+
+namespace uprotocol::transport {
+
+namespace {
+
+constexpr std::chrono::nanoseconds FIRST_BUCKET_BOUND{256};
+
+// Escapes a Prometheus label value
+std::string labelValue(std::string_view value) {
+	std::string escaped;
+	escaped.reserve(value.size());
+	for (const auto character : value) {
+		if (character == '\n') {
+			escaped += "\\n";
+			continue;
+		}
+		if ((character == '\\') || (character == '"')) {
+			escaped += '\\';
+		}
+		escaped += character;
+	}
+	return escaped;
+}
+
+double seconds(std::chrono::nanoseconds duration) {
+	return std::chrono::duration<double>(duration).count();
+}
+
+void writeCounter(std::ostringstream& out, std::string_view name,
+                  std::string_view help,
+                  const std::vector<TopicMetricsSnapshot>& topics,
+                  uint64_t TopicMetricsSnapshot::*field) {
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " counter\n";
+	for (const auto& topic : topics) {
+		out << name << "{key=\"" << labelValue(topic.key) << "\"} "
+		    << topic.*field << "\n";
+	}
+}
+
+void writeHistogram(std::ostringstream& out, std::string_view name,
+                    std::string_view help,
+                    const std::vector<TopicMetricsSnapshot>& topics,
+                    LatencyHistogram TopicMetricsSnapshot::*field) {
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " histogram\n";
+	for (const auto& topic : topics) {
+		const auto& histogram = topic.*field;
+		const auto key = labelValue(topic.key);
+		uint64_t cumulative = 0;
+		for (size_t i = 0; i + 1 < LatencyHistogram::BUCKETS; ++i) {
+			cumulative += histogram.counts[i];
+			out << name << "_bucket{key=\"" << key << "\",le=\""
+			    << seconds(LatencyHistogram::upperBound(i)) << "\"} "
+			    << cumulative << "\n";
+		}
+		out << name << "_bucket{key=\"" << key << "\",le=\"+Inf\"} "
+		    << histogram.count() << "\n";
+		out << name << "_sum{key=\"" << key << "\"} "
+		    << seconds(histogram.sum) << "\n";
+		out << name << "_count{key=\"" << key << "\"} " << histogram.count()
+		    << "\n";
+	}
+}
+
+void writeGauge(std::ostringstream& out, std::string_view name,
+                std::string_view help, uint64_t value) {
+	out << "# HELP " << name << " " << help << "\n";
+	out << "# TYPE " << name << " gauge\n";
+	out << name << " " << value << "\n";
+}
+
+}  // namespace
+
+std::chrono::nanoseconds LatencyHistogram::upperBound(size_t bucket) {
+	return FIRST_BUCKET_BOUND * (uint64_t{1} << bucket);
+}
+
+size_t LatencyHistogram::bucketFor(std::chrono::nanoseconds duration) {
+	size_t bucket = 0;
+	auto bound = FIRST_BUCKET_BOUND;
+	while ((duration > bound) && (bucket + 1 < BUCKETS)) {
+		bound *= 2;
+		++bucket;
+	}
+	return bucket;
+}
+
+uint64_t LatencyHistogram::count() const {
+	uint64_t total = 0;
+	for (const auto bucket_count : counts) {
+		total += bucket_count;
+	}
+	return total;
+}
+
+std::chrono::nanoseconds LatencyHistogram::percentile(double fraction) const {
+	const auto total = count();
+	if (total == 0) {
+		return std::chrono::nanoseconds(0);
+	}
+	const auto rank = std::max<uint64_t>(
+	    1, static_cast<uint64_t>(
+	           std::ceil(fraction * static_cast<double>(total))));
+	uint64_t cumulative = 0;
+	for (size_t i = 0; i < BUCKETS; ++i) {
+		cumulative += counts[i];
+		if (cumulative >= rank) {
+			return upperBound(std::min(i, BUCKETS - 2));
+		}
+	}
+	return upperBound(BUCKETS - 2);
+}
+
+void TopicMetrics::add(Counter counter, uint64_t amount) {
+	shard_()
+	    .counters[static_cast<size_t>(counter)]
+	    .fetch_add(amount, std::memory_order_relaxed);
+}
+
+void TopicMetrics::record(Timer timer, std::chrono::nanoseconds duration) {
+	auto& shard = shard_();
+	const auto index = static_cast<size_t>(timer);
+	shard.buckets[index][LatencyHistogram::bucketFor(duration)].fetch_add(
+	    1, std::memory_order_relaxed);
+	shard.sums_ns[index].fetch_add(static_cast<uint64_t>(duration.count()),
+	                               std::memory_order_relaxed);
+}
+
+TopicMetricsSnapshot TopicMetrics::snapshot(std::string key) const {
+	std::array<uint64_t, static_cast<size_t>(Counter::COUNT)> counters{};
+	std::array<LatencyHistogram, static_cast<size_t>(Timer::COUNT)> timers{};
+	for (const auto& shard : shards_) {
+		for (size_t i = 0; i < counters.size(); ++i) {
+			counters[i] += shard.counters[i].load(std::memory_order_relaxed);
+		}
+		for (size_t i = 0; i < timers.size(); ++i) {
+			for (size_t bucket = 0; bucket < LatencyHistogram::BUCKETS;
+			     ++bucket) {
+				timers[i].counts[bucket] +=
+				    shard.buckets[i][bucket].load(std::memory_order_relaxed);
+			}
+			timers[i].sum += std::chrono::nanoseconds(
+			    shard.sums_ns[i].load(std::memory_order_relaxed));
+		}
+	}
+
+	const auto counter = [&counters](Counter which) {
+		return counters[static_cast<size_t>(which)];
+	};
+	const auto timer = [&timers](Timer which) {
+		return timers[static_cast<size_t>(which)];
+	};
+	TopicMetricsSnapshot snapshot;
+	snapshot.key = std::move(key);
+	snapshot.messages_sent = counter(Counter::MESSAGES_SENT);
+	snapshot.bytes_sent = counter(Counter::BYTES_SENT);
+	snapshot.send_failures = counter(Counter::SEND_FAILURES);
+	snapshot.messages_received = counter(Counter::MESSAGES_RECEIVED);
+	snapshot.bytes_received = counter(Counter::BYTES_RECEIVED);
+	snapshot.messages_delivered = counter(Counter::MESSAGES_DELIVERED);
+	snapshot.messages_dropped = counter(Counter::MESSAGES_DROPPED);
+	snapshot.messages_expired = counter(Counter::MESSAGES_EXPIRED);
+	snapshot.serialize_time = timer(Timer::SERIALIZE);
+	snapshot.send_time = timer(Timer::SEND);
+	snapshot.decode_time = timer(Timer::DECODE);
+	snapshot.callback_time = timer(Timer::CALLBACK);
+	return snapshot;
+}
+
+TopicMetrics::Shard& TopicMetrics::shard_() {
+	// Threads are spread over the shards in the order they first update
+	// any metrics, which keeps a few busy threads apart
+	static std::atomic<size_t> next_shard{0};
+	thread_local const size_t thread_shard =
+	    next_shard.fetch_add(1, std::memory_order_relaxed) % SHARDS;
+	return shards_[thread_shard];
+}
+
+std::string MetricsSnapshot::toPrometheus() const {
+	std::ostringstream out;
+	writeCounter(out, "up_transport_zenoh_messages_sent_total",
+	             "Messages sent.", topics,
+	             &TopicMetricsSnapshot::messages_sent);
+	writeCounter(out, "up_transport_zenoh_bytes_sent_total",
+	             "Payload bytes sent.", topics,
+	             &TopicMetricsSnapshot::bytes_sent);
+	writeCounter(out, "up_transport_zenoh_send_failures_total",
+	             "Messages that could not be sent.", topics,
+	             &TopicMetricsSnapshot::send_failures);
+	writeCounter(out, "up_transport_zenoh_messages_received_total",
+	             "Messages received.", topics,
+	             &TopicMetricsSnapshot::messages_received);
+	writeCounter(out, "up_transport_zenoh_bytes_received_total",
+	             "Payload bytes received.", topics,
+	             &TopicMetricsSnapshot::bytes_received);
+	writeCounter(out, "up_transport_zenoh_messages_delivered_total",
+	             "Listener callbacks run with a received message.", topics,
+	             &TopicMetricsSnapshot::messages_delivered);
+	writeCounter(out, "up_transport_zenoh_messages_dropped_total",
+	             "Received messages that could not be decoded.", topics,
+	             &TopicMetricsSnapshot::messages_dropped);
+	writeCounter(out, "up_transport_zenoh_messages_expired_total",
+	             "Messages dropped because their TTL had run out.", topics,
+	             &TopicMetricsSnapshot::messages_expired);
+	writeHistogram(out, "up_transport_zenoh_serialize_seconds",
+	               "Time spent encoding the attributes of sent messages.",
+	               topics, &TopicMetricsSnapshot::serialize_time);
+	writeHistogram(out, "up_transport_zenoh_send_seconds",
+	               "Time spent handing sent messages to Zenoh.", topics,
+	               &TopicMetricsSnapshot::send_time);
+	writeHistogram(out, "up_transport_zenoh_decode_seconds",
+	               "Time spent decoding received messages.", topics,
+	               &TopicMetricsSnapshot::decode_time);
+	writeHistogram(out, "up_transport_zenoh_callback_seconds",
+	               "Time spent in listener callbacks.", topics,
+	               &TopicMetricsSnapshot::callback_time);
+	writeGauge(out, "up_transport_zenoh_async_send_queued",
+	           "Messages waiting in the asynchronous send queue.",
+	           async_send_queued);
+	writeGauge(out, "up_transport_zenoh_async_send_dropped",
+	           "Messages discarded by the asynchronous send queue.",
+	           async_send_dropped);
+	writeGauge(out, "up_transport_zenoh_dispatch_queued",
+	           "Received messages waiting for a dispatch thread.",
+	           dispatch_queued);
+	return out.str();
+}
+
+MetricsRegistry::MetricsRegistry(size_t max_topics)
+    : max_topics_(max_topics), other_(std::make_shared<TopicMetrics>()) {}
+
+std::shared_ptr<TopicMetrics> MetricsRegistry::get(const std::string& key) {
+	bool full = false;
+	auto found = topics_.read([this, &key, &full](const Table& table)
+	                              -> std::shared_ptr<TopicMetrics> {
+		auto entry = table.find(key);
+		if (entry != table.end()) {
+			return entry->second;
+		}
+		full = (table.size() >= max_topics_);
+		return nullptr;
+	});
+	if (found) {
+		return found;
+	}
+	// Not worth copying the table for
+	if (full) {
+		return other_;
+	}
+
+	topics_.update([this, &key, &found](Table& table) {
+		// Another thread may have added the key in the meantime
+		if (auto entry = table.find(key); entry != table.end()) {
+			found = entry->second;
+		} else if (table.size() < max_topics_) {
+			found = table.emplace(key, std::make_shared<TopicMetrics>())
+			            .first->second;
+		} else {
+			found = other_;
+		}
+	});
+	return found;
+}
+
+std::vector<TopicMetricsSnapshot> MetricsRegistry::snapshot() const {
+	auto table = topics_.read([](const Table& current) { return current; });
+	std::vector<TopicMetricsSnapshot> topics;
+	topics.reserve(table.size() + 1);
+	for (const auto& [key, metrics] : table) {
+		topics.push_back(metrics->snapshot(key));
+	}
+	std::sort(topics.begin(), topics.end(),
+	          [](const auto& lhs, const auto& rhs) {
+		          return lhs.key < rhs.key;
+	          });
+	auto other = other_->snapshot(std::string(OTHER_KEY));
+	if ((other.messages_sent + other.messages_received) > 0) {
+		topics.push_back(std::move(other));
+	}
+	return topics;
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/ThreadPlacement.h"
+
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <spdlog/spdlog.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace uprotocol::transport {
+
+namespace {
+
+// Bits of the node masks handed to the memory policy system calls, which
+// glibc has no wrappers for
+constexpr size_t MAX_NUMA_NODES = 1024;
+constexpr size_t NODE_MASK_BITS = 8 * sizeof(unsigned long);
+using NodeMask = std::array<unsigned long, MAX_NUMA_NODES / NODE_MASK_BITS>;
+
+bool getMemoryPolicy(int& mode, NodeMask& nodes) {
+	return syscall(SYS_get_mempolicy, &mode, nodes.data(), MAX_NUMA_NODES,
+	               nullptr, 0) == 0;
+}
+
+bool setMemoryPolicy(int mode, const NodeMask& nodes) {
+	return syscall(SYS_set_mempolicy, mode, nodes.data(), MAX_NUMA_NODES) ==
+	       0;
+}
+
+// Restricts the calling thread to some CPUs
+bool setCpus(const std::vector<size_t>& cpus, std::string_view thread_name) {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (const auto cpu : cpus) {
+		if (cpu >= CPU_SETSIZE) {
+			spdlog::warn("Cannot pin the {} thread to CPU {}", thread_name,
+			             cpu);
+			return false;
+		}
+		CPU_SET(cpu, &set);
+	}
+	if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(set),
+	                                             &set)) {
+		spdlog::warn("Failed to pin the {} thread: {}", thread_name,
+		             std::strerror(error));
+		return false;
+	}
+	return true;
+}
+
+}  // namespace
+
+bool ThreadPlacement::empty() const {
+	return cpus.empty() && (fifo_priority == 0) && !numa_node;
+}
+
+bool ThreadPlacement::apply(std::string_view thread_name) const {
+	bool applied = true;
+	auto allowed = cpus;
+
+	if (numa_node) {
+		auto node_cpus = nodeCpus(*numa_node);
+		if (!node_cpus || (*numa_node >= MAX_NUMA_NODES)) {
+			spdlog::warn("NUMA node {} of the {} thread does not exist",
+			             *numa_node, thread_name);
+			applied = false;
+		} else {
+			if (allowed.empty()) {
+				allowed = std::move(*node_cpus);
+			} else {
+				std::vector<size_t> common;
+				std::sort(allowed.begin(), allowed.end());
+				std::set_intersection(allowed.begin(), allowed.end(),
+				                      node_cpus->begin(), node_cpus->end(),
+				                      std::back_inserter(common));
+				if (common.empty()) {
+					spdlog::warn("None of the CPUs of the {} thread are on "
+					             "NUMA node {}",
+					             thread_name, *numa_node);
+					applied = false;
+				} else {
+					allowed = std::move(common);
+				}
+			}
+
+			NodeMask nodes{};
+			const auto node = *numa_node;
+			nodes[node / NODE_MASK_BITS] |= 1UL << (node % NODE_MASK_BITS);
+			if (!setMemoryPolicy(MPOL_PREFERRED, nodes)) {
+				spdlog::warn("Failed to prefer the memory of NUMA node {} "
+				             "for the {} thread: {}",
+				             *numa_node, thread_name, std::strerror(errno));
+				applied = false;
+			}
+		}
+	}
+
+	if (!allowed.empty() && !setCpus(allowed, thread_name)) {
+		applied = false;
+	}
+
+	if (fifo_priority > 0) {
+		sched_param param{};
+		param.sched_priority = static_cast<int>(fifo_priority);
+		if (const int error =
+		        pthread_setschedparam(pthread_self(), SCHED_FIFO, &param)) {
+			spdlog::warn("Failed to run the {} thread with SCHED_FIFO "
+			             "priority {}: {}",
+			             thread_name, fifo_priority, std::strerror(error));
+			applied = false;
+		}
+	}
+	return applied;
+}
+
+std::optional<std::vector<size_t>> ThreadPlacement::nodeCpus(size_t node) {
+	std::ifstream file("/sys/devices/system/node/node" +
+	                   std::to_string(node) + "/cpulist");
+	std::string list;
+	if (!file || !std::getline(file, list)) {
+		return std::nullopt;
+	}
+	return parseCpuList(list);
+}
+
+std::optional<std::vector<size_t>> ThreadPlacement::parseCpuList(
+    std::string_view list) {
+	// A node without CPUs has an empty list
+	std::vector<size_t> cpus;
+	while (!list.empty()) {
+		const auto comma = list.find(',');
+		const auto range = list.substr(0, comma);
+		list = (comma == std::string_view::npos) ? std::string_view()
+		                                         : list.substr(comma + 1);
+
+		const auto* range_end = range.data() + range.size();
+		size_t first = 0;
+		auto parsed = std::from_chars(range.data(), range_end, first);
+		size_t last = first;
+		if ((parsed.ec == std::errc()) && (parsed.ptr != range_end) &&
+		    (*parsed.ptr == '-')) {
+			parsed = std::from_chars(parsed.ptr + 1, range_end, last);
+		}
+		if ((parsed.ec != std::errc()) || (parsed.ptr != range_end) ||
+		    (last < first)) {
+			return std::nullopt;
+		}
+		for (auto cpu = first; cpu <= last; ++cpu) {
+			cpus.push_back(cpu);
+		}
+	}
+	return cpus;
+}
+
+struct ScopedThreadPlacement::Saved {
+	cpu_set_t cpus;
+	bool cpus_saved{false};
+	int policy{SCHED_OTHER};
+	sched_param param{};
+	bool scheduling_saved{false};
+	int memory_mode{MPOL_DEFAULT};
+	NodeMask memory_nodes{};
+	bool memory_saved{false};
+};
+
+ScopedThreadPlacement::ScopedThreadPlacement(const ThreadPlacement& placement,
+                                             std::string_view thread_name)
+    : thread_name_(thread_name) {
+	if (placement.empty()) {
+		return;
+	}
+
+	saved_ = std::make_unique<Saved>();
+	const auto self = pthread_self();
+	saved_->cpus_saved = (pthread_getaffinity_np(self, sizeof(saved_->cpus),
+	                                             &saved_->cpus) == 0);
+	saved_->scheduling_saved =
+	    (pthread_getschedparam(self, &saved_->policy, &saved_->param) == 0);
+	if (placement.numa_node) {
+		saved_->memory_saved =
+		    getMemoryPolicy(saved_->memory_mode, saved_->memory_nodes);
+	}
+	placement.apply(thread_name);
+}
+
+ScopedThreadPlacement::~ScopedThreadPlacement() {
+	if (!saved_) {
+		return;
+	}
+
+	const auto self = pthread_self();
+	if (saved_->cpus_saved &&
+	    (pthread_setaffinity_np(self, sizeof(saved_->cpus), &saved_->cpus) !=
+	     0)) {
+		spdlog::warn("Failed to restore the CPUs of the {} thread",
+		             thread_name_);
+	}
+	if (saved_->scheduling_saved &&
+	    (pthread_setschedparam(self, saved_->policy, &saved_->param) != 0)) {
+		spdlog::warn("Failed to restore the scheduling of the {} thread",
+		             thread_name_);
+	}
+	if (saved_->memory_saved &&
+	    !setMemoryPolicy(saved_->memory_mode, saved_->memory_nodes)) {
+		spdlog::warn("Failed to restore the memory policy of the {} thread",
+		             thread_name_);
+	}
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/Tracing.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace uprotocol::transport::tracing {
+
+namespace detail {
+
+std::atomic<const HookState*> hook_state{nullptr};
+
+}  // namespace detail
+
+void setHook(Hook hook, void* context) {
+	if (hook == nullptr) {
+		detail::hook_state.store(nullptr, std::memory_order_release);
+		return;
+	}
+
+	// A stage may still be using a replaced state, so none are ever freed.
+	// Setting a hook again reuses its state, which keeps them few.
+	static std::mutex mutex;
+	static auto* const states = new std::vector<const detail::HookState*>();
+	std::lock_guard lock(mutex);
+	auto state = std::find_if(states->begin(), states->end(),
+	                          [hook, context](const auto* existing) {
+		                          return (existing->hook == hook) &&
+		                                 (existing->context == context);
+	                          });
+	if (state == states->end()) {
+		state = states->insert(states->end(),
+		                       new detail::HookState{hook, context});
+	}
+	detail::hook_state.store(*state, std::memory_order_release);
+}
+
+std::string_view toString(Stage stage) {
+	switch (stage) {
+		case Stage::KEY_EXPR:
+			return "key_expr";
+		case Stage::SERIALIZE:
+			return "serialize";
+		case Stage::PUT:
+			return "put";
+		case Stage::RECEIVE:
+			return "receive";
+		case Stage::DECODE:
+			return "decode";
+		case Stage::FILTER:
+			return "filter";
+		case Stage::DISPATCH:
+			return "dispatch";
+	}
+	return "unknown";
+}
+
+}  // namespace uprotocol::transport::tracing
@@ -0,0 +1,505 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/TransportConfig.h"
+
+#include <up-transport-zenoh-cpp/Compression.h>
+#include <up-transport-zenoh-cpp/UriFilter.h>
+
+#include <google/protobuf/struct.pb.h>
+#include <google/protobuf/util/json_util.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace uprotocol::transport {
+
+namespace {
+
+using google::protobuf::Struct;
+using google::protobuf::Value;
+
+// Largest integer a JSON number (double) can hold without losing precision
+constexpr double MAX_JSON_INTEGER = 9007199254740992.0;
+
+/// Read-only view of one JSON object in the transport configuration. Keeps
+/// track of where the object sits so errors can name the offending setting.
+class Section {
+public:
+	Section(const Struct& fields, std::string path)
+	    : fields_(fields), path_(std::move(path)) {}
+
+	/// Rejects any setting not listed in known
+	void allowOnly(std::initializer_list<std::string_view> known) const {
+		for (const auto& [key, value] : fields_.fields()) {
+			if (std::find(known.begin(), known.end(), key) == known.end()) {
+				fail(key, "is not a known setting");
+			}
+		}
+	}
+
+	void read(std::string_view key, bool& out) const {
+		if (const auto* value = find(key)) {
+			if (value->kind_case() != Value::kBoolValue) {
+				fail(key, "must be a boolean");
+			}
+			out = value->bool_value();
+		}
+	}
+
+	void read(std::string_view key, size_t& out) const {
+		if (const auto* value = find(key)) {
+			const double number = value->number_value();
+			if ((value->kind_case() != Value::kNumberValue) || (number < 0) ||
+			    (number > MAX_JSON_INTEGER) ||
+			    (std::floor(number) != number)) {
+				fail(key, "must be a non-negative integer");
+			}
+			out = static_cast<size_t>(number);
+		}
+	}
+
+	void read(std::string_view key, int& out) const {
+		if (const auto* value = find(key)) {
+			const double number = value->number_value();
+			if ((value->kind_case() != Value::kNumberValue) ||
+			    (number < std::numeric_limits<int>::min()) ||
+			    (number > std::numeric_limits<int>::max()) ||
+			    (std::floor(number) != number)) {
+				fail(key, "must be an integer");
+			}
+			out = static_cast<int>(number);
+		}
+	}
+
+	/// Reads a string setting that names one of the given choices
+	template <typename T>
+	void read(std::string_view key, T& out,
+	          std::initializer_list<std::pair<std::string_view, T>> choices)
+	    const {
+		if (const auto* value = find(key)) {
+			if (value->kind_case() == Value::kStringValue) {
+				for (const auto& [name, choice] : choices) {
+					if (value->string_value() == name) {
+						out = choice;
+						return;
+					}
+				}
+			}
+			std::string names;
+			for (const auto& [name, choice] : choices) {
+				names += (names.empty() ? "\"" : ", \"") + std::string(name) +
+				         "\"";
+			}
+			fail(key, "must be one of " + names);
+		}
+	}
+
+	/// Reads an array of non-negative integers
+	void read(std::string_view key, std::vector<size_t>& out) const {
+		if (const auto* value = find(key)) {
+			if (value->kind_case() != Value::kListValue) {
+				fail(key, "must be an array");
+			}
+			std::vector<size_t> numbers;
+			for (const auto& item : value->list_value().values()) {
+				const double number = item.number_value();
+				if ((item.kind_case() != Value::kNumberValue) ||
+				    (number < 0) || (number > MAX_JSON_INTEGER) ||
+				    (std::floor(number) != number)) {
+					fail(key, "must be an array of non-negative integers");
+				}
+				numbers.push_back(static_cast<size_t>(number));
+			}
+			out = std::move(numbers);
+		}
+	}
+
+	void read(std::string_view key, std::optional<size_t>& out) const {
+		if (find(key) != nullptr) {
+			size_t number = 0;
+			read(key, number);
+			out = number;
+		}
+	}
+
+	/// Reads a UUri pattern, see UriFilter::parse()
+	void read(std::string_view key, v1::UUri& out) const {
+		if (const auto* value = find(key)) {
+			std::optional<v1::UUri> uri;
+			if (value->kind_case() == Value::kStringValue) {
+				uri = UriFilter::parse(value->string_value());
+			}
+			if (!uri) {
+				fail(key, "must be a UUri such as \"//authority/10AB/1/8001\"");
+			}
+			out = std::move(*uri);
+		}
+	}
+
+	/// Rejects the section if any of the given settings is missing
+	void require(std::initializer_list<std::string_view> keys) const {
+		for (const auto& key : keys) {
+			if (find(key) == nullptr) {
+				fail(key, "is required");
+			}
+		}
+	}
+
+	/// Gets every object in an array of objects
+	[[nodiscard]] std::vector<Section> children(std::string_view key) const {
+		std::vector<Section> sections;
+		const auto* value = find(key);
+		if (value == nullptr) {
+			return sections;
+		}
+		if (value->kind_case() != Value::kListValue) {
+			fail(key, "must be an array");
+		}
+		const auto& values = value->list_value().values();
+		for (int i = 0; i < values.size(); ++i) {
+			const auto index = std::string(key) + "/" + std::to_string(i);
+			if (values[i].kind_case() != Value::kStructValue) {
+				fail(index, "must be an object");
+			}
+			sections.emplace_back(values[i].struct_value(), qualify(index));
+		}
+		return sections;
+	}
+
+	[[nodiscard]] std::optional<Section> child(std::string_view key) const {
+		const auto* value = find(key);
+		if (value == nullptr) {
+			return std::nullopt;
+		}
+		if (value->kind_case() != Value::kStructValue) {
+			fail(key, "must be an object");
+		}
+		return Section(value->struct_value(), qualify(key));
+	}
+
+private:
+	[[nodiscard]] const Value* find(std::string_view key) const {
+		auto entry = fields_.fields().find(std::string(key));
+		if (entry == fields_.fields().end()) {
+			return nullptr;
+		}
+		return &entry->second;
+	}
+
+	[[nodiscard]] std::string qualify(std::string_view key) const {
+		return path_ + "/" + std::string(key);
+	}
+
+	[[noreturn]] void fail(std::string_view key, std::string_view why) const {
+		throw std::invalid_argument("Transport setting '" + qualify(key) +
+		                            "' " + std::string(why));
+	}
+
+	const Struct& fields_;
+	std::string path_;
+};
+
+void readSharedMemory(const Section& section,
+                      TransportConfig::SharedMemory& shm) {
+	section.allowOnly({"enabled", "segment_size", "threshold"});
+	section.read("enabled", shm.enabled);
+	section.read("segment_size", shm.segment_size);
+	section.read("threshold", shm.threshold);
+
+	if (shm.enabled && (shm.segment_size == 0)) {
+		throw std::invalid_argument(
+		    "Transport setting 'shared_memory/segment_size' must be non-zero "
+		    "when shared memory is enabled");
+	}
+}
+
+void readPublisherCache(const Section& section,
+                        TransportConfig::PublisherCache& cache) {
+	section.allowOnly({"capacity"});
+	section.read("capacity", cache.capacity);
+}
+
+void readKeyExprTable(const Section& section,
+                      TransportConfig::KeyExprTable& table) {
+	section.allowOnly({"capacity"});
+	section.read("capacity", table.capacity);
+}
+
+void readAsyncSend(const Section& section, TransportConfig::AsyncSend& async) {
+	using Overflow = TransportConfig::AsyncSend::Overflow;
+
+	section.allowOnly({"enabled", "overflow", "queue_capacity"});
+	section.read("enabled", async.enabled);
+	section.read("queue_capacity", async.queue_capacity);
+	section.read("overflow", async.overflow,
+	             {{"block", Overflow::BLOCK},
+	              {"drop_oldest", Overflow::DROP_OLDEST},
+	              {"fail_fast", Overflow::FAIL_FAST}});
+
+	if (async.enabled && (async.queue_capacity == 0)) {
+		throw std::invalid_argument(
+		    "Transport setting 'async_send/queue_capacity' must be non-zero "
+		    "when asynchronous sending is enabled");
+	}
+}
+
+void readDispatch(const Section& section, TransportConfig::Dispatch& dispatch) {
+	section.allowOnly({"threads"});
+	section.read("threads", dispatch.threads);
+}
+
+void readRpc(const Section& section, TransportConfig::Rpc& rpc) {
+	section.allowOnly({"queries"});
+	section.read("queries", rpc.queries);
+}
+
+void readQos(const Section& section, TransportConfig::Qos& qos) {
+	using Priority = TransportConfig::Qos::Priority;
+	using CongestionControl = TransportConfig::Qos::CongestionControl;
+	static constexpr std::array<std::string_view,
+	                            TransportConfig::Qos::CLASSES>
+	    CLASS_NAMES = {"cs0", "cs1", "cs2", "cs3", "cs4", "cs5", "cs6"};
+
+	section.allowOnly({"cs0", "cs1", "cs2", "cs3", "cs4", "cs5", "cs6"});
+	for (size_t i = 0; i < CLASS_NAMES.size(); ++i) {
+		auto lane_section = section.child(CLASS_NAMES[i]);
+		if (!lane_section) {
+			continue;
+		}
+		auto& lane = qos.lanes[i];
+		lane_section->allowOnly({"congestion_control", "priority"});
+		lane_section->read("priority", lane.priority,
+		                   {{"real_time", Priority::REAL_TIME},
+		                    {"interactive_high", Priority::INTERACTIVE_HIGH},
+		                    {"interactive_low", Priority::INTERACTIVE_LOW},
+		                    {"data_high", Priority::DATA_HIGH},
+		                    {"data", Priority::DATA},
+		                    {"data_low", Priority::DATA_LOW},
+		                    {"background", Priority::BACKGROUND}});
+		lane_section->read("congestion_control", lane.congestion_control,
+		                   {{"block", CongestionControl::BLOCK},
+		                    {"drop", CongestionControl::DROP}});
+	}
+}
+
+void readReceiveArenas(const Section& section,
+                       TransportConfig::ReceiveArenas& arenas) {
+	section.allowOnly({"block_size", "count"});
+	section.read("count", arenas.count);
+	section.read("block_size", arenas.block_size);
+}
+
+void readChunking(const Section& section, TransportConfig::Chunking& chunking) {
+	section.allowOnly({"chunk_size", "max_message_size",
+	                   "max_pending_messages", "max_pending_size"});
+	section.read("chunk_size", chunking.chunk_size);
+	section.read("max_message_size", chunking.max_message_size);
+	section.read("max_pending_messages", chunking.max_pending_messages);
+	section.read("max_pending_size", chunking.max_pending_size);
+}
+
+void readCompression(const Section& section,
+                     TransportConfig::Compression& compression) {
+	using Codec = Compression::Codec;
+
+	section.allowOnly({"max_decompressed_size", "rules"});
+	section.read("max_decompressed_size", compression.max_decompressed_size);
+	for (const auto& rule_section : section.children("rules")) {
+		auto& rule = compression.rules.emplace_back();
+		rule_section.allowOnly({"codec", "level", "pattern", "threshold"});
+		rule_section.require({"codec", "pattern"});
+		rule_section.read("pattern", rule.pattern);
+		rule_section.read("codec", rule.codec,
+		                  {{"none", Codec::NONE},
+		                   {"lz4", Codec::LZ4},
+		                   {"zstd", Codec::ZSTD}});
+		rule_section.read("level", rule.level);
+		if (!Compression::isValidLevel(rule.codec, rule.level)) {
+			throw std::invalid_argument(
+			    "Transport setting 'compression/rules/*/level' is out of "
+			    "the range of zstd levels");
+		}
+		rule_section.read("threshold", rule.threshold);
+	}
+}
+
+void readReliability(const Section& section,
+                     TransportConfig::Reliability& reliability) {
+	using Mode = TransportConfig::Reliability::Mode;
+
+	section.allowOnly({"rules"});
+	for (const auto& rule_section : section.children("rules")) {
+		auto& rule = reliability.rules.emplace_back();
+		rule_section.allowOnly({"mode", "pattern"});
+		rule_section.require({"mode", "pattern"});
+		rule_section.read("pattern", rule.pattern);
+		rule_section.read("mode", rule.mode,
+		                  {{"best_effort", Mode::BEST_EFFORT},
+		                   {"reliable", Mode::RELIABLE}});
+	}
+}
+
+void readSession(const Section& section, TransportConfig::Session& session) {
+	section.allowOnly({"lazy", "shared"});
+	section.read("lazy", session.lazy);
+	section.read("shared", session.shared);
+}
+
+void readThreadPlacement(const Section& section, ThreadPlacement& placement) {
+	section.allowOnly({"cpus", "fifo_priority", "numa_node"});
+	section.read("cpus", placement.cpus);
+	section.read("fifo_priority", placement.fifo_priority);
+	section.read("numa_node", placement.numa_node);
+
+	if (placement.fifo_priority > ThreadPlacement::MAX_FIFO_PRIORITY) {
+		throw std::invalid_argument(
+		    "Transport setting 'threads/*/fifo_priority' must be at most " +
+		    std::to_string(ThreadPlacement::MAX_FIFO_PRIORITY));
+	}
+}
+
+void readThreads(const Section& section, TransportConfig::Threads& threads) {
+	section.allowOnly({"async_send", "dispatch", "zenoh"});
+	if (auto dispatch = section.child("dispatch")) {
+		readThreadPlacement(*dispatch, threads.dispatch);
+	}
+	if (auto async = section.child("async_send")) {
+		readThreadPlacement(*async, threads.async_send);
+	}
+	if (auto zenoh = section.child("zenoh")) {
+		readThreadPlacement(*zenoh, threads.zenoh);
+	}
+}
+
+void readLoopback(const Section& section,
+                  TransportConfig::Loopback& loopback) {
+	section.allowOnly({"enabled"});
+	section.read("enabled", loopback.enabled);
+}
+
+void readLatestCache(const Section& section,
+                     TransportConfig::LatestCache& cache) {
+	section.allowOnly({"depth", "max_topics", "query"});
+	section.read("depth", cache.depth);
+	section.read("max_topics", cache.max_topics);
+	section.read("query", cache.query);
+
+	if (cache.query && (cache.depth == 0)) {
+		throw std::invalid_argument(
+		    "Transport setting 'latest_cache/depth' must be non-zero when "
+		    "latest values are queried");
+	}
+}
+
+void readMatching(const Section& section,
+                  TransportConfig::Matching& matching) {
+	section.allowOnly({"skip_unmatched"});
+	section.read("skip_unmatched", matching.skip_unmatched);
+}
+
+void readMetrics(const Section& section, TransportConfig::Metrics& metrics) {
+	section.allowOnly({"enabled", "max_topics"});
+	section.read("enabled", metrics.enabled);
+	section.read("max_topics", metrics.max_topics);
+}
+
+}  // namespace
+
+TransportConfig TransportConfig::fromJson(std::string_view json) {
+	Struct root;
+	auto status = google::protobuf::util::JsonStringToMessage(
+	    std::string(json), &root);
+	if (!status.ok()) {
+		throw std::invalid_argument(
+		    "Transport configuration is not valid JSON: " +
+		    std::string(status.message()));
+	}
+
+	const Section section(root, std::string(ZENOH_CONFIG_KEY));
+	section.allowOnly({"async_send", "attributes_encoding", "chunking",
+	                   "compression", "dispatch", "key_expr_table",
+	                   "key_format", "latest_cache", "loopback", "matching",
+	                   "metrics", "publisher_cache", "qos", "receive_arenas",
+	                   "reliability", "rpc", "session", "shared_memory",
+	                   "threads"});
+
+	TransportConfig config;
+	section.read("attributes_encoding", config.attributes_encoding,
+	             {{"protobuf", AttributesCodec::Format::PROTOBUF},
+	              {"compact", AttributesCodec::Format::COMPACT}});
+	section.read(
+	    "key_format", config.key_format,
+	    {{"destination", KeyFormat::DESTINATION},
+	     {"destination_and_source", KeyFormat::DESTINATION_AND_SOURCE}});
+	if (auto shm = section.child("shared_memory")) {
+		readSharedMemory(*shm, config.shared_memory);
+	}
+	if (auto cache = section.child("publisher_cache")) {
+		readPublisherCache(*cache, config.publisher_cache);
+	}
+	if (auto table = section.child("key_expr_table")) {
+		readKeyExprTable(*table, config.key_expr_table);
+	}
+	if (auto async = section.child("async_send")) {
+		readAsyncSend(*async, config.async_send);
+	}
+	if (auto dispatch = section.child("dispatch")) {
+		readDispatch(*dispatch, config.dispatch);
+	}
+	if (auto rpc = section.child("rpc")) {
+		readRpc(*rpc, config.rpc);
+	}
+	if (auto qos = section.child("qos")) {
+		readQos(*qos, config.qos);
+	}
+	if (auto reliability = section.child("reliability")) {
+		readReliability(*reliability, config.reliability);
+	}
+	if (auto arenas = section.child("receive_arenas")) {
+		readReceiveArenas(*arenas, config.receive_arenas);
+	}
+	if (auto chunking = section.child("chunking")) {
+		readChunking(*chunking, config.chunking);
+	}
+	if (auto compression = section.child("compression")) {
+		readCompression(*compression, config.compression);
+	}
+	if (auto session = section.child("session")) {
+		readSession(*session, config.session);
+	}
+	if (auto threads = section.child("threads")) {
+		readThreads(*threads, config.threads);
+	}
+	if (auto metrics = section.child("metrics")) {
+		readMetrics(*metrics, config.metrics);
+	}
+	if (auto loopback = section.child("loopback")) {
+		readLoopback(*loopback, config.loopback);
+	}
+	if (auto cache = section.child("latest_cache")) {
+		readLatestCache(*cache, config.latest_cache);
+	}
+	if (auto matching = section.child("matching")) {
+		readMatching(*matching, config.matching);
+	}
+	return config;
+}
+
+}  // namespace uprotocol::transport
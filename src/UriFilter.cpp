@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "up-transport-zenoh-cpp/UriFilter.h"
+
+#include <array>
+#include <charconv>
+
+namespace uprotocol::transport {
+
+UriFilter::UriFilter(const std::string& default_authority_name,
+                     const v1::UUri& filter)
+    : default_authority_name_(default_authority_name) {
+	const auto& authority = filter.authority_name().empty()
+	                            ? default_authority_name
+	                            : filter.authority_name();
+	if (authority != WILDCARD_AUTHORITY) {
+		authority_name_ = authority;
+	}
+	if (filter.ue_id() != WILDCARD_ENTITY_ID) {
+		ue_id_ = filter.ue_id();
+	}
+	if (filter.ue_version_major() != WILDCARD_ENTITY_VERSION) {
+		ue_version_major_ = filter.ue_version_major();
+	}
+	if (filter.resource_id() != WILDCARD_RESOURCE_ID) {
+		resource_id_ = filter.resource_id();
+	}
+}
+
+bool UriFilter::matches(const v1::UUri& uri) const {
+	// Integer fields first: they are cheaper and more likely to differ
+	if ((ue_id_ && (*ue_id_ != uri.ue_id())) ||
+	    (resource_id_ && (*resource_id_ != uri.resource_id())) ||
+	    (ue_version_major_ && (*ue_version_major_ != uri.ue_version_major()))) {
+		return false;
+	}
+	if (!authority_name_) {
+		return true;
+	}
+	const auto& authority = uri.authority_name().empty()
+	                            ? default_authority_name_
+	                            : uri.authority_name();
+	return authority == *authority_name_;
+}
+
+std::optional<v1::UUri> UriFilter::parse(std::string_view text) {
+	constexpr std::string_view SCHEME = "up:";
+	if (text.substr(0, SCHEME.size()) == SCHEME) {
+		text.remove_prefix(SCHEME.size());
+	}
+
+	v1::UUri uri;
+	if (text.substr(0, 2) == "//") {
+		text.remove_prefix(2);
+		const auto end = text.find('/');
+		if ((end == 0) || (end == std::string_view::npos)) {
+			return std::nullopt;
+		}
+		uri.set_authority_name(std::string(text.substr(0, end)));
+		text.remove_prefix(end);
+	}
+	if (text.empty() || (text.front() != '/')) {
+		return std::nullopt;
+	}
+	text.remove_prefix(1);
+
+	// Entity ID, major version and resource ID, with their wildcards
+	constexpr std::array<uint32_t, 3> WILDCARDS = {
+	    WILDCARD_ENTITY_ID, WILDCARD_ENTITY_VERSION, WILDCARD_RESOURCE_ID};
+	constexpr std::array<uint32_t, 3> MAXIMUMS = {0xFFFFFFFF, 0xFF, 0xFFFF};
+	std::array<uint32_t, 3> fields{};
+	for (size_t i = 0; i < fields.size(); ++i) {
+		const auto end = text.find('/');
+		if ((end == std::string_view::npos) != (i == fields.size() - 1)) {
+			return std::nullopt;
+		}
+		const auto field = text.substr(0, end);
+		if (field == "*") {
+			fields[i] = WILDCARDS[i];
+		} else {
+			const auto* last = field.data() + field.size();
+			auto [parsed, error] =
+			    std::from_chars(field.data(), last, fields[i], 16);
+			if (field.empty() || (error != std::errc()) ||
+			    (parsed != last) || (fields[i] > MAXIMUMS[i])) {
+				return std::nullopt;
+			}
+		}
+		text.remove_prefix((end == std::string_view::npos) ? text.size()
+		                                                   : end + 1);
+	}
+
+	uri.set_ue_id(fields[0]);
+	uri.set_ue_version_major(fields[1]);
+	uri.set_resource_id(fields[2]);
+	return uri;
+}
+
+}  // namespace uprotocol::transport
@@ -10,3 +10,2552 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "up-transport-zenoh-cpp/ZenohUTransport.h"
+
+#include <up-transport-zenoh-cpp/SharedRegistry.h>
+#include <up-transport-zenoh-cpp/ThreadPlacement.h>
+#include <up-transport-zenoh-cpp/Tracing.h>
+
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+namespace uprotocol::transport {
+
+namespace {
+
+// Resource IDs 1 to 0x7FFF identify RPC methods
+constexpr uint32_t MAX_RPC_METHOD_ID = 0x7FFF;
+
+// Parameters of the queries for the last messages published on a topic,
+// which tell them apart from RPC requests
+constexpr char LATEST_QUERY_PARAMETERS[] = "up_latest";
+
+// Whether a subscription can select the sources of its listener by its key.
+// Only messages with a sink carry their source in the key, and a sink filter
+// on a method or on resource 0 never matches a published topic.
+bool sourceInKey(TransportConfig::KeyFormat format,
+                 const v1::UUri& sink_filter, const v1::UUri* source_filter) {
+	return (format == TransportConfig::KeyFormat::DESTINATION_AND_SOURCE) &&
+	       (source_filter != nullptr) &&
+	       (sink_filter.resource_id() <= MAX_RPC_METHOD_ID);
+}
+
+// Number of wildcard fields in a UUri filter
+size_t wildcardCount(const v1::UUri& filter) {
+	return static_cast<size_t>(filter.authority_name() ==
+	                           UriFilter::WILDCARD_AUTHORITY) +
+	       static_cast<size_t>(filter.ue_id() ==
+	                           UriFilter::WILDCARD_ENTITY_ID) +
+	       static_cast<size_t>(filter.ue_version_major() ==
+	                           UriFilter::WILDCARD_ENTITY_VERSION) +
+	       static_cast<size_t>(filter.resource_id() ==
+	                           UriFilter::WILDCARD_RESOURCE_ID);
+}
+
+// How long a request is waited on, both by its sender and by whoever
+// received it as a query, when the request does not carry a TTL
+constexpr std::chrono::seconds DEFAULT_REQUEST_LIFETIME{60};
+
+// Keys of the optional attachment entries following the UAttributes
+constexpr std::string_view CHUNK_ENTRY = "chunk";
+constexpr std::string_view COMPRESSION_ENTRY = "compression";
+
+// Loopback bus whose transports were already handed the message being put
+// on this thread. Zenoh calls the subscribers of the session itself from
+// within put(), so their copies of it are recognized and dropped.
+thread_local const void* looped_back_bus = nullptr;
+
+// Marks the messages put on this thread as handed over, while it lives
+class LoopedBack {
+public:
+	explicit LoopedBack(const void* bus) : previous_(looped_back_bus) {
+		looped_back_bus = bus;
+	}
+	~LoopedBack() { looped_back_bus = previous_; }
+
+	LoopedBack(const LoopedBack&) = delete;
+	LoopedBack& operator=(const LoopedBack&) = delete;
+
+private:
+	const void* previous_;
+};
+
+// Counts a received message that was dropped, e.g. for not decoding
+void countDrop(TopicMetrics* metrics) {
+	if (metrics != nullptr) {
+		metrics->add(TopicMetrics::Counter::MESSAGES_DROPPED);
+	}
+}
+
+// Counts a message dropped because its TTL had run out
+void countExpired(TopicMetrics* metrics) {
+	if (metrics != nullptr) {
+		metrics->add(TopicMetrics::Counter::MESSAGES_EXPIRED);
+	}
+}
+
+// A uProtocol UUID (version 8), like a standard version 7 one, holds the
+// milliseconds since the Unix epoch it was created at in the top 48 bits of
+// its msb, followed by its version
+constexpr unsigned UUID_TIMESTAMP_SHIFT = 16;
+constexpr unsigned UUID_VERSION_SHIFT = 12;
+constexpr uint64_t UUID_VERSION_MASK = 0xF;
+constexpr uint64_t UUID_VERSION_7 = 7;
+constexpr uint64_t UUID_VERSION_8 = 8;
+
+// Time a message was created at, from its ID, or std::nullopt if its ID
+// holds no time
+std::optional<std::chrono::system_clock::time_point> createdAt(
+    const v1::UUID& id) {
+	const auto msb = id.msb();
+	const auto version = (msb >> UUID_VERSION_SHIFT) & UUID_VERSION_MASK;
+	if ((version != UUID_VERSION_7) && (version != UUID_VERSION_8)) {
+		return std::nullopt;
+	}
+	return std::chrono::system_clock::time_point(std::chrono::milliseconds(
+	    static_cast<int64_t>(msb >> UUID_TIMESTAMP_SHIFT)));
+}
+
+// Whether the TTL of a message has run out, counted from the time in its
+// ID. Messages without a TTL, or whose ID holds no time, never expire.
+bool isExpired(const v1::UAttributes& attributes) {
+	if (attributes.ttl() == 0) {
+		return false;
+	}
+	const auto created = createdAt(attributes.id());
+	return created && (std::chrono::system_clock::now() >
+	                   *created + std::chrono::milliseconds(attributes.ttl()));
+}
+
+// Whether two UUris name the same topic
+bool sameTopic(const v1::UUri& lhs, const v1::UUri& rhs) {
+	return (lhs.resource_id() == rhs.resource_id()) &&
+	       (lhs.ue_id() == rhs.ue_id()) &&
+	       (lhs.ue_version_major() == rhs.ue_version_major()) &&
+	       (lhs.authority_name() == rhs.authority_name());
+}
+
+// Runs a listener callback, timing it when there are metrics to record to
+template <typename Callback>
+void runCallback(TopicMetrics* metrics, Callback&& callback) {
+	UP_TRANSPORT_ZENOH_TRACE(DISPATCH);
+	if (metrics == nullptr) {
+		callback();
+		return;
+	}
+	const auto start = std::chrono::steady_clock::now();
+	callback();
+	metrics->record(TopicMetrics::Timer::CALLBACK,
+	                std::chrono::steady_clock::now() - start);
+	metrics->add(TopicMetrics::Counter::MESSAGES_DELIVERED);
+}
+
+// Time by which a message expires, from its TTL or the default lifetime
+std::chrono::steady_clock::time_point messageExpiry(
+    std::chrono::steady_clock::time_point now, uint32_t ttl) {
+	if (ttl == 0) {
+		return now + DEFAULT_REQUEST_LIFETIME;
+	}
+	return now + std::chrono::milliseconds(ttl);
+}
+
+// Index of a priority in TransportConfig::Qos::lanes. Messages without a
+// priority are sent as CS1, the uProtocol default.
+size_t serviceClass(v1::UPriority priority) {
+	if ((priority < v1::UPriority::UPRIORITY_CS0) ||
+	    (priority > v1::UPriority::UPRIORITY_CS6)) {
+		return 1;
+	}
+	return priority - v1::UPriority::UPRIORITY_CS0;
+}
+
+zenoh::Priority toZenohPriority(TransportConfig::Qos::Priority priority) {
+	using Priority = TransportConfig::Qos::Priority;
+	switch (priority) {
+		case Priority::REAL_TIME:
+			return Z_PRIORITY_REAL_TIME;
+		case Priority::INTERACTIVE_HIGH:
+			return Z_PRIORITY_INTERACTIVE_HIGH;
+		case Priority::INTERACTIVE_LOW:
+			return Z_PRIORITY_INTERACTIVE_LOW;
+		case Priority::DATA_HIGH:
+			return Z_PRIORITY_DATA_HIGH;
+		case Priority::DATA:
+			return Z_PRIORITY_DATA;
+		case Priority::DATA_LOW:
+			return Z_PRIORITY_DATA_LOW;
+		case Priority::BACKGROUND:
+			return Z_PRIORITY_BACKGROUND;
+	}
+	return Z_PRIORITY_DATA;
+}
+
+zenoh::CongestionControl toZenohCongestionControl(
+    TransportConfig::Qos::CongestionControl congestion_control) {
+	using CongestionControl = TransportConfig::Qos::CongestionControl;
+	return (congestion_control == CongestionControl::BLOCK)
+	           ? Z_CONGESTION_CONTROL_BLOCK
+	           : Z_CONGESTION_CONTROL_DROP;
+}
+
+zenoh::Reliability toZenohReliability(
+    TransportConfig::Reliability::Mode mode) {
+	return (mode == TransportConfig::Reliability::Mode::RELIABLE)
+	           ? Z_RELIABILITY_RELIABLE
+	           : Z_RELIABILITY_BEST_EFFORT;
+}
+
+zenoh::Config loadZenohConfig(const std::filesystem::path& configFile) {
+	return zenoh::expect<zenoh::Config>(
+	    zenoh::config_from_file(configFile.string().c_str()));
+}
+
+TransportConfig readTransportConfig(const zenoh::Config& config) {
+	auto section =
+	    config.get(std::string(TransportConfig::ZENOH_CONFIG_KEY).c_str());
+	if (!section.check()) {
+		return {};
+	}
+	auto transport_config = TransportConfig::fromJson(section.c_str());
+#ifndef UP_TRANSPORT_ZENOH_SHM
+	if (transport_config.shared_memory.enabled) {
+		throw std::invalid_argument(
+		    "Shared memory was requested, but up-transport-zenoh-cpp was "
+		    "built without UP_TRANSPORT_ZENOH_ENABLE_SHM");
+	}
+#endif
+	return transport_config;
+}
+
+std::shared_ptr<zenoh::Session> openSession(
+    const std::filesystem::path& config_file, zenoh::Config&& config,
+    const TransportConfig& transport_config) {
+#ifdef UP_TRANSPORT_ZENOH_SHM
+	if (transport_config.shared_memory.enabled) {
+		// Subscribers on the same host can only map our segment if the
+		// session negotiates shared memory with them.
+		config.insert_json("transport/shared_memory/enabled", "true");
+	}
+#endif
+
+	auto open = [&config, &transport_config]() {
+		// The threads Zenoh starts meanwhile inherit the placement
+		const ScopedThreadPlacement placement(transport_config.threads.zenoh,
+		                                      "zenoh");
+		return std::make_shared<zenoh::Session>(
+		    zenoh::expect<zenoh::Session>(zenoh::open(std::move(config))));
+	};
+	if (!transport_config.session.shared) {
+		return open();
+	}
+
+	// Shared by instances built from the same file, however it was named
+	static SharedRegistry<std::filesystem::path, zenoh::Session> sessions;
+	std::error_code error;
+	auto key = std::filesystem::weakly_canonical(config_file, error);
+	if (error) {
+		key = std::filesystem::absolute(config_file);
+	}
+	return sessions.acquire(key, open);
+}
+
+}  // namespace
+
+v1::UStatus ZenohUTransport::uError(v1::UCode code, std::string_view message) {
+	v1::UStatus status;
+	status.set_code(code);
+	status.set_message(std::string(message));
+	return status;
+}
+
+ZenohUTransport::Attachment ZenohUTransport::uattributesToAttachment(
+    const v1::UAttributes& attributes, AttributesCodec::Format format) {
+	UP_TRANSPORT_ZENOH_TRACE(SERIALIZE);
+	Attachment attachment;
+	attachment.emplace_back("", std::string(1, static_cast<char>(format)));
+	attachment.emplace_back("", AttributesCodec::encode(attributes, format));
+	return attachment;
+}
+
+bool ZenohUTransport::attachmentToUAttributes(
+    const zenoh::AttachmentView& attachment, v1::UAttributes& attributes,
+    PayloadFormat* format) {
+	UP_TRANSPORT_ZENOH_TRACE(DECODE);
+	// Version and attributes, then optional entries told apart by key
+	std::array<zenoh::BytesView, 2> values;
+	size_t count = 0;
+	bool valid = true;
+	attachment.iterate([&values, &count, &valid, format](
+	                       const zenoh::BytesView& key,
+	                       const zenoh::BytesView& value) {
+		if (count < values.size()) {
+			values[count++] = value;
+			return true;
+		}
+		++count;
+		if (format == nullptr) {
+			return true;
+		}
+		if (key.as_string_view() == CHUNK_ENTRY) {
+			format->chunk = ChunkHeader::decode(value.as_string_view());
+			valid = valid && format->chunk.has_value();
+		} else if (key.as_string_view() == COMPRESSION_ENTRY) {
+			format->compression =
+			    Compression::Header::decode(value.as_string_view());
+			valid = valid && format->compression.has_value();
+		} else {
+			valid = false;
+		}
+		return true;
+	});
+
+	if ((count < values.size()) || ((format == nullptr) && (count > 2))) {
+		spdlog::error("Attachment has {} entries, expected {}", count,
+		              (format == nullptr) ? "2" : "at least 2");
+		return false;
+	}
+	if (!valid) {
+		spdlog::error("Attachment has an unknown or malformed entry");
+		return false;
+	}
+
+	if (values[0].get_len() != 1) {
+		spdlog::error("Attachment has an invalid version");
+		return false;
+	}
+
+	const auto version =
+	    static_cast<uint8_t>(values[0].as_string_view().front());
+	if (!AttributesCodec::decode(version, values[1].as_string_view(),
+	                             attributes)) {
+		spdlog::error("Attachment does not contain valid UAttributes "
+		              "(version {})",
+		              version);
+		return false;
+	}
+	return true;
+}
+
+bool ZenohUTransport::sampleToUAttributes(const zenoh::Sample& sample,
+                                          v1::UAttributes& attributes,
+                                          PayloadFormat* format) {
+	if (!sample.get_attachment().check()) {
+		spdlog::error("Sample on '{}' has no attachment",
+		              sample.get_keyexpr().as_string_view());
+		return false;
+	}
+
+	return attachmentToUAttributes(sample.get_attachment(), attributes,
+	                               format);
+}
+
+ZenohUTransport::ReceivedMessage ZenohUTransport::newMessage_() {
+	ReceivedMessage received{arena_pool_.acquire(), nullptr};
+	received.message = google::protobuf::Arena::CreateMessage<v1::UMessage>(
+	    received.arena.get());
+	return received;
+}
+
+void ZenohUTransport::setPayload(v1::UMessage& message,
+                                 const zenoh::BytesView& payload) {
+	UP_TRANSPORT_ZENOH_TRACE(DECODE);
+	// The payload is never parsed. When the sample came through shared
+	// memory, the view points straight into the mapped segment. Either way,
+	// this is the only copy made of it.
+	message.set_payload(payload.as_string_view().data(), payload.get_len());
+}
+
+ZenohUTransport::ZenohUTransport(const v1::UUri& defaultUri,
+                                 const std::filesystem::path& configFile)
+    : ZenohUTransport(defaultUri, configFile, loadZenohConfig(configFile)) {}
+
+ZenohUTransport::ZenohUTransport(const v1::UUri& defaultUri,
+                                 const std::filesystem::path& configFile,
+                                 zenoh::Config&& config)
+    : UTransport(defaultUri),
+      config_(readTransportConfig(config)),
+      ready_future_(ready_promise_.get_future().share()),
+      key_exprs_(getDefaultSource().authority_name(),
+                 config_.key_expr_table.capacity),
+      compression_rules_(makeCompressionRules(
+          getDefaultSource().authority_name(), config_.compression)),
+      reliability_rules_(makeReliabilityRules(
+          getDefaultSource().authority_name(), config_.reliability)),
+      publisher_cache_(config_.publisher_cache.capacity),
+      arena_pool_(config_.receive_arenas.count,
+                  config_.receive_arenas.block_size),
+      callback_guard_(std::make_shared<CallbackGuard>()) {
+	callback_guard_->transport = this;
+
+	if (config_.metrics.enabled) {
+		metrics_.emplace(config_.metrics.max_topics);
+	}
+
+	if (config_.latest_cache.depth > 0) {
+		latest_.emplace(config_.latest_cache.depth,
+		                config_.latest_cache.max_topics);
+		if (config_.latest_cache.query) {
+			published_.emplace(config_.latest_cache.depth,
+			                   config_.latest_cache.max_topics);
+		}
+	}
+
+	if (config_.dispatch.threads > 0) {
+		dispatcher_.emplace(config_.dispatch.threads,
+		                    config_.threads.dispatch);
+	}
+
+	if (config_.async_send.enabled) {
+		async_sender_.emplace(
+		    config_.async_send, [this](const AsyncSender::Item& item) {
+			    // Failures are logged by publish_(), and there is no caller
+			    // left to return them to
+			    if (dropExpired_(item.message, *item.zenoh_key)) {
+				    return;
+			    }
+			    const auto& attributes = item.message.attributes();
+			    std::shared_ptr<zenoh::Publisher> publisher;
+			    if (!isQueryMessage_(attributes)) {
+				    publisher =
+				        getPublisher_(*item.zenoh_key, attributes);
+			    }
+			    publish_(item.message, *item.zenoh_key, publisher.get());
+		    },
+		    config_.threads.async_send);
+	}
+
+	if (config_.session.lazy) {
+		// Sends and registrations are queued until the session is open
+		startup_thread_ = std::thread(
+		    [this, configFile, config = std::move(config)]() mutable {
+			    openSession_(configFile, std::move(config));
+		    });
+	} else {
+		openSession_(configFile, std::move(config));
+	}
+
+	spdlog::info("ZenohUTransport init");
+}
+
+void ZenohUTransport::openSession_(const std::filesystem::path& configFile,
+                                   zenoh::Config&& config) {
+	auto status = uError(v1::UCode::OK, "");
+	std::vector<LatestQuery> latest_queries;
+	try {
+		auto session = openSession(configFile, std::move(config), config_);
+
+		std::lock_guard lock(subscriptions_mutex_);
+		session_ = std::move(session);
+		if (config_.loopback.enabled) {
+			joinLoopback_();
+		}
+
+#ifdef UP_TRANSPORT_ZENOH_SHM
+		if (config_.shared_memory.enabled) {
+			// Segment IDs are visible host-wide, and each instance owns its
+			// own
+			static std::atomic<unsigned> segment_count{0};
+			const auto segment_id = "up-transport-zenoh-" +
+			                        std::to_string(getpid()) + "-" +
+			                        std::to_string(segment_count++);
+			shm_manager_.emplace(zenoh::expect<zenoh::ShmManager>(
+			    zenoh::shm_manager_new(*session_, segment_id.c_str(),
+			                           config_.shared_memory.segment_size)));
+		}
+#endif
+
+		// Listeners registered while the session was opening. Failures are
+		// logged, and there is no caller left to return them to.
+		for (auto& [key, subscription] : subscriptions_) {
+			declare_(subscription);
+		}
+		latest_queries.swap(deferred_latest_queries_);
+	} catch (const zenoh::ErrorMessage& error) {
+		if (!config_.session.lazy) {
+			throw;
+		}
+		{
+			std::lock_guard lock(subscriptions_mutex_);
+			for (auto& query : deferred_latest_queries_) {
+				query.listener.latest_replies->finish();
+			}
+			deferred_latest_queries_.clear();
+		}
+		spdlog::error("Failed to open the Zenoh session: {}",
+		              error.as_string_view());
+		status = uError(v1::UCode::UNAVAILABLE,
+		                "Failed to open the Zenoh session");
+	}
+
+	// Outside the lock, since the replies may arrive before get() returns
+	for (auto& query : latest_queries) {
+		queryLatest_(query.sink_filter, query.subscription_key,
+		             std::move(query.listener));
+	}
+	finishStartup_(status);
+}
+
+void ZenohUTransport::finishStartup_(const v1::UStatus& status) {
+	const bool open = (status.code() == v1::UCode::OK);
+	std::vector<v1::UMessage> deferred;
+	std::vector<ReadyCallback> callbacks;
+	for (;;) {
+		{
+			std::lock_guard lock(startup_mutex_);
+			// Senders keep queueing until the queue is found empty here,
+			// which keeps their messages in order
+			if (deferred_sends_.empty()) {
+				session_state_.store(
+				    open ? SessionState::OPEN : SessionState::FAILED,
+				    std::memory_order_release);
+				startup_status_ = status;
+				callbacks = std::move(ready_callbacks_);
+				break;
+			}
+			deferred.swap(deferred_sends_);
+		}
+		if (open) {
+			// Failures are logged by publish_()
+			for (const auto& message : deferred) {
+				auto zenoh_key = destinationKey_(message.attributes());
+				if (!dropExpired_(message, *zenoh_key)) {
+					send_(message, std::move(zenoh_key));
+				}
+			}
+		} else {
+			spdlog::warn("Dropping {} messages sent before the session "
+			             "failed to open",
+			             deferred.size());
+		}
+		deferred.clear();
+	}
+
+	ready_promise_.set_value(status);
+	for (auto& callback : callbacks) {
+		callback(status);
+	}
+}
+
+std::optional<v1::UStatus> ZenohUTransport::deferSend_(
+    const v1::UMessage& message) {
+	std::lock_guard lock(startup_mutex_);
+	switch (session_state_.load(std::memory_order_acquire)) {
+		case SessionState::OPENING:
+			deferred_sends_.push_back(message);
+			return uError(v1::UCode::OK, "");
+		case SessionState::FAILED:
+			return uError(v1::UCode::UNAVAILABLE,
+			              "The Zenoh session could not be opened");
+		case SessionState::OPEN:
+			break;
+	}
+	return std::nullopt;
+}
+
+std::shared_future<v1::UStatus> ZenohUTransport::getReadyFuture() const {
+	return ready_future_;
+}
+
+void ZenohUTransport::onReady(ReadyCallback&& callback) {
+	std::unique_lock lock(startup_mutex_);
+	if (!startup_status_) {
+		ready_callbacks_.push_back(std::move(callback));
+		return;
+	}
+	const auto status = *startup_status_;
+	lock.unlock();
+	callback(status);
+}
+
+ZenohUTransport::~ZenohUTransport() {
+	// Opening a session cannot be interrupted, so this waits for it
+	if (startup_thread_.joinable()) {
+		startup_thread_.join();
+	}
+
+	// Queued requests still need the guard to get their replies
+	async_sender_.reset();
+
+	// Leaving first means no other transport waits on the guard below
+	if (loopback_) {
+		loopback_->members.update([this](auto& members) {
+			members.erase(
+			    std::remove(members.begin(), members.end(), callback_guard_),
+			    members.end());
+		});
+	}
+
+	// Waits for reply callbacks already running
+	std::unique_lock lock(callback_guard_->mutex);
+	callback_guard_->transport = nullptr;
+}
+
+#ifdef UP_TRANSPORT_ZENOH_SHM
+std::optional<zenoh::Payload> ZenohUTransport::toShmPayload_(
+    std::string_view payload) {
+	if (!shm_manager_ ||
+	    (payload.size() < config_.shared_memory.threshold)) {
+		return std::nullopt;
+	}
+
+	std::optional<zenoh::Shmbuf> buffer;
+	{
+		std::lock_guard lock(shm_manager_mutex_);
+		auto allocated = shm_manager_->alloc(payload.size());
+		if (std::holds_alternative<zenoh::ErrorMessage>(allocated)) {
+			// Buffers released by subscribers are only reclaimed on gc()
+			shm_manager_->gc();
+			allocated = shm_manager_->alloc(payload.size());
+		}
+		if (std::holds_alternative<zenoh::ErrorMessage>(allocated)) {
+			spdlog::debug("Shared-memory segment is full, publishing {} "
+			              "bytes from the heap",
+			              payload.size());
+			return std::nullopt;
+		}
+		buffer.emplace(std::move(std::get<zenoh::Shmbuf>(allocated)));
+	}
+
+	std::memcpy(buffer->ptr(), payload.data(), payload.size());
+	buffer->set_length(payload.size());
+	return buffer->into_payload();
+}
+#endif
+
+std::shared_ptr<const InternedKeyExpr> ZenohUTransport::destinationKey_(
+    const v1::UAttributes& attributes) {
+	UP_TRANSPORT_ZENOH_TRACE(KEY_EXPR);
+	if (!attributes.has_sink()) {
+		return key_exprs_.get(attributes.source());
+	}
+	if (config_.key_format ==
+	    TransportConfig::KeyFormat::DESTINATION_AND_SOURCE) {
+		return key_exprs_.get(attributes.sink(), attributes.source());
+	}
+	return key_exprs_.get(attributes.sink());
+}
+
+const TransportConfig::Qos::Lane& ZenohUTransport::laneFor_(
+    v1::UPriority priority) const {
+	return config_.qos.lanes[serviceClass(priority)];
+}
+
+TransportConfig::Qos::Lane ZenohUTransport::laneFor_(
+    const v1::UAttributes& attributes) const {
+	using CongestionControl = TransportConfig::Qos::CongestionControl;
+	auto lane = laneFor_(attributes.priority());
+	if (reliability_rules_.empty()) {
+		return lane;
+	}
+	const auto mode = reliabilityFor_(attributes.has_sink()
+	                                      ? attributes.sink()
+	                                      : attributes.source());
+	if (mode) {
+		lane.congestion_control =
+		    (*mode == TransportConfig::Reliability::Mode::RELIABLE)
+		        ? CongestionControl::BLOCK
+		        : CongestionControl::DROP;
+	}
+	return lane;
+}
+
+std::vector<ZenohUTransport::ReliabilityRule>
+ZenohUTransport::makeReliabilityRules(
+    const std::string& default_authority_name,
+    const TransportConfig::Reliability& config) {
+	std::vector<ReliabilityRule> rules;
+	rules.reserve(config.rules.size());
+	for (const auto& rule : config.rules) {
+		rules.push_back(
+		    {UriFilter(default_authority_name, rule.pattern), rule.mode});
+	}
+	return rules;
+}
+
+std::optional<TransportConfig::Reliability::Mode>
+ZenohUTransport::reliabilityFor_(const v1::UUri& uri) const {
+	for (const auto& rule : reliability_rules_) {
+		if (rule.filter.matches(uri)) {
+			return rule.mode;
+		}
+	}
+	return std::nullopt;
+}
+
+std::shared_ptr<zenoh::Publisher> ZenohUTransport::getPublisher_(
+    const InternedKeyExpr& zenoh_key, const v1::UAttributes& attributes) {
+	if (config_.publisher_cache.capacity == 0) {
+		return nullptr;
+	}
+
+	std::lock_guard lock(publisher_cache_mutex_);
+	return getPublisherLocked_(zenoh_key, attributes);
+}
+
+std::shared_ptr<zenoh::Publisher> ZenohUTransport::getPublisherLocked_(
+    const InternedKeyExpr& zenoh_key, const v1::UAttributes& attributes) {
+	// The reliability follows from the destination, and so from the key
+	PublisherKey key{zenoh_key.key, serviceClass(attributes.priority())};
+	if (auto* cached = publisher_cache_.find(key)) {
+		return *cached;
+	}
+
+	const auto lane = laneFor_(attributes);
+	zenoh::PublisherOptions options;
+	options.set_priority(toZenohPriority(lane.priority));
+	options.set_congestion_control(
+	    toZenohCongestionControl(lane.congestion_control));
+
+	auto declared = session_->declare_publisher(
+	    zenoh_key.expr.as_keyexpr_view(), options);
+	if (auto* error = std::get_if<zenoh::ErrorMessage>(&declared)) {
+		spdlog::warn("Failed to declare publisher for '{}': {}",
+		             zenoh_key.key, error->as_string_view());
+		return nullptr;
+	}
+
+	auto publisher = std::make_shared<zenoh::Publisher>(
+	    std::move(std::get<zenoh::Publisher>(declared)));
+	publisher_cache_.insert(key, publisher);
+	return publisher;
+}
+
+std::optional<AsyncSender::Stats> ZenohUTransport::getAsyncSendStats() const {
+	if (!async_sender_) {
+		return std::nullopt;
+	}
+	return async_sender_->stats();
+}
+
+std::optional<MetricsSnapshot> ZenohUTransport::getMetrics() const {
+	if (!metrics_) {
+		return std::nullopt;
+	}
+	MetricsSnapshot snapshot;
+	snapshot.topics = metrics_->snapshot();
+	if (async_sender_) {
+		const auto stats = async_sender_->stats();
+		snapshot.async_send_queued = stats.queued;
+		snapshot.async_send_dropped = stats.dropped;
+	}
+	if (dispatcher_) {
+		snapshot.dispatch_queued = dispatcher_->queued();
+	}
+	return snapshot;
+}
+
+LatestCache::Messages ZenohUTransport::getLatest(
+    const v1::UUri& topic) const {
+	if (!latest_) {
+		return {};
+	}
+	return latest_->get(KeyExprTable::toZenohKeyString(
+	    getDefaultSource().authority_name(), topic));
+}
+
+std::shared_ptr<TopicMetrics> ZenohUTransport::metricsFor_(
+    const std::string& zenoh_key) {
+	return metrics_ ? metrics_->get(zenoh_key) : nullptr;
+}
+
+bool ZenohUTransport::dropExpired_(const v1::UMessage& message,
+                                   const InternedKeyExpr& zenoh_key) {
+	if (!isExpired(message.attributes())) {
+		return false;
+	}
+	spdlog::debug("Dropping a message for '{}' whose TTL has run out",
+	              zenoh_key.key);
+	countExpired(metricsFor_(zenoh_key.key).get());
+	return true;
+}
+
+size_t ZenohUTransport::getSubscriptionCount() const {
+	std::lock_guard lock(subscriptions_mutex_);
+	return subscriptions_.size();
+}
+
+ZenohUTransport::PublisherCacheStats ZenohUTransport::getPublisherCacheStats()
+    const {
+	std::lock_guard lock(publisher_cache_mutex_);
+	return publisher_cache_.stats();
+}
+
+bool ZenohUTransport::put_(const InternedKeyExpr& zenoh_key,
+                           zenoh::Publisher* publisher,
+                           const TransportConfig::Qos::Lane& lane,
+                           std::string_view payload,
+                           const Attachment& attachment, zenoh::ErrNo& error) {
+	UP_TRANSPORT_ZENOH_TRACE(PUT);
+	const auto encoding = zenoh::Encoding(Z_ENCODING_PREFIX_APP_CUSTOM);
+	const zenoh::BytesView bytes(payload.data(), payload.size());
+
+#ifdef UP_TRANSPORT_ZENOH_SHM
+	auto shm_payload = toShmPayload_(payload);
+#endif
+
+	// NOTE: the options hold a view of the attachment, which must therefore
+	// outlive the put.
+	if (publisher != nullptr) {
+		zenoh::PublisherPutOptions options;
+		options.set_encoding(encoding);
+		options.set_attachment(attachment);
+#ifdef UP_TRANSPORT_ZENOH_SHM
+		if (shm_payload) {
+			return publisher->put_owned(std::move(*shm_payload), options,
+			                            error);
+		}
+#endif
+		return publisher->put(bytes, options, error);
+	}
+
+	zenoh::PutOptions options;
+	options.set_encoding(encoding);
+	options.set_attachment(attachment);
+	options.set_priority(toZenohPriority(lane.priority));
+	options.set_congestion_control(
+	    toZenohCongestionControl(lane.congestion_control));
+#ifdef UP_TRANSPORT_ZENOH_SHM
+	if (shm_payload) {
+		return session_->put_owned(zenoh_key.expr.as_keyexpr_view(),
+		                          std::move(*shm_payload), options, error);
+	}
+#endif
+	return session_->put(zenoh_key.expr.as_keyexpr_view(), bytes, options,
+	                    error);
+}
+
+v1::UStatus ZenohUTransport::publish_(const v1::UMessage& message,
+                                      const InternedKeyExpr& zenoh_key,
+                                      zenoh::Publisher* publisher) {
+	// Listeners on the loopback bus already have the message
+	const LoopedBack looped_back(
+	    (loopback_ && !isQueryMessage_(message.attributes())) ? loopback_.get()
+	                                                           : nullptr);
+	auto metrics = metricsFor_(zenoh_key.key);
+	if (!metrics) {
+		auto attachment = uattributesToAttachment(message.attributes(),
+		                                          config_.attributes_encoding);
+		auto status = transmit_(message, zenoh_key, publisher, attachment);
+		if (status.code() == v1::UCode::OK) {
+			cachePublished_(message, zenoh_key);
+		}
+		return status;
+	}
+
+	using Timer = TopicMetrics::Timer;
+	using Counter = TopicMetrics::Counter;
+	const auto start = std::chrono::steady_clock::now();
+	auto attachment = uattributesToAttachment(message.attributes(),
+	                                          config_.attributes_encoding);
+	const auto encoded = std::chrono::steady_clock::now();
+	auto status = transmit_(message, zenoh_key, publisher, attachment);
+	const auto sent = std::chrono::steady_clock::now();
+
+	metrics->record(Timer::SERIALIZE, encoded - start);
+	metrics->record(Timer::SEND, sent - encoded);
+	if (status.code() == v1::UCode::OK) {
+		metrics->add(Counter::MESSAGES_SENT);
+		metrics->add(Counter::BYTES_SENT, message.payload().size());
+		cachePublished_(message, zenoh_key);
+	} else {
+		metrics->add(Counter::SEND_FAILURES);
+	}
+	return status;
+}
+
+v1::UStatus ZenohUTransport::transmit_(const v1::UMessage& message,
+                                       const InternedKeyExpr& zenoh_key,
+                                       zenoh::Publisher* publisher,
+                                       Attachment& attachment) {
+	if (isQueryMessage_(message.attributes())) {
+		if (message.attributes().type() ==
+		    v1::UMessageType::UMESSAGE_TYPE_REQUEST) {
+			return query_(message, zenoh_key, attachment);
+		}
+		// A response to a request that did not come as a query (e.g. from
+		// a peer with queries disabled) is put like any other message
+		if (auto status = reply_(message, attachment)) {
+			return *status;
+		}
+	}
+
+	const auto* compression =
+	    compressionFor_(message.attributes(), message.payload().size());
+
+	const auto chunk_size = config_.chunking.chunk_size;
+	if ((chunk_size > 0) && (message.payload().size() > chunk_size)) {
+		return putChunked_(message, zenoh_key, publisher, attachment,
+		                   compression);
+	}
+
+	const auto compressed =
+	    compress(compression, message.payload(), attachment);
+
+	zenoh::ErrNo error = 0;
+	if (!put_(zenoh_key, publisher, laneFor_(message.attributes()),
+	          compressed ? std::string_view(*compressed) : message.payload(),
+	          attachment, error)) {
+		spdlog::error("Failed to publish on '{}' (error {})", zenoh_key.key,
+		              error);
+		return uError(v1::UCode::INTERNAL, "Failed to publish");
+	}
+
+	return uError(v1::UCode::OK, "");
+}
+
+std::vector<ZenohUTransport::CompressionRule>
+ZenohUTransport::makeCompressionRules(
+    const std::string& default_authority_name,
+    const TransportConfig::Compression& config) {
+	std::vector<CompressionRule> rules;
+	rules.reserve(config.rules.size());
+	for (const auto& rule : config.rules) {
+		if ((rule.codec != Compression::Codec::NONE) &&
+		    !Compression::isAvailable(rule.codec)) {
+			throw std::invalid_argument(
+			    "Compression rule names a codec up-transport-zenoh-cpp was "
+			    "built without (see UP_TRANSPORT_ZENOH_ENABLE_LZ4 and "
+			    "UP_TRANSPORT_ZENOH_ENABLE_ZSTD)");
+		}
+		rules.push_back({UriFilter(default_authority_name, rule.pattern),
+		                 rule.codec, rule.level,
+		                 rule.threshold});
+	}
+	return rules;
+}
+
+const ZenohUTransport::CompressionRule* ZenohUTransport::compressionFor_(
+    const v1::UAttributes& attributes, size_t size) const {
+	const auto& destination =
+	    attributes.has_sink() ? attributes.sink() : attributes.source();
+	for (const auto& rule : compression_rules_) {
+		if (rule.filter.matches(destination)) {
+			const bool compress = (rule.codec != Compression::Codec::NONE) &&
+			                      (size >= rule.threshold);
+			return compress ? &rule : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+std::optional<std::string> ZenohUTransport::compress(
+    const CompressionRule* rule, std::string_view payload,
+    Attachment& attachment) {
+	if (rule == nullptr) {
+		return std::nullopt;
+	}
+	auto compressed = Compression::compress(rule->codec, payload, rule->level);
+	if (compressed) {
+		attachment.emplace_back(
+		    COMPRESSION_ENTRY,
+		    Compression::Header{rule->codec, payload.size()}.encode());
+	}
+	return compressed;
+}
+
+v1::UStatus ZenohUTransport::putChunked_(const v1::UMessage& message,
+                                         const InternedKeyExpr& zenoh_key,
+                                         zenoh::Publisher* publisher,
+                                         const Attachment& attachment,
+                                         const CompressionRule* compression) {
+	const std::string_view payload = message.payload();
+	const auto chunk_size = config_.chunking.chunk_size;
+	const auto count = (payload.size() + chunk_size - 1) / chunk_size;
+	if (count > std::numeric_limits<uint32_t>::max()) {
+		return uError(v1::UCode::INVALID_ARGUMENT,
+		              "Payload is too large to send in chunks");
+	}
+
+	ChunkHeader header;
+	header.count = static_cast<uint32_t>(count);
+	header.total_size = payload.size();
+
+	auto chunk_attachment = attachment;
+	chunk_attachment.emplace_back(CHUNK_ENTRY, "");
+	const auto chunk_entry = chunk_attachment.size() - 1;
+	const auto lane = laneFor_(message.attributes());
+
+	// Every chunk goes through the same publisher, in order, which is the
+	// order ChunkAssembler expects them in. Each one is compressed on its
+	// own, so that chunk listeners can decompress it as it arrives.
+	for (; header.index < header.count; ++header.index) {
+		chunk_attachment[chunk_entry].second = header.encode();
+		const auto chunk = payload.substr(header.offset, chunk_size);
+		const auto compressed = compress(compression, chunk, chunk_attachment);
+		zenoh::ErrNo error = 0;
+		const bool sent =
+		    put_(zenoh_key, publisher, lane,
+		         compressed ? std::string_view(*compressed) : chunk,
+		         chunk_attachment, error);
+		if (compressed) {
+			chunk_attachment.pop_back();
+		}
+		if (!sent) {
+			spdlog::error("Failed to publish chunk {} of {} on '{}' "
+			              "(error {})",
+			              header.index, header.count, zenoh_key.key, error);
+			return uError(v1::UCode::INTERNAL, "Failed to publish");
+		}
+		header.offset += chunk_size;
+	}
+
+	return uError(v1::UCode::OK, "");
+}
+
+v1::UStatus ZenohUTransport::sendImpl(const v1::UMessage& message) {
+	auto zenoh_key = destinationKey_(message.attributes());
+	if (!zenoh_key) {
+		return uError(v1::UCode::INVALID_ARGUMENT,
+		              "Destination does not form a valid Zenoh key");
+	}
+	if (dropExpired_(message, *zenoh_key)) {
+		return uError(v1::UCode::DEADLINE_EXCEEDED,
+		              "Message expired before it was sent");
+	}
+	if (skipUnmatched_(message, *zenoh_key)) {
+		return uError(v1::UCode::UNAVAILABLE, "Topic has no subscribers");
+	}
+
+	if (session_state_.load(std::memory_order_acquire) !=
+	    SessionState::OPEN) {
+		if (auto status = deferSend_(message)) {
+			return *status;
+		}
+	}
+	return send_(message, std::move(zenoh_key));
+}
+
+v1::UStatus ZenohUTransport::send_(
+    const v1::UMessage& message,
+    std::shared_ptr<const InternedKeyExpr> zenoh_key) {
+	v1::UStatus status;
+	if (async_sender_) {
+		status = enqueue_(message, std::move(zenoh_key));
+	} else if (isQueryMessage_(message.attributes())) {
+		status = publish_(message, *zenoh_key, nullptr);
+	} else {
+		status = publish_(
+		    message, *zenoh_key,
+		    getPublisher_(*zenoh_key, message.attributes()).get());
+	}
+	// Local listeners only get what was accepted, so that a caller retrying
+	// a failed send does not hand them the message twice
+	if (status.code() == v1::UCode::OK) {
+		loopBack_(message);
+	}
+	return status;
+}
+
+bool ZenohUTransport::isQueryMessage_(
+    const v1::UAttributes& attributes) const {
+	return config_.rpc.queries &&
+	       ((attributes.type() == v1::UMessageType::UMESSAGE_TYPE_REQUEST) ||
+	        (attributes.type() == v1::UMessageType::UMESSAGE_TYPE_RESPONSE));
+}
+
+v1::UStatus ZenohUTransport::query_(const v1::UMessage& message,
+                                    const InternedKeyExpr& zenoh_key,
+                                    const Attachment& attachment) {
+	const auto& payload = message.payload();
+
+	zenoh::GetOptions options;
+	options.set_target(Z_QUERY_TARGET_BEST_MATCHING);
+	options.set_value(
+	    zenoh::Value(zenoh::BytesView(payload.data(), payload.size()),
+	                 zenoh::Encoding(Z_ENCODING_PREFIX_APP_CUSTOM)));
+	options.set_attachment(attachment);
+	if (message.attributes().ttl() > 0) {
+		options.set_timeout_ms(message.attributes().ttl());
+	}
+
+	// Tracked before the query is sent, since the reply may arrive before
+	// get() returns
+	const auto& request_id = message.attributes().id();
+	const auto now = std::chrono::steady_clock::now();
+	{
+		std::lock_guard lock(outstanding_requests_mutex_);
+		outstanding_requests_.expire(now);
+		outstanding_requests_.insert(
+		    request_id, now,
+		    messageExpiry(now, message.attributes().ttl()));
+	}
+
+	// Replies can arrive after the transport is gone, hence the guard
+	auto on_reply = [guard = callback_guard_](zenoh::Reply&& reply) {
+		std::shared_lock lock(guard->mutex);
+		if (guard->transport != nullptr) {
+			guard->transport->onReply_(std::move(reply));
+		}
+	};
+	auto on_done = [guard = callback_guard_, request_id]() {
+		std::shared_lock lock(guard->mutex);
+		if (guard->transport != nullptr) {
+			guard->transport->onQueryDone_(request_id);
+		}
+	};
+
+	UP_TRANSPORT_ZENOH_TRACE(PUT);
+	zenoh::ErrNo error = 0;
+	if (!session_->get(zenoh_key.expr.as_keyexpr_view(), "",
+	                  std::move(on_reply), std::move(on_done), options,
+	                  error)) {
+		spdlog::error("Failed to query '{}' (error {})", zenoh_key.key,
+		              error);
+		onQueryDone_(request_id);
+		return uError(v1::UCode::INTERNAL, "Failed to send request");
+	}
+
+	return uError(v1::UCode::OK, "");
+}
+
+std::optional<v1::UStatus> ZenohUTransport::reply_(
+    const v1::UMessage& message, const Attachment& attachment) {
+	std::optional<zenoh::OwnedQuery> pending;
+	{
+		std::lock_guard lock(pending_queries_mutex_);
+		pending = pending_queries_.take(message.attributes().reqid());
+	}
+	if (!pending) {
+		return std::nullopt;
+	}
+
+	const auto& payload = message.payload();
+	const auto& query = pending->loan();
+
+	zenoh::QueryReplyOptions options;
+	options.set_encoding(zenoh::Encoding(Z_ENCODING_PREFIX_APP_CUSTOM));
+	options.set_attachment(attachment);
+
+	// Zenoh only accepts replies on a key matching the query, so the reply
+	// goes out on the method key rather than the response sink. Dropping
+	// the query afterwards tells the caller no other reply will follow.
+	UP_TRANSPORT_ZENOH_TRACE(PUT);
+	zenoh::ErrNo error = 0;
+	if (!query.reply(query.get_keyexpr(),
+	                 zenoh::BytesView(payload.data(), payload.size()),
+	                 options, error)) {
+		spdlog::error("Failed to reply to query on '{}' (error {})",
+		              query.get_keyexpr().as_string_view(), error);
+		return uError(v1::UCode::INTERNAL, "Failed to send response");
+	}
+
+	return uError(v1::UCode::OK, "");
+}
+
+void ZenohUTransport::onQueryDone_(const v1::UUID& request_id) {
+	std::lock_guard lock(outstanding_requests_mutex_);
+	outstanding_requests_.take(request_id);
+}
+
+v1::UStatus ZenohUTransport::enqueue_(
+    const v1::UMessage& message,
+    std::shared_ptr<const InternedKeyExpr> zenoh_key) {
+	if (!async_sender_->submit({std::move(zenoh_key), message})) {
+		return uError(v1::UCode::RESOURCE_EXHAUSTED, "Send queue is full");
+	}
+	return uError(v1::UCode::OK, "");
+}
+
+std::vector<v1::UStatus> ZenohUTransport::sendBatch(
+    const v1::UMessage* messages, size_t count) {
+	if (session_state_.load(std::memory_order_acquire) !=
+	    SessionState::OPEN) {
+		// Queued one by one, or sent that way if the session opens meanwhile
+		std::vector<v1::UStatus> statuses;
+		statuses.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			statuses.push_back(sendImpl(messages[i]));
+		}
+		return statuses;
+	}
+
+	std::vector<std::shared_ptr<const InternedKeyExpr>> zenoh_keys(count);
+	for (size_t i = 0; i < count; ++i) {
+		zenoh_keys[i] = destinationKey_(messages[i].attributes());
+	}
+
+	// Publishers are held by shared_ptr, so they stay usable after the lock
+	// is released even if another thread evicts them from the cache. In
+	// asynchronous mode, the I/O thread looks them up instead.
+	std::vector<std::shared_ptr<zenoh::Publisher>> publishers(count);
+	if (!async_sender_ && (config_.publisher_cache.capacity != 0)) {
+		std::lock_guard lock(publisher_cache_mutex_);
+		for (size_t i = 0; i < count; ++i) {
+			if (zenoh_keys[i] && !isQueryMessage_(messages[i].attributes())) {
+				publishers[i] = getPublisherLocked_(*zenoh_keys[i],
+				                                    messages[i].attributes());
+			}
+		}
+	}
+
+	std::vector<v1::UStatus> statuses;
+	statuses.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		if (!zenoh_keys[i]) {
+			statuses.push_back(
+			    uError(v1::UCode::INVALID_ARGUMENT,
+			           "Destination does not form a valid Zenoh key"));
+			continue;
+		}
+		if (dropExpired_(messages[i], *zenoh_keys[i])) {
+			statuses.push_back(uError(v1::UCode::DEADLINE_EXCEEDED,
+			                          "Message expired before it was sent"));
+			continue;
+		}
+		if (skipUnmatched_(messages[i], *zenoh_keys[i])) {
+			statuses.push_back(
+			    uError(v1::UCode::UNAVAILABLE, "Topic has no subscribers"));
+			continue;
+		}
+		if (async_sender_) {
+			statuses.push_back(enqueue_(messages[i], std::move(zenoh_keys[i])));
+		} else {
+			statuses.push_back(
+			    publish_(messages[i], *zenoh_keys[i], publishers[i].get()));
+		}
+		if (statuses.back().code() == v1::UCode::OK) {
+			loopBack_(messages[i]);
+		}
+	}
+	return statuses;
+}
+
+v1::UStatus ZenohUTransport::registerListenerImpl(
+    const v1::UUri& sink_filter, CallableConn&& listener,
+    std::optional<v1::UUri>&& source_filter) {
+	Listener entry{listener, std::nullopt};
+	// The source filter is compiled once here rather than on every sample
+	if (source_filter) {
+		entry.source_filter.emplace(getDefaultSource().authority_name(),
+		                            *source_filter);
+	}
+
+	const bool query = trackLatestReplies_(sink_filter, entry);
+	const auto latest_listener = entry;
+	std::string subscription_key;
+	bool query_now = false;
+	{
+		std::lock_guard lock(subscriptions_mutex_);
+		auto zenoh_key = subscribe_(
+		    sink_filter, source_filter ? &*source_filter : nullptr,
+		    std::move(entry));
+		if (!zenoh_key) {
+			return zenoh_key.error();
+		}
+		subscription_key = *zenoh_key;
+		listener_keys_.emplace(std::move(listener), std::move(*zenoh_key));
+		query_now = query && scheduleLatestQuery_(sink_filter, subscription_key,
+		                                          latest_listener);
+	}
+	// Outside the lock, since the replies may arrive before get() returns
+	if (query_now) {
+		queryLatest_(sink_filter, subscription_key, latest_listener);
+	}
+	return uError(v1::UCode::OK, "");
+}
+
+utils::Expected<ZenohUTransport::ChunkListenerHandle, v1::UStatus>
+ZenohUTransport::registerChunkListener(
+    const v1::UUri& sink_filter, ChunkCallback&& callback,
+    std::optional<v1::UUri>&& source_filter) {
+	auto shared_callback =
+	    std::make_shared<ChunkCallback>(std::move(callback));
+
+	Listener entry{CallableConn(), std::nullopt, shared_callback, true};
+	if (source_filter) {
+		entry.source_filter.emplace(getDefaultSource().authority_name(),
+		                            *source_filter);
+	}
+
+	std::lock_guard lock(subscriptions_mutex_);
+	auto zenoh_key = subscribe_(
+	    sink_filter, source_filter ? &*source_filter : nullptr,
+	    std::move(entry));
+	if (!zenoh_key) {
+		return utils::Unexpected<v1::UStatus>(zenoh_key.error());
+	}
+	chunk_listener_keys_.emplace(shared_callback.get(),
+	                             std::move(*zenoh_key));
+	return ChunkListenerHandle(this, std::move(shared_callback));
+}
+
+utils::Expected<ZenohUTransport::PullSubscription, v1::UStatus>
+ZenohUTransport::registerPullListener(const v1::UUri& sink_filter,
+                                      size_t capacity,
+                                      std::optional<v1::UUri>&& source_filter) {
+	if (capacity == 0) {
+		return utils::Unexpected<v1::UStatus>(uError(
+		    v1::UCode::INVALID_ARGUMENT, "Pull listener needs a capacity"));
+	}
+	auto ring = std::make_shared<MessageRing>(capacity);
+	auto handle = registerListener(
+	    sink_filter,
+	    [ring](const v1::UMessage& message) { ring->push(message); },
+	    std::move(source_filter));
+	if (!handle) {
+		return utils::Unexpected<v1::UStatus>(handle.error());
+	}
+	return PullSubscription(std::move(*handle), std::move(ring));
+}
+
+utils::Expected<ZenohUTransport::MatchingHandle, v1::UStatus>
+ZenohUTransport::registerMatchingListener(const v1::UUri& topic,
+                                          MatchingCallback&& callback) {
+	if (session_state_.load(std::memory_order_acquire) !=
+	    SessionState::OPEN) {
+		return utils::Unexpected<v1::UStatus>(
+		    uError(v1::UCode::UNAVAILABLE, "The Zenoh session is not open"));
+	}
+	auto zenoh_key = key_exprs_.get(topic);
+	if (!zenoh_key) {
+		return utils::Unexpected<v1::UStatus>(
+		    uError(v1::UCode::INVALID_ARGUMENT,
+		           "Topic does not form a valid Zenoh key"));
+	}
+
+	auto shared_callback =
+	    std::make_shared<MatchingCallback>(std::move(callback));
+	bool matching = false;
+	{
+		std::lock_guard lock(matching_mutex_);
+		auto& watch = matching_[zenoh_key->key];
+		if (!watch) {
+			watch = std::make_shared<MatchingWatch>();
+			auto publisher = session_->declare_publisher(
+			    zenoh_key->expr.as_keyexpr_view(), zenoh::PublisherOptions());
+			if (auto* error = std::get_if<zenoh::ErrorMessage>(&publisher)) {
+				spdlog::error("Failed to declare publisher for '{}': {}",
+				              zenoh_key->key, error->as_string_view());
+				matching_.erase(zenoh_key->key);
+				return utils::Unexpected<v1::UStatus>(uError(
+				    v1::UCode::INTERNAL, "Failed to declare publisher"));
+			}
+			watch->publisher.emplace(
+			    std::move(std::get<zenoh::Publisher>(publisher)));
+
+			// The status can change after the transport is gone, hence
+			// the guard
+			auto listener = session_->declare_matching_listener(
+			    *watch->publisher,
+			    [guard = callback_guard_,
+			     weak = std::weak_ptr<MatchingWatch>(watch)](
+			        const zenoh::MatchingStatus& status) {
+				    std::shared_lock guard_lock(guard->mutex);
+				    auto watched = weak.lock();
+				    if ((guard->transport != nullptr) && watched) {
+					    onMatching_(*watched, status.matching);
+				    }
+			    });
+			if (auto* error = std::get_if<zenoh::ErrorMessage>(&listener)) {
+				spdlog::error("Failed to declare matching listener for "
+				              "'{}': {}",
+				              zenoh_key->key, error->as_string_view());
+				matching_.erase(zenoh_key->key);
+				return utils::Unexpected<v1::UStatus>(
+				    uError(v1::UCode::INTERNAL,
+				           "Failed to declare matching listener"));
+			}
+			watch->listener.emplace(
+			    std::move(std::get<zenoh::MatchingListener>(listener)));
+		}
+		watch->callbacks.update([&shared_callback](auto& callbacks) {
+			callbacks.push_back(shared_callback);
+		});
+		matching = watch->matching.load(std::memory_order_acquire);
+	}
+
+	(*shared_callback)(matching);
+	return MatchingHandle(this, zenoh_key->key, std::move(shared_callback));
+}
+
+std::optional<bool> ZenohUTransport::hasSubscribers(
+    const v1::UUri& topic) const {
+	return hasSubscribers_(KeyExprTable::toZenohKeyString(
+	    getDefaultSource().authority_name(), topic));
+}
+
+std::optional<bool> ZenohUTransport::hasSubscribers_(
+    const std::string& zenoh_key) const {
+	std::lock_guard lock(matching_mutex_);
+	auto watch = matching_.find(zenoh_key);
+	if (watch == matching_.end()) {
+		return std::nullopt;
+	}
+	return watch->second->matching.load(std::memory_order_acquire);
+}
+
+bool ZenohUTransport::skipUnmatched_(const v1::UMessage& message,
+                                     const InternedKeyExpr& zenoh_key) const {
+	return config_.matching.skip_unmatched &&
+	       !isQueryMessage_(message.attributes()) &&
+	       !hasSubscribers_(zenoh_key.key).value_or(true);
+}
+
+void ZenohUTransport::onMatching_(MatchingWatch& watch, bool matching) {
+	watch.matching.store(matching, std::memory_order_release);
+	// Called outside the read, since a callback may register another
+	auto callbacks =
+	    watch.callbacks.read([](const auto& current) { return current; });
+	for (const auto& callback : callbacks) {
+		(*callback)(matching);
+	}
+}
+
+std::vector<utils::Expected<ZenohUTransport::ListenHandle, v1::UStatus>>
+ZenohUTransport::registerListeners(ListenerRegistration* registrations,
+                                   size_t count) {
+	std::vector<ListenHandle> handles;
+	std::vector<CallableConn> callables;
+	std::vector<NewListener> entries;
+	std::vector<bool> queried(count, false);
+	handles.reserve(count);
+	callables.reserve(count);
+	entries.reserve(count);
+	for (size_t i = 0; i < count; ++i) {
+		auto& registration = registrations[i];
+		auto [handle, callable] = CallbackConnection::establish(
+		    std::move(registration.callback),
+		    [this](auto conn) { cleanupListener(conn); });
+		Listener entry{callable, std::nullopt};
+		if (registration.source_filter) {
+			entry.source_filter.emplace(getDefaultSource().authority_name(),
+			                            *registration.source_filter);
+		}
+		queried[i] = trackLatestReplies_(registration.sink_filter, entry);
+		entries.push_back({registration.sink_filter,
+		                   registration.source_filter
+		                       ? &*registration.source_filter
+		                       : nullptr,
+		                   std::move(entry)});
+		handles.push_back(std::move(handle));
+		callables.push_back(std::move(callable));
+	}
+
+	std::vector<Listener> latest_listeners;
+	if (published_) {
+		latest_listeners.reserve(count);
+		for (const auto& entry : entries) {
+			latest_listeners.push_back(entry.listener);
+		}
+	}
+
+	std::vector<utils::Expected<ListenHandle, v1::UStatus>> results;
+	results.reserve(count);
+	std::vector<utils::Expected<std::string, v1::UStatus>> zenoh_keys;
+	{
+		std::lock_guard lock(subscriptions_mutex_);
+		zenoh_keys = subscribe_(std::move(entries), true);
+		for (size_t i = 0; i < count; ++i) {
+			if (zenoh_keys[i]) {
+				listener_keys_.emplace(callables[i], *zenoh_keys[i]);
+				queried[i] = queried[i] &&
+				             scheduleLatestQuery_(registrations[i].sink_filter,
+				                                  *zenoh_keys[i],
+				                                  latest_listeners[i]);
+			}
+		}
+	}
+	// Failed handles are reset outside the lock, where their cleanup finds
+	// nothing to clean up
+	for (size_t i = 0; i < count; ++i) {
+		if (zenoh_keys[i]) {
+			if (queried[i]) {
+				queryLatest_(registrations[i].sink_filter, *zenoh_keys[i],
+				             std::move(latest_listeners[i]));
+			}
+			results.emplace_back(std::move(handles[i]));
+		} else {
+			results.emplace_back(
+			    utils::Unexpected<v1::UStatus>(zenoh_keys[i].error()));
+		}
+	}
+	return results;
+}
+
+utils::Expected<std::string, v1::UStatus> ZenohUTransport::subscribe_(
+    const v1::UUri& sink_filter, const v1::UUri* source_filter,
+    Listener&& listener) {
+	std::vector<NewListener> listeners;
+	listeners.push_back({sink_filter, source_filter, std::move(listener)});
+	return std::move(subscribe_(std::move(listeners), false).front());
+}
+
+std::vector<utils::Expected<std::string, v1::UStatus>>
+ZenohUTransport::subscribe_(std::vector<NewListener>&& listeners, bool merge) {
+	std::vector<utils::Expected<std::string, v1::UStatus>> results(
+	    listeners.size(), std::string());
+
+	if (!session_ &&
+	    (session_state_.load(std::memory_order_acquire) ==
+	     SessionState::FAILED)) {
+		for (auto& result : results) {
+			result = utils::Unexpected<v1::UStatus>(
+			    uError(v1::UCode::UNAVAILABLE,
+			           "The Zenoh session could not be opened"));
+		}
+		return results;
+	}
+
+	// When merging, wider filters are placed first so that the narrower
+	// ones they cover find them
+	std::vector<size_t> order(listeners.size());
+	std::iota(order.begin(), order.end(), 0);
+	if (merge) {
+		std::stable_sort(order.begin(), order.end(),
+		                 [&listeners](size_t lhs, size_t rhs) {
+			                 return wildcardCount(listeners[lhs].sink_filter) >
+			                        wildcardCount(listeners[rhs].sink_filter);
+		                 });
+	}
+
+	std::vector<std::pair<const Subscription*, Listener>> additions;
+	std::vector<Subscription*> declared;
+	for (const auto index : order) {
+		auto& [sink_filter, source_filter, listener] = listeners[index];
+		auto zenoh_key = subscriptionKey_(sink_filter, source_filter);
+		if (!zenoh_key) {
+			results[index] = utils::Unexpected<v1::UStatus>(
+			    uError(v1::UCode::INVALID_ARGUMENT,
+			           "Sink filter does not form a valid Zenoh key"));
+			continue;
+		}
+
+		// Requests to a method arrive as queries, and nothing else is sent
+		// to a method. A wildcard resource can see both requests and
+		// messages.
+		const auto resource_id = sink_filter.resource_id();
+		const bool method =
+		    (resource_id > 0) && (resource_id <= MAX_RPC_METHOD_ID);
+		const bool wants_queries =
+		    config_.rpc.queries &&
+		    (method || (resource_id == UriFilter::WILDCARD_RESOURCE_ID));
+		const bool wants_samples = !(config_.rpc.queries && method);
+		const auto reliability = reliabilityFor_(sink_filter);
+
+		Subscription* subscription = nullptr;
+		if (auto existing = subscriptions_.find(zenoh_key->key);
+		    existing != subscriptions_.end()) {
+			subscription = &existing->second;
+		} else if (merge) {
+			subscription = coveringSubscription_(sink_filter, source_filter,
+			                                     wants_samples, wants_queries,
+			                                     reliability);
+			if (subscription != nullptr) {
+				listener.sink_filter.emplace(
+				    getDefaultSource().authority_name(), sink_filter);
+			}
+		}
+		if (subscription == nullptr) {
+			const auto& authority = getDefaultSource().authority_name();
+			// Until the session is open, the subscription is only
+			// recorded, and declared once it opens
+			Subscription created{
+			    next_subscription_id_++,
+			    0,
+			    zenoh_key,
+			    UriFilter(authority, sink_filter),
+			    std::nullopt,
+			    reliability,
+			    wants_samples,
+			    wants_queries,
+			    std::nullopt,
+			    std::nullopt};
+			if (sourceInKey(config_.key_format, sink_filter, source_filter)) {
+				created.source_filter.emplace(authority, *source_filter);
+			}
+			subscription = &subscriptions_
+			                    .emplace(zenoh_key->key, std::move(created))
+			                    .first->second;
+			declared.push_back(subscription);
+		}
+
+		++subscription->listeners;
+		results[index] = subscription->zenoh_key->key;
+		additions.emplace_back(subscription, std::move(listener));
+	}
+
+	// Registered before the subscribers exist, so that no early sample
+	// finds the registry without them
+	addListeners_(std::move(additions));
+
+	if (!session_) {
+		return results;
+	}
+	for (auto* subscription : declared) {
+		auto status = declare_(*subscription);
+		if (status.code() == v1::UCode::OK) {
+			continue;
+		}
+		listeners_.update([id = subscription->id](ListenerRegistry& registry) {
+			registry.erase(id);
+		});
+		// Only the listeners added here can be on a new subscription
+		const auto zenoh_key = subscription->zenoh_key->key;
+		for (auto& result : results) {
+			if (result && (*result == zenoh_key)) {
+				result = utils::Unexpected<v1::UStatus>(status);
+			}
+		}
+		subscriptions_.erase(zenoh_key);
+	}
+	return results;
+}
+
+std::shared_ptr<const InternedKeyExpr> ZenohUTransport::subscriptionKey_(
+    const v1::UUri& sink_filter, const v1::UUri* source_filter) {
+	if (config_.key_format == TransportConfig::KeyFormat::DESTINATION) {
+		return key_exprs_.get(sink_filter);
+	}
+	if (sourceInKey(config_.key_format, sink_filter, source_filter)) {
+		return key_exprs_.get(sink_filter, *source_filter);
+	}
+	// Matches the key of the sink alone, used for published messages and
+	// by peers in the other format, as well as the sink followed by any
+	// source
+	return KeyExprTable::validate(
+	    KeyExprTable::toZenohKeyString(getDefaultSource().authority_name(),
+	                                   sink_filter) +
+	    "/**");
+}
+
+ZenohUTransport::Subscription* ZenohUTransport::coveringSubscription_(
+    const v1::UUri& sink_filter, const v1::UUri* source_filter,
+    bool wants_samples, bool wants_queries,
+    std::optional<TransportConfig::Reliability::Mode> reliability) {
+	// A wildcard field of the filter is only matched by a wildcard
+	for (auto& [zenoh_key, subscription] : subscriptions_) {
+		if ((subscription.reliability == reliability) &&
+		    (subscription.wants_samples || !wants_samples) &&
+		    (subscription.wants_queries || !wants_queries) &&
+		    subscription.sink_filter.matches(sink_filter) &&
+		    (!subscription.source_filter ||
+		     ((source_filter != nullptr) &&
+		      subscription.source_filter->matches(*source_filter)))) {
+			return &subscription;
+		}
+	}
+	return nullptr;
+}
+
+void ZenohUTransport::addListeners_(
+    std::vector<std::pair<const Subscription*, Listener>>&& additions) {
+	if (additions.empty()) {
+		return;
+	}
+	listeners_.update([this, &additions](ListenerRegistry& registry) {
+		// Each group is copied once, however many listeners join it
+		std::unordered_map<uint64_t, std::shared_ptr<ListenerGroup>> updated;
+		for (auto& [subscription, listener] : additions) {
+			auto& group = updated[subscription->id];
+			if (!group) {
+				auto& current = registry[subscription->id];
+				if (current) {
+					group = std::make_shared<ListenerGroup>(*current);
+				} else {
+					// Every message matching this sink filter goes through
+					// the same dispatch thread, which keeps them in order
+					group = std::make_shared<ListenerGroup>(ListenerGroup{
+					    subscription->sink_filter,
+					    dispatcher_ ? dispatcher_->shardFor(
+					                      subscription->zenoh_key->key)
+					                : 0,
+					    {},
+					    std::make_shared<ChunkAssembler>(
+					        config_.chunking.max_message_size,
+					        config_.chunking.max_pending_size,
+					        config_.chunking.max_pending_messages),
+					    metricsFor_(subscription->zenoh_key->key)});
+				}
+			}
+			group->listeners.push_back(std::move(listener));
+		}
+		for (auto& [id, group] : updated) {
+			registry[id] = std::move(group);
+		}
+	});
+}
+
+v1::UStatus ZenohUTransport::declare_(Subscription& subscription) {
+	const auto& zenoh_key = *subscription.zenoh_key;
+	const auto subscription_id = subscription.id;
+
+	if (subscription.wants_samples && !subscription.subscriber) {
+		zenoh::SubscriberOptions options;
+		if (subscription.reliability) {
+			options.set_reliability(
+			    toZenohReliability(*subscription.reliability));
+		}
+		auto subscriber = session_->declare_subscriber(
+		    zenoh_key.expr.as_keyexpr_view(),
+		    [this, subscription_id](const zenoh::Sample& sample) {
+			    onSample_(subscription_id, sample);
+		    },
+		    options);
+		if (auto* error = std::get_if<zenoh::ErrorMessage>(&subscriber)) {
+			spdlog::error("Failed to subscribe to '{}': {}", zenoh_key.key,
+			              error->as_string_view());
+			return uError(v1::UCode::INTERNAL,
+			              "Failed to declare subscriber");
+		}
+		subscription.subscriber.emplace(
+		    std::move(std::get<zenoh::Subscriber>(subscriber)));
+	}
+
+	if (subscription.wants_queries && !subscription.queryable) {
+		auto queryable = session_->declare_queryable(
+		    zenoh_key.expr.as_keyexpr_view(),
+		    [this, subscription_id](const zenoh::Query& query) {
+			    onQuery_(subscription_id, query);
+		    });
+		if (auto* error = std::get_if<zenoh::ErrorMessage>(&queryable)) {
+			spdlog::error("Failed to declare queryable on '{}': {}",
+			              zenoh_key.key, error->as_string_view());
+			return uError(v1::UCode::INTERNAL,
+			              "Failed to declare queryable");
+		}
+		subscription.queryable.emplace(
+		    std::move(std::get<zenoh::Queryable>(queryable)));
+	}
+
+	return uError(v1::UCode::OK, "");
+}
+
+std::shared_ptr<const ZenohUTransport::ListenerGroup>
+ZenohUTransport::getListeners_(uint64_t subscription_id) const {
+	return listeners_.read(
+	    [subscription_id](const ListenerRegistry& registry)
+	        -> std::shared_ptr<const ListenerGroup> {
+		    auto found = registry.find(subscription_id);
+		    return (found == registry.end()) ? nullptr : found->second;
+	    });
+}
+
+void ZenohUTransport::onSample_(uint64_t subscription_id,
+                                const zenoh::Sample& sample) {
+	UP_TRANSPORT_ZENOH_TRACE(RECEIVE);
+	// Already handed over by loopBack_() when it was sent
+	if (loopback_ && (looped_back_bus == loopback_.get())) {
+		return;
+	}
+	auto listeners = getListeners_(subscription_id);
+	if (!listeners) {
+		// Cleaned up while Zenoh was still delivering to its subscriber
+		return;
+	}
+
+	auto* metrics = listeners->metrics.get();
+	std::chrono::steady_clock::time_point start;
+	if (metrics != nullptr) {
+		start = std::chrono::steady_clock::now();
+		metrics->add(TopicMetrics::Counter::MESSAGES_RECEIVED);
+		metrics->add(TopicMetrics::Counter::BYTES_RECEIVED,
+		             sample.get_payload().get_len());
+	}
+
+	auto received = newMessage_();
+	auto& attributes = *received.message->mutable_attributes();
+	PayloadFormat format;
+	if (!sampleToUAttributes(sample, attributes, &format)) {
+		countDrop(metrics);
+		return;
+	}
+	// Dropped before its payload is copied or decompressed, let alone
+	// handed to listeners that would discard it
+	if (isExpired(attributes)) {
+		countExpired(metrics);
+		return;
+	}
+
+	// Filters only look at the attributes, so a sample no listener wants
+	// is dropped before its payload is copied
+	if (!listeners->accepts(attributes)) {
+		return;
+	}
+
+	// Decoded once, however many listeners share the subscription, and
+	// handed to every one of them as the same immutable message
+	if (!setPayload_(*received.message, sample.get_payload(),
+	                 format.compression)) {
+		countDrop(metrics);
+		return;
+	}
+	if (metrics != nullptr) {
+		metrics->record(TopicMetrics::Timer::DECODE,
+		                std::chrono::steady_clock::now() - start);
+	}
+
+	if (format.chunk) {
+		received.chunk = format.chunk;
+		onChunk_(std::move(listeners), std::move(received));
+		return;
+	}
+	cacheLatest_(received);
+	dispatch_(std::move(listeners), received);
+}
+
+bool ZenohUTransport::setPayload_(
+    v1::UMessage& message, const zenoh::BytesView& payload,
+    const std::optional<Compression::Header>& compression) const {
+	if (!compression) {
+		setPayload(message, payload);
+		return true;
+	}
+
+	UP_TRANSPORT_ZENOH_TRACE(DECODE);
+	if (compression->size > config_.compression.max_decompressed_size) {
+		spdlog::warn("Dropping message of {} bytes once decompressed, above "
+		             "the limit of {}",
+		             compression->size,
+		             config_.compression.max_decompressed_size);
+		return false;
+	}
+	// Decompressed straight into the message, which is the only copy made
+	if (!Compression::decompress(compression->codec, payload.as_string_view(),
+	                             compression->size,
+	                             *message.mutable_payload())) {
+		spdlog::error("Failed to decompress a payload (codec {})",
+		              static_cast<int>(compression->codec));
+		return false;
+	}
+	return true;
+}
+
+void ZenohUTransport::onChunk_(std::shared_ptr<const ListenerGroup> listeners,
+                               ReceivedMessage&& received) {
+	const auto& message = *received.message;
+	const auto& attributes = message.attributes();
+
+	std::optional<std::string> whole;
+	if (listeners->accepts(attributes, false)) {
+		bool dropped = false;
+		whole = listeners->assembler->add(
+		    attributes.id(), *received.chunk, message.payload(),
+		    messageExpiry(std::chrono::steady_clock::now(), attributes.ttl()),
+		    &dropped);
+		if (dropped) {
+			countDrop(listeners->metrics.get());
+		}
+	}
+
+	if (listeners->accepts(attributes, true)) {
+		dispatch_(listeners, received);
+	}
+
+	if (whole) {
+		auto assembled = newMessage_();
+		*assembled.message->mutable_attributes() = attributes;
+		assembled.message->set_payload(std::move(*whole));
+		assembled.reassembled = true;
+		cacheLatest_(assembled);
+		dispatch_(std::move(listeners), assembled);
+	}
+}
+
+void ZenohUTransport::onQuery_(uint64_t subscription_id,
+                               const zenoh::Query& query) {
+	UP_TRANSPORT_ZENOH_TRACE(RECEIVE);
+	auto listeners = getListeners_(subscription_id);
+	if (!listeners) {
+		return;
+	}
+
+	auto* metrics = listeners->metrics.get();
+	if (metrics != nullptr) {
+		metrics->add(TopicMetrics::Counter::MESSAGES_RECEIVED);
+		metrics->add(TopicMetrics::Counter::BYTES_RECEIVED,
+		             query.get_value().get_payload().get_len());
+	}
+
+	auto attachment = query.get_attachment();
+	if (!attachment.check()) {
+		// Meant for the queryables of published topics
+		if (query.get_parameters() == LATEST_QUERY_PARAMETERS) {
+			return;
+		}
+		spdlog::error("Query on '{}' has no attachment",
+		              query.get_keyexpr().as_string_view());
+		countDrop(metrics);
+		return;
+	}
+	auto received = newMessage_();
+	auto& attributes = *received.message->mutable_attributes();
+	if (!attachmentToUAttributes(attachment, attributes)) {
+		spdlog::error("Failed to decode the attributes of a query on '{}'",
+		              query.get_keyexpr().as_string_view());
+		countDrop(metrics);
+		return;
+	}
+	if (attributes.type() != v1::UMessageType::UMESSAGE_TYPE_REQUEST) {
+		spdlog::error("Query on '{}' does not carry a request",
+		              query.get_keyexpr().as_string_view());
+		countDrop(metrics);
+		return;
+	}
+	// Its caller has stopped waiting for the reply
+	if (isExpired(attributes)) {
+		countExpired(metrics);
+		return;
+	}
+	if (!listeners->accepts(attributes)) {
+		return;
+	}
+
+	// Kept before delivery, since the listener may respond from within
+	// its callback
+	const auto now = std::chrono::steady_clock::now();
+	std::vector<zenoh::OwnedQuery> expired;
+	{
+		std::lock_guard lock(pending_queries_mutex_);
+		expired = pending_queries_.expire(now);
+		pending_queries_.insert(attributes.id(), zenoh::query_clone(query),
+		                        messageExpiry(now, attributes.ttl()));
+	}
+	// Expired queries are dropped here, outside the lock, which ends them
+	// for their callers
+	expired.clear();
+
+	setPayload(*received.message, query.get_value().get_payload());
+	dispatch_(std::move(listeners), received);
+}
+
+void ZenohUTransport::onReply_(zenoh::Reply&& reply) {
+	UP_TRANSPORT_ZENOH_TRACE(RECEIVE);
+	auto result = reply.get();
+	auto* sample = std::get_if<zenoh::Sample>(&result);
+	if (sample == nullptr) {
+		spdlog::debug(
+		    "Query failed: {}",
+		    std::get<zenoh::ErrorMessage>(result).as_string_view());
+		return;
+	}
+
+	auto received = newMessage_();
+	auto& attributes = *received.message->mutable_attributes();
+	if (!sampleToUAttributes(*sample, attributes)) {
+		return;
+	}
+
+	// Only the first reply to a request is delivered, and only until the
+	// request expires
+	std::optional<std::chrono::steady_clock::time_point> sent;
+	{
+		std::lock_guard lock(outstanding_requests_mutex_);
+		sent = outstanding_requests_.take(attributes.reqid());
+	}
+	if (!sent) {
+		spdlog::debug("Dropping reply on '{}' to an expired or answered "
+		              "request",
+		              sample->get_keyexpr().as_string_view());
+		return;
+	}
+	spdlog::trace("Reply on '{}' after {} us",
+	              sample->get_keyexpr().as_string_view(),
+	              std::chrono::duration_cast<std::chrono::microseconds>(
+	                  std::chrono::steady_clock::now() - *sent)
+	                  .count());
+
+	// A reply comes back on the method key, so the response is routed by
+	// its sink to every listener group whose sink filter matches it
+	auto groups = listeners_.read([&attributes](
+	                                  const ListenerRegistry& registry) {
+		std::vector<std::shared_ptr<const ListenerGroup>> matching;
+		for (const auto& [id, group] : registry) {
+			if (group->sink_filter.matches(attributes.sink()) &&
+			    group->accepts(attributes)) {
+				matching.push_back(group);
+			}
+		}
+		return matching;
+	});
+	if (groups.empty()) {
+		return;
+	}
+
+	setPayload(*received.message, sample->get_payload());
+	for (auto& group : groups) {
+		if (auto* metrics = group->metrics.get()) {
+			metrics->add(TopicMetrics::Counter::MESSAGES_RECEIVED);
+			metrics->add(TopicMetrics::Counter::BYTES_RECEIVED,
+			             received.message->payload().size());
+		}
+		dispatch_(std::move(group), received);
+	}
+}
+
+void ZenohUTransport::joinLoopback_() {
+	// Every member holds the session as well, so a session is never freed,
+	// and its address reused, while its bus is still registered
+	static SharedRegistry<const zenoh::Session*, LoopbackBus> buses;
+	loopback_ = buses.acquire(session_.get(),
+	                          []() { return std::make_shared<LoopbackBus>(); });
+	loopback_->members.update(
+	    [this](auto& members) { members.push_back(callback_guard_); });
+}
+
+void ZenohUTransport::loopBack_(const v1::UMessage& message) {
+	if (!loopback_ || isQueryMessage_(message.attributes())) {
+		return;
+	}
+
+	// One copy is shared by every local listener, made once the first one
+	// wants the message. Callbacks that would run on this thread are run
+	// last, once the bus and the other transports are no longer held.
+	ReceivedMessage received{{}, nullptr};
+	std::vector<std::shared_ptr<const ListenerGroup>> run_here;
+	loopback_->members.read([this, &message, &received, &run_here](
+	                            const auto& members) {
+		for (const auto& guard : members) {
+			// The guard of this transport is not taken, since this may
+			// run in one of its callbacks that holds it already
+			std::shared_lock<std::shared_mutex> lock;
+			if (guard != callback_guard_) {
+				lock = std::shared_lock(guard->mutex);
+			}
+			auto* member = guard->transport;
+			if (member == nullptr) {
+				continue;
+			}
+			auto groups = member->loopbackGroups_(message.attributes());
+			if (groups.empty()) {
+				continue;
+			}
+			if (!received.owned) {
+				received.owned = std::make_shared<v1::UMessage>(message);
+				received.message = received.owned.get();
+			}
+			member->cacheLatest_(received);
+			for (auto& group : groups) {
+				if (auto* metrics = group->metrics.get()) {
+					metrics->add(TopicMetrics::Counter::MESSAGES_RECEIVED);
+					metrics->add(TopicMetrics::Counter::BYTES_RECEIVED,
+					             message.payload().size());
+				}
+				if (member->dispatcher_) {
+					member->dispatch_(std::move(group), received);
+				} else {
+					run_here.push_back(std::move(group));
+				}
+			}
+		}
+	});
+	for (const auto& group : run_here) {
+		deliver_(*group, received);
+	}
+}
+
+std::vector<std::shared_ptr<const ZenohUTransport::ListenerGroup>>
+ZenohUTransport::loopbackGroups_(const v1::UAttributes& attributes) const {
+	const auto& destination =
+	    attributes.has_sink() ? attributes.sink() : attributes.source();
+	return listeners_.read([&destination, &attributes](
+	                           const ListenerRegistry& registry) {
+		std::vector<std::shared_ptr<const ListenerGroup>> matching;
+		for (const auto& [id, group] : registry) {
+			if (group->sink_filter.matches(destination) &&
+			    group->accepts(attributes)) {
+				matching.push_back(group);
+			}
+		}
+		return matching;
+	});
+}
+
+void ZenohUTransport::cacheLatest_(const ReceivedMessage& received) {
+	const auto& attributes = received.message->attributes();
+	if (!latest_ ||
+	    (attributes.type() != v1::UMessageType::UMESSAGE_TYPE_PUBLISH)) {
+		return;
+	}
+	auto zenoh_key = key_exprs_.get(attributes.source());
+	if (!zenoh_key) {
+		return;
+	}
+	// Copied off the arena, which is recycled once the listeners are done
+	latest_->add(zenoh_key->key,
+	             received.owned
+	                 ? received.owned
+	                 : std::make_shared<v1::UMessage>(*received.message));
+}
+
+void ZenohUTransport::cachePublished_(const v1::UMessage& message,
+                                      const InternedKeyExpr& zenoh_key) {
+	if (!published_ || (message.attributes().type() !=
+	                    v1::UMessageType::UMESSAGE_TYPE_PUBLISH)) {
+		return;
+	}
+	if (!published_->add(zenoh_key.key,
+	                     std::make_shared<v1::UMessage>(message))) {
+		return;
+	}
+
+	// First message on the topic. The queryable keeps its own copy of the
+	// key, since the interned one may be evicted from key_exprs_.
+	auto topic_key = KeyExprTable::validate(zenoh_key.key);
+	auto queryable = session_->declare_queryable(
+	    topic_key->expr.as_keyexpr_view(),
+	    [this, topic_key](const zenoh::Query& query) {
+		    onLatestQuery_(*topic_key, query);
+	    });
+	if (auto* error = std::get_if<zenoh::ErrorMessage>(&queryable)) {
+		spdlog::error("Failed to declare queryable on '{}': {}",
+		              zenoh_key.key, error->as_string_view());
+		return;
+	}
+	std::lock_guard lock(published_queryables_mutex_);
+	published_queryables_.push_back(
+	    std::move(std::get<zenoh::Queryable>(queryable)));
+}
+
+void ZenohUTransport::onLatestQuery_(const InternedKeyExpr& zenoh_key,
+                                     const zenoh::Query& query) {
+	// RPC requests are never sent to a topic, but a wildcard query may
+	// still reach it
+	if (query.get_attachment().check()) {
+		return;
+	}
+	for (const auto& message : published_->get(zenoh_key.key)) {
+		const auto attachment = uattributesToAttachment(
+		    message->attributes(), config_.attributes_encoding);
+		const auto& payload = message->payload();
+
+		zenoh::QueryReplyOptions options;
+		options.set_encoding(zenoh::Encoding(Z_ENCODING_PREFIX_APP_CUSTOM));
+		options.set_attachment(attachment);
+
+		zenoh::ErrNo error = 0;
+		if (!query.reply(zenoh_key.expr.as_keyexpr_view(),
+		                 zenoh::BytesView(payload.data(), payload.size()),
+		                 options, error)) {
+			spdlog::error("Failed to reply to query on '{}' (error {})",
+			              zenoh_key.key, error);
+			return;
+		}
+	}
+}
+
+bool ZenohUTransport::trackLatestReplies_(const v1::UUri& sink_filter,
+                                          Listener& listener) const {
+	// A sink filter on a method or on resource 0 never matches a topic
+	if (!published_ || (sink_filter.resource_id() <= MAX_RPC_METHOD_ID)) {
+		return false;
+	}
+	listener.latest_replies = std::make_shared<LatestReplies>();
+	return true;
+}
+
+bool ZenohUTransport::scheduleLatestQuery_(const v1::UUri& sink_filter,
+                                           const std::string& subscription_key,
+                                           const Listener& listener) {
+	if (session_) {
+		return true;
+	}
+	if (session_state_.load(std::memory_order_acquire) ==
+	    SessionState::FAILED) {
+		listener.latest_replies->finish();
+		return false;
+	}
+	deferred_latest_queries_.push_back(
+	    LatestQuery{sink_filter, subscription_key, listener});
+	return false;
+}
+
+void ZenohUTransport::queryLatest_(const v1::UUri& sink_filter,
+                                   const std::string& subscription_key,
+                                   Listener listener) {
+	auto replies = listener.latest_replies;
+	// Topics are published on the key of their source alone, whatever the
+	// key format
+	auto zenoh_key = KeyExprTable::validate(KeyExprTable::toZenohKeyString(
+	    getDefaultSource().authority_name(), sink_filter));
+	if (!zenoh_key) {
+		replies->finish();
+		return;
+	}
+
+	// Delivered through the dispatch thread of the subscription, which runs
+	// them in turn with the live messages, so that each one is checked
+	// against the live messages delivered before it
+	const auto shard =
+	    dispatcher_ ? dispatcher_->shardFor(subscription_key) : 0;
+	auto on_reply = [guard = callback_guard_, listener = std::move(listener),
+	                 shard, metrics = metricsFor_(subscription_key)](
+	                    zenoh::Reply&& reply) {
+		std::shared_lock lock(guard->mutex);
+		if (guard->transport != nullptr) {
+			guard->transport->onLatestReply_(listener, shard, metrics,
+			                                 std::move(reply));
+		}
+	};
+	// Queued behind the replies on the dispatch thread, if any
+	auto on_done = [guard = callback_guard_, replies, shard]() {
+		std::shared_lock lock(guard->mutex);
+		auto* transport = guard->transport;
+		if ((transport != nullptr) && transport->dispatcher_) {
+			transport->dispatcher_->post(shard,
+			                             [replies]() { replies->finish(); });
+		} else {
+			replies->finish();
+		}
+	};
+
+	zenoh::GetOptions options;
+	options.set_target(Z_QUERY_TARGET_ALL);
+	zenoh::ErrNo error = 0;
+	if (!session_->get(zenoh_key->expr.as_keyexpr_view(),
+	                   LATEST_QUERY_PARAMETERS, std::move(on_reply),
+	                   std::move(on_done), options, error)) {
+		spdlog::error("Failed to query '{}' (error {})", zenoh_key->key,
+		              error);
+		replies->finish();
+	}
+}
+
+void ZenohUTransport::onLatestReply_(const Listener& listener, size_t shard,
+                                     std::shared_ptr<TopicMetrics> metrics,
+                                     zenoh::Reply&& reply) {
+	auto result = reply.get();
+	auto* sample = std::get_if<zenoh::Sample>(&result);
+	if (sample == nullptr) {
+		return;
+	}
+
+	auto received = newMessage_();
+	auto& attributes = *received.message->mutable_attributes();
+	PayloadFormat format;
+	if (!sampleToUAttributes(*sample, attributes, &format) || format.chunk ||
+	    (attributes.type() != v1::UMessageType::UMESSAGE_TYPE_PUBLISH) ||
+	    isExpired(attributes) || !listener.accepts(attributes) ||
+	    !setPayload_(*received.message, sample->get_payload(),
+	                 format.compression)) {
+		return;
+	}
+	cacheLatest_(received);
+
+	// Skipped if the listener already got it live, or something newer
+	auto deliver = [listener, received, metrics = std::move(metrics)]() {
+		const auto& message = *received.message;
+		if (!listener.latest_replies->admit(message.attributes(), true)) {
+			return;
+		}
+		auto callback = listener.callback;
+		runCallback(metrics.get(),
+		            [&callback, &message]() { callback(message); });
+	};
+	if (dispatcher_) {
+		dispatcher_->post(shard, std::move(deliver));
+	} else {
+		deliver();
+	}
+}
+
+void ZenohUTransport::dispatch_(std::shared_ptr<const ListenerGroup> listeners,
+                                const ReceivedMessage& received) {
+	if (!dispatcher_) {
+		deliver_(*listeners, received);
+		return;
+	}
+	// The task shares the arena lease, so the arena is only recycled once
+	// every dispatch thread is done with the message
+	const auto shard = listeners->shard;
+	dispatcher_->post(shard, [listeners = std::move(listeners), received]() {
+		// It may have expired while waiting behind a backlog
+		if (isExpired(received.message->attributes())) {
+			countExpired(listeners->metrics.get());
+			return;
+		}
+		deliver_(*listeners, received);
+	});
+}
+
+bool ZenohUTransport::ListenerGroup::accepts(
+    const v1::UAttributes& attributes) const {
+	return std::any_of(listeners.begin(), listeners.end(),
+	                   [&attributes](const Listener& listener) {
+		                   return listener.accepts(attributes);
+	                   });
+}
+
+bool ZenohUTransport::ListenerGroup::accepts(
+    const v1::UAttributes& attributes, bool chunks) const {
+	return std::any_of(listeners.begin(), listeners.end(),
+	                   [&attributes, chunks](const Listener& listener) {
+		                   return (listener.wants_chunks == chunks) &&
+		                          listener.accepts(attributes);
+	                   });
+}
+
+bool ZenohUTransport::LatestReplies::admit(
+    const v1::UAttributes& attributes, bool reply) {
+	std::lock_guard lock(mutex);
+	if (done) {
+		return true;
+	}
+	auto topic =
+	    std::find_if(topics.begin(), topics.end(), [&attributes](auto& seen) {
+		    return sameTopic(seen.source, attributes.source());
+	    });
+	if (topic == topics.end()) {
+		topic = topics.insert(topics.end(), Topic{attributes.source(), {}, {}});
+	}
+
+	const auto created = createdAt(attributes.id());
+	if (reply) {
+		const auto delivered =
+		    std::any_of(topic->ids.begin(), topic->ids.end(),
+		                [&attributes](const v1::UUID& id) {
+			                return (id.msb() == attributes.id().msb()) &&
+			                       (id.lsb() == attributes.id().lsb());
+		                });
+		if (delivered ||
+		    (created && topic->newest && (*created <= *topic->newest))) {
+			return false;
+		}
+	}
+	topic->ids.push_back(attributes.id());
+	if (created && (!topic->newest || (*created > *topic->newest))) {
+		topic->newest = created;
+	}
+	return true;
+}
+
+void ZenohUTransport::LatestReplies::finish() {
+	std::lock_guard lock(mutex);
+	topics.clear();
+	done = true;
+}
+
+bool ZenohUTransport::Listener::accepts(
+    const v1::UAttributes& attributes) const {
+	UP_TRANSPORT_ZENOH_TRACE(FILTER);
+	if (sink_filter &&
+	    !sink_filter->matches(attributes.has_sink() ? attributes.sink()
+	                                                : attributes.source())) {
+		return false;
+	}
+	return !source_filter || source_filter->matches(attributes.source());
+}
+
+void ZenohUTransport::deliver_(const ListenerGroup& listeners,
+                               const ReceivedMessage& received) {
+	const auto& message = *received.message;
+	auto* metrics = listeners.metrics.get();
+	for (const auto& listener : listeners.listeners) {
+		if (!listener.accepts(message.attributes())) {
+			continue;
+		}
+		if (!listener.wants_chunks) {
+			// Message listeners only see the reassembled payload
+			if (!received.chunk) {
+				if (listener.latest_replies &&
+				    !listener.latest_replies->done.load(
+				        std::memory_order_acquire)) {
+					listener.latest_replies->admit(message.attributes(),
+					                               false);
+				}
+				auto callback = listener.callback;
+				runCallback(metrics, [&callback, &message]() {
+					callback(message);
+				});
+			}
+			continue;
+		}
+		if (received.reassembled) {
+			// Already handed each chunk of it
+			continue;
+		}
+		auto callback = listener.chunk_callback.lock();
+		if (!callback) {
+			continue;
+		}
+		if (received.chunk) {
+			runCallback(metrics, [&callback, &message, &received]() {
+				(*callback)(MessageChunk{message, *received.chunk});
+			});
+		} else {
+			ChunkHeader whole;
+			whole.total_size = message.payload().size();
+			runCallback(metrics, [&callback, &message, &whole]() {
+				(*callback)(MessageChunk{message, whole});
+			});
+		}
+	}
+}
+
+void ZenohUTransport::cleanupListener(CallableConn listener) {
+	std::lock_guard lock(subscriptions_mutex_);
+	auto registered = listener_keys_.find(listener);
+	if (registered == listener_keys_.end()) {
+		return;
+	}
+	const auto zenoh_key = std::move(registered->second);
+	listener_keys_.erase(registered);
+	unsubscribe_(zenoh_key, [&listener](const Listener& entry) {
+		return !entry.wants_chunks && (entry.callback == listener);
+	});
+}
+
+void ZenohUTransport::cleanupChunkListener_(const ChunkCallback* callback) {
+	std::lock_guard lock(subscriptions_mutex_);
+	auto registered = chunk_listener_keys_.find(callback);
+	if (registered == chunk_listener_keys_.end()) {
+		return;
+	}
+	const auto zenoh_key = std::move(registered->second);
+	chunk_listener_keys_.erase(registered);
+	unsubscribe_(zenoh_key, [callback](const Listener& entry) {
+		return entry.wants_chunks &&
+		       (entry.chunk_callback.lock().get() == callback);
+	});
+}
+
+void ZenohUTransport::cleanupMatchingListener_(
+    const std::string& zenoh_key, const MatchingCallback* callback) {
+	std::shared_ptr<MatchingWatch> unused;
+	{
+		std::lock_guard lock(matching_mutex_);
+		auto watch = matching_.find(zenoh_key);
+		if (watch == matching_.end()) {
+			return;
+		}
+		bool empty = false;
+		watch->second->callbacks.update([callback, &empty](auto& callbacks) {
+			callbacks.erase(
+			    std::remove_if(callbacks.begin(), callbacks.end(),
+			                   [callback](const auto& registered) {
+				                   return registered.get() == callback;
+			                   }),
+			    callbacks.end());
+			empty = callbacks.empty();
+		});
+		if (empty) {
+			unused = std::move(watch->second);
+			matching_.erase(watch);
+		}
+	}
+	// Undeclared outside the lock, since Zenoh may wait for a status
+	// callback still running
+	unused.reset();
+}
+
+void ZenohUTransport::unsubscribe_(
+    const std::string& zenoh_key,
+    const std::function<bool(const Listener&)>& matches) {
+	auto subscription = subscriptions_.find(zenoh_key);
+
+	// Removing the listener first stops delivery right away, even for
+	// samples Zenoh is delivering while the subscriber is undeclared
+	const auto subscription_id = subscription->second.id;
+	const bool last = (--subscription->second.listeners == 0);
+	listeners_.update(
+	    [subscription_id, &matches, last](ListenerRegistry& registry) {
+		    if (last) {
+			    registry.erase(subscription_id);
+			    return;
+		    }
+		    auto& group = registry[subscription_id];
+		    auto updated = std::make_shared<ListenerGroup>(
+		        ListenerGroup{group->sink_filter, group->shard, {},
+		                      group->assembler, group->metrics});
+		    bool removed = false;
+		    for (const auto& entry : group->listeners) {
+			    if (!removed && matches(entry)) {
+				    removed = true;
+				    continue;
+			    }
+			    updated->listeners.push_back(entry);
+		    }
+		    group = std::move(updated);
+	    });
+
+	if (last) {
+		subscriptions_.erase(subscription);
+	}
+}
+
+ZenohUTransport::ChunkListenerHandle::ChunkListenerHandle(
+    ChunkListenerHandle&& other) noexcept
+    : transport_(std::exchange(other.transport_, nullptr)),
+      callback_(std::move(other.callback_)) {}
+
+ZenohUTransport::ChunkListenerHandle&
+ZenohUTransport::ChunkListenerHandle::operator=(
+    ChunkListenerHandle&& other) noexcept {
+	if (this != &other) {
+		reset();
+		transport_ = std::exchange(other.transport_, nullptr);
+		callback_ = std::move(other.callback_);
+	}
+	return *this;
+}
+
+ZenohUTransport::ChunkListenerHandle::~ChunkListenerHandle() { reset(); }
+
+void ZenohUTransport::ChunkListenerHandle::reset() {
+	if (callback_) {
+		transport_->cleanupChunkListener_(callback_.get());
+		// Deliveries already queued find the weak reference expired
+		callback_.reset();
+		transport_ = nullptr;
+	}
+}
+
+size_t ZenohUTransport::PullSubscription::receive(
+    v1::UMessage* messages, size_t count,
+    std::chrono::milliseconds timeout) {
+	if (!ring_) {
+		return 0;
+	}
+	return ring_->pop(messages, count, timeout);
+}
+
+size_t ZenohUTransport::PullSubscription::pending() const {
+	return ring_ ? ring_->size() : 0;
+}
+
+uint64_t ZenohUTransport::PullSubscription::dropped() const {
+	return ring_ ? ring_->dropped() : 0;
+}
+
+ZenohUTransport::MatchingHandle::MatchingHandle(
+    MatchingHandle&& other) noexcept
+    : transport_(std::exchange(other.transport_, nullptr)),
+      zenoh_key_(std::move(other.zenoh_key_)),
+      callback_(std::move(other.callback_)) {}
+
+ZenohUTransport::MatchingHandle& ZenohUTransport::MatchingHandle::operator=(
+    MatchingHandle&& other) noexcept {
+	if (this != &other) {
+		reset();
+		transport_ = std::exchange(other.transport_, nullptr);
+		zenoh_key_ = std::move(other.zenoh_key_);
+		callback_ = std::move(other.callback_);
+	}
+	return *this;
+}
+
+ZenohUTransport::MatchingHandle::~MatchingHandle() { reset(); }
+
+void ZenohUTransport::MatchingHandle::reset() {
+	if (callback_) {
+		transport_->cleanupMatchingListener_(zenoh_key_, callback_.get());
+		callback_.reset();
+		transport_ = nullptr;
+	}
+}
+
+void ZenohUTransport::PullSubscription::reset() {
+	handle_.reset();
+	// Deliveries already queued still hold a reference to the ring
+	ring_.reset();
+}
+
+}  // namespace uprotocol::transport
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/ArenaPool.h>
+#include <uprotocol/v1/umessage.pb.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using uprotocol::transport::ArenaPool;
+
+class ArenaPoolTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	ArenaPoolTest() = default;
+	~ArenaPoolTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(ArenaPoolTest, ReusesArenas) {
+	ArenaPool pool(2, 4096);
+	EXPECT_EQ(pool.available(), 2);
+
+	google::protobuf::Arena* first = nullptr;
+	{
+		auto lease = pool.acquire();
+		ASSERT_TRUE(lease);
+		first = lease.get();
+		EXPECT_EQ(pool.available(), 1);
+	}
+	EXPECT_EQ(pool.available(), 2);
+
+	// The released arena went back to the pool
+	auto second = pool.acquire();
+	auto third = pool.acquire();
+	EXPECT_TRUE((second.get() == first) || (third.get() == first));
+}
+
+TEST_F(ArenaPoolTest, ResetOnRelease) {
+	ArenaPool pool(1, 4096);
+	{
+		auto lease = pool.acquire();
+		auto* message = google::protobuf::Arena::CreateMessage<
+		    uprotocol::v1::UMessage>(lease.get());
+		message->set_payload(std::string(100, 'x'));
+		EXPECT_GT(lease.get()->SpaceUsed(), 0);
+	}
+	auto lease = pool.acquire();
+	EXPECT_EQ(lease.get()->SpaceUsed(), 0);
+}
+
+TEST_F(ArenaPoolTest, CopiesShareLease) {
+	ArenaPool pool(1, 4096);
+	auto lease = pool.acquire();
+	auto copy = lease;
+	EXPECT_EQ(copy.get(), lease.get());
+
+	lease = ArenaPool::Lease();
+	EXPECT_EQ(pool.available(), 0);
+	copy = ArenaPool::Lease();
+	EXPECT_EQ(pool.available(), 1);
+}
+
+TEST_F(ArenaPoolTest, FallsBackWhenExhausted) {
+	ArenaPool pool(1, 4096);
+	auto pooled = pool.acquire();
+	auto extra = pool.acquire();
+	ASSERT_TRUE(extra);
+	EXPECT_NE(extra.get(), pooled.get());
+
+	// The extra arena is freed rather than pooled
+	extra = ArenaPool::Lease();
+	EXPECT_EQ(pool.available(), 0);
+}
+
+TEST_F(ArenaPoolTest, NoPooling) {
+	ArenaPool pool(0, 4096);
+	EXPECT_EQ(pool.available(), 0);
+	auto lease = pool.acquire();
+	ASSERT_TRUE(lease);
+	EXPECT_NE(lease.get(), nullptr);
+}
+
+}  // namespace
@@ -0,0 +1,180 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/AsyncSender.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace uprotocol;
+using namespace std::chrono_literals;
+using transport::AsyncSender;
+using Overflow = transport::TransportConfig::AsyncSend::Overflow;
+
+// Publish callback that can hold the I/O thread until released, so tests
+// can fill the queue deterministically
+class Gate {
+public:
+	AsyncSender::Publish publish() {
+		return [this](const AsyncSender::Item& item) {
+			std::unique_lock lock(mutex_);
+			++blocked_;
+			cv_.notify_all();
+			cv_.wait(lock, [this]() { return open_; });
+			published_.push_back(item.message.payload());
+			cv_.notify_all();
+		};
+	}
+
+	// Waits until the I/O thread is holding an item
+	void waitBlocked() {
+		std::unique_lock lock(mutex_);
+		cv_.wait(lock, [this]() { return blocked_ > 0; });
+	}
+
+	void open() {
+		std::lock_guard lock(mutex_);
+		open_ = true;
+		cv_.notify_all();
+	}
+
+	std::vector<std::string> published() {
+		std::lock_guard lock(mutex_);
+		return published_;
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	bool open_{false};
+	size_t blocked_{0};
+	std::vector<std::string> published_;
+};
+
+AsyncSender::Item makeItem(const std::string& payload) {
+	AsyncSender::Item item;
+	item.message.set_payload(payload);
+	return item;
+}
+
+transport::TransportConfig::AsyncSend makeConfig(Overflow overflow) {
+	transport::TransportConfig::AsyncSend config;
+	config.enabled = true;
+	config.queue_capacity = 2;
+	config.overflow = overflow;
+	return config;
+}
+
+class AsyncSenderTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	AsyncSenderTest() = default;
+	~AsyncSenderTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(AsyncSenderTest, PublishesInOrder) {
+	Gate gate;
+	gate.open();
+	{
+		AsyncSender sender(makeConfig(Overflow::BLOCK), gate.publish());
+		for (int i = 0; i < 100; ++i) {
+			EXPECT_TRUE(sender.submit(makeItem(std::to_string(i))));
+		}
+	}
+
+	const auto published = gate.published();
+	ASSERT_EQ(published.size(), 100);
+	for (int i = 0; i < 100; ++i) {
+		EXPECT_EQ(published[i], std::to_string(i));
+	}
+}
+
+TEST_F(AsyncSenderTest, FailFast) {
+	Gate gate;
+	AsyncSender sender(makeConfig(Overflow::FAIL_FAST), gate.publish());
+
+	EXPECT_TRUE(sender.submit(makeItem("held")));
+	gate.waitBlocked();
+	EXPECT_TRUE(sender.submit(makeItem("a")));
+	EXPECT_TRUE(sender.submit(makeItem("b")));
+	EXPECT_FALSE(sender.submit(makeItem("c")));
+
+	auto stats = sender.stats();
+	EXPECT_EQ(stats.queued, 2);
+	EXPECT_EQ(stats.rejected, 1);
+	EXPECT_EQ(stats.dropped, 0);
+	EXPECT_EQ(stats.capacity, 2);
+
+	gate.open();
+}
+
+TEST_F(AsyncSenderTest, DropOldest) {
+	Gate gate;
+	{
+		AsyncSender sender(makeConfig(Overflow::DROP_OLDEST), gate.publish());
+
+		EXPECT_TRUE(sender.submit(makeItem("held")));
+		gate.waitBlocked();
+		for (const auto* payload : {"a", "b", "c", "d"}) {
+			EXPECT_TRUE(sender.submit(makeItem(payload)));
+		}
+		EXPECT_EQ(sender.stats().dropped, 2);
+
+		gate.open();
+	}
+
+	EXPECT_EQ(gate.published(),
+	          (std::vector<std::string>{"held", "c", "d"}));
+}
+
+TEST_F(AsyncSenderTest, BlockWaitsForSpace) {
+	Gate gate;
+	{
+		AsyncSender sender(makeConfig(Overflow::BLOCK), gate.publish());
+
+		EXPECT_TRUE(sender.submit(makeItem("held")));
+		gate.waitBlocked();
+		EXPECT_TRUE(sender.submit(makeItem("a")));
+		EXPECT_TRUE(sender.submit(makeItem("b")));
+
+		std::thread opener([&gate]() {
+			std::this_thread::sleep_for(50ms);
+			gate.open();
+		});
+		const auto start = std::chrono::steady_clock::now();
+		EXPECT_TRUE(sender.submit(makeItem("c")));
+		EXPECT_GE(std::chrono::steady_clock::now() - start, 40ms);
+		opener.join();
+	}
+
+	EXPECT_EQ(gate.published(),
+	          (std::vector<std::string>{"held", "a", "b", "c"}));
+}
+
+}  // namespace
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/AttributesCodec.h>
+
+namespace {
+
+using uprotocol::transport::AttributesCodec;
+using namespace uprotocol;
+
+constexpr auto PROTOBUF = AttributesCodec::Format::PROTOBUF;
+constexpr auto COMPACT = AttributesCodec::Format::COMPACT;
+
+v1::UAttributes makeRequestAttributes() {
+	v1::UAttributes attributes;
+	attributes.set_type(v1::UMessageType::UMESSAGE_TYPE_REQUEST);
+	attributes.mutable_id()->set_msb(0x0123456789ABCDEF);
+	attributes.mutable_id()->set_lsb(0xFEDCBA9876543210);
+	attributes.mutable_source()->set_authority_name("client_device");
+	attributes.mutable_source()->set_ue_id(0x10AB);
+	attributes.mutable_source()->set_ue_version_major(1);
+	attributes.mutable_sink()->set_authority_name("server_device");
+	attributes.mutable_sink()->set_ue_id(0x20CD);
+	attributes.mutable_sink()->set_ue_version_major(2);
+	attributes.mutable_sink()->set_resource_id(0x7);
+	attributes.set_priority(v1::UPriority::UPRIORITY_CS4);
+	attributes.set_ttl(1000);
+	attributes.set_permission_level(3);
+	attributes.set_token("token");
+	attributes.set_traceparent("00-0af7651916cd43dd8448eb211c80319c-01");
+	attributes.set_payload_format(v1::UPayloadFormat::UPAYLOAD_FORMAT_TEXT);
+	return attributes;
+}
+
+uint8_t version(AttributesCodec::Format format) {
+	return static_cast<uint8_t>(format);
+}
+
+class AttributesCodecTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	AttributesCodecTest() = default;
+	~AttributesCodecTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(AttributesCodecTest, RoundTrip) {
+	const auto attributes = makeRequestAttributes();
+
+	for (auto format : {PROTOBUF, COMPACT}) {
+		auto decoded = AttributesCodec::decode(
+		    version(format), AttributesCodec::encode(attributes, format));
+		ASSERT_TRUE(decoded.has_value());
+		EXPECT_EQ(decoded->SerializeAsString(), attributes.SerializeAsString());
+	}
+}
+
+TEST_F(AttributesCodecTest, CompactKeepsFieldPresence) {
+	v1::UAttributes attributes;
+	attributes.set_type(v1::UMessageType::UMESSAGE_TYPE_PUBLISH);
+	attributes.mutable_source()->set_ue_id(0x10AB);
+	attributes.mutable_source()->set_resource_id(0x8001);
+
+	auto decoded = AttributesCodec::decode(
+	    version(COMPACT), AttributesCodec::encode(attributes, COMPACT));
+	ASSERT_TRUE(decoded.has_value());
+	EXPECT_TRUE(decoded->has_source());
+	EXPECT_FALSE(decoded->has_sink());
+	EXPECT_FALSE(decoded->has_id());
+	EXPECT_FALSE(decoded->has_reqid());
+	EXPECT_FALSE(decoded->has_ttl());
+	EXPECT_FALSE(decoded->has_commstatus());
+	EXPECT_FALSE(decoded->has_token());
+	EXPECT_EQ(decoded->SerializeAsString(), attributes.SerializeAsString());
+}
+
+TEST_F(AttributesCodecTest, CompactRejectsTruncatedData) {
+	const auto encoded =
+	    AttributesCodec::encode(makeRequestAttributes(), COMPACT);
+
+	for (size_t size : {size_t{0}, size_t{10}, encoded.size() - 1}) {
+		EXPECT_FALSE(AttributesCodec::decode(version(COMPACT),
+		                                     encoded.substr(0, size)))
+		    << "size " << size;
+	}
+	EXPECT_FALSE(
+	    AttributesCodec::decode(version(COMPACT), encoded + "trailing"));
+}
+
+TEST_F(AttributesCodecTest, UnknownVersionIsRejected) {
+	const auto encoded =
+	    AttributesCodec::encode(makeRequestAttributes(), PROTOBUF);
+	EXPECT_FALSE(AttributesCodec::decode(0, encoded));
+	EXPECT_FALSE(AttributesCodec::decode(0xFF, encoded));
+}
+
+}  // namespace
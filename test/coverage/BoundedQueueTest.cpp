@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/BoundedQueue.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using uprotocol::transport::BoundedQueue;
+
+class BoundedQueueTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	BoundedQueueTest() = default;
+	~BoundedQueueTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(BoundedQueueTest, FifoOrder) {
+	BoundedQueue<int> queue(4);
+	EXPECT_TRUE(queue.empty());
+	EXPECT_FALSE(queue.tryPop().has_value());
+
+	for (int value : {1, 2, 3}) {
+		EXPECT_TRUE(queue.tryPush(value));
+	}
+	EXPECT_EQ(queue.size(), 3);
+
+	for (int expected : {1, 2, 3}) {
+		auto value = queue.tryPop();
+		ASSERT_TRUE(value.has_value());
+		EXPECT_EQ(*value, expected);
+	}
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(BoundedQueueTest, FullQueueKeepsValue) {
+	BoundedQueue<std::unique_ptr<int>> queue(2);
+
+	auto first = std::make_unique<int>(1);
+	auto extra = std::make_unique<int>(0);
+	auto second = std::make_unique<int>(2);
+	EXPECT_TRUE(queue.tryPush(first));
+	EXPECT_TRUE(queue.tryPush(extra));
+	EXPECT_TRUE(queue.full());
+	EXPECT_FALSE(queue.tryPush(second));
+	ASSERT_NE(second, nullptr);
+	EXPECT_EQ(*second, 2);
+
+	EXPECT_EQ(**queue.tryPop(), 1);
+	EXPECT_TRUE(queue.tryPush(second));
+	EXPECT_EQ(**queue.tryPop(), 0);
+	EXPECT_EQ(**queue.tryPop(), 2);
+}
+
+TEST_F(BoundedQueueTest, CapacityRoundsUp) {
+	EXPECT_EQ(BoundedQueue<int>(0).capacity(), 2);
+	EXPECT_EQ(BoundedQueue<int>(1).capacity(), 2);
+	EXPECT_EQ(BoundedQueue<int>(5).capacity(), 8);
+	EXPECT_EQ(BoundedQueue<int>(16).capacity(), 16);
+}
+
+TEST_F(BoundedQueueTest, WrapsAround) {
+	BoundedQueue<int> queue(2);
+	for (int value = 0; value < 10; ++value) {
+		int pushed = value;
+		ASSERT_TRUE(queue.tryPush(pushed));
+		EXPECT_EQ(*queue.tryPop(), value);
+	}
+}
+
+TEST_F(BoundedQueueTest, ConcurrentProducers) {
+	constexpr int PRODUCERS = 4;
+	constexpr int PER_PRODUCER = 10000;
+	BoundedQueue<int> queue(64);
+
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < PRODUCERS; ++producer) {
+		producers.emplace_back([&queue, producer]() {
+			for (int i = 0; i < PER_PRODUCER; ++i) {
+				int value = (producer * PER_PRODUCER) + i;
+				while (!queue.tryPush(value)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	// Values from each producer must come out in the order it pushed them
+	std::vector<int> next(PRODUCERS, 0);
+	for (int received = 0; received < PRODUCERS * PER_PRODUCER;) {
+		auto value = queue.tryPop();
+		if (!value) {
+			std::this_thread::yield();
+			continue;
+		}
+		const int producer = *value / PER_PRODUCER;
+		EXPECT_EQ(*value % PER_PRODUCER, next[producer]);
+		next[producer] = (*value % PER_PRODUCER) + 1;
+		++received;
+	}
+
+	for (auto& producer : producers) {
+		producer.join();
+	}
+	EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace
@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/Chunking.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace {
+
+using namespace std::chrono_literals;
+using uprotocol::transport::ChunkAssembler;
+using uprotocol::transport::ChunkHeader;
+using Clock = ChunkAssembler::Clock;
+
+uprotocol::v1::UUID makeId(uint64_t lsb) {
+	uprotocol::v1::UUID id;
+	id.set_msb(0x0123456789ABCDEF);
+	id.set_lsb(lsb);
+	return id;
+}
+
+ChunkHeader makeHeader(uint32_t index, uint32_t count, uint64_t offset,
+                       uint64_t total_size) {
+	ChunkHeader header;
+	header.index = index;
+	header.count = count;
+	header.offset = offset;
+	header.total_size = total_size;
+	return header;
+}
+
+class ChunkingTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	ChunkingTest() = default;
+	~ChunkingTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+
+	const Clock::time_point expiry_{Clock::now() + 10s};
+};
+
+TEST_F(ChunkingTest, HeaderRoundTrip) {
+	const auto header = makeHeader(2, 5, 0x100000000, 0x200000000);
+	const auto encoded = header.encode();
+	EXPECT_EQ(encoded.size(), ChunkHeader::ENCODED_SIZE);
+
+	auto decoded = ChunkHeader::decode(encoded);
+	ASSERT_TRUE(decoded.has_value());
+	EXPECT_EQ(decoded->index, 2);
+	EXPECT_EQ(decoded->count, 5);
+	EXPECT_EQ(decoded->offset, 0x100000000);
+	EXPECT_EQ(decoded->total_size, 0x200000000);
+}
+
+TEST_F(ChunkingTest, MalformedHeaderRejected) {
+	EXPECT_FALSE(ChunkHeader::decode("short").has_value());
+	EXPECT_FALSE(ChunkHeader::decode(makeHeader(0, 0, 0, 0).encode()));
+	EXPECT_FALSE(ChunkHeader::decode(makeHeader(3, 3, 0, 10).encode()));
+	EXPECT_FALSE(ChunkHeader::decode(makeHeader(0, 3, 11, 10).encode()));
+}
+
+TEST_F(ChunkingTest, ReassemblesInOrder) {
+	ChunkAssembler assembler(1024);
+	const auto id = makeId(1);
+
+	EXPECT_FALSE(assembler.add(id, makeHeader(0, 3, 0, 10), "0123", expiry_));
+	EXPECT_FALSE(assembler.add(id, makeHeader(1, 3, 4, 10), "4567", expiry_));
+	EXPECT_EQ(assembler.pending(), 1);
+
+	auto whole = assembler.add(id, makeHeader(2, 3, 8, 10), "89", expiry_);
+	ASSERT_TRUE(whole.has_value());
+	EXPECT_EQ(*whole, "0123456789");
+	EXPECT_EQ(assembler.pending(), 0);
+}
+
+TEST_F(ChunkingTest, InterleavedMessages) {
+	ChunkAssembler assembler(1024);
+
+	EXPECT_FALSE(assembler.add(makeId(1), makeHeader(0, 2, 0, 4), "ab",
+	                           expiry_));
+	EXPECT_FALSE(assembler.add(makeId(2), makeHeader(0, 2, 0, 4), "cd",
+	                           expiry_));
+	EXPECT_EQ(assembler.pending(), 2);
+
+	EXPECT_EQ(assembler.add(makeId(2), makeHeader(1, 2, 2, 4), "ef", expiry_),
+	          "cdef");
+	EXPECT_EQ(assembler.add(makeId(1), makeHeader(1, 2, 2, 4), "gh", expiry_),
+	          "abgh");
+}
+
+TEST_F(ChunkingTest, MissingChunkDropsMessage) {
+	ChunkAssembler assembler(1024);
+	const auto id = makeId(1);
+
+	EXPECT_FALSE(assembler.add(id, makeHeader(0, 3, 0, 6), "01", expiry_));
+	EXPECT_FALSE(assembler.add(id, makeHeader(2, 3, 4, 6), "45", expiry_));
+	EXPECT_EQ(assembler.pending(), 0);
+
+	// Nor is a message picked up from the middle
+	EXPECT_FALSE(assembler.add(id, makeHeader(1, 3, 2, 6), "23", expiry_));
+	EXPECT_EQ(assembler.pending(), 0);
+}
+
+TEST_F(ChunkingTest, OversizedMessageDropped) {
+	ChunkAssembler assembler(8);
+	bool dropped = false;
+	EXPECT_FALSE(assembler.add(makeId(1), makeHeader(0, 3, 0, 10), "0123",
+	                           expiry_, &dropped));
+	EXPECT_TRUE(dropped);
+	EXPECT_EQ(assembler.pending(), 0);
+}
+
+TEST_F(ChunkingTest, PendingSizeLimit) {
+	ChunkAssembler assembler(1024, 16);
+	bool dropped = false;
+
+	EXPECT_FALSE(assembler.add(makeId(1), makeHeader(0, 2, 0, 10), "01234",
+	                           expiry_, &dropped));
+	EXPECT_FALSE(dropped);
+	EXPECT_EQ(assembler.pendingSize(), 10);
+
+	// Would announce more than the 16 bytes allowed
+	EXPECT_FALSE(assembler.add(makeId(2), makeHeader(0, 2, 0, 10), "abcde",
+	                           expiry_, &dropped));
+	EXPECT_TRUE(dropped);
+	EXPECT_EQ(assembler.pending(), 1);
+
+	// Room again once the first one completes
+	EXPECT_EQ(assembler.add(makeId(1), makeHeader(1, 2, 5, 10), "56789",
+	                        expiry_, &dropped),
+	          "0123456789");
+	EXPECT_FALSE(dropped);
+	EXPECT_EQ(assembler.pendingSize(), 0);
+	EXPECT_FALSE(assembler.add(makeId(2), makeHeader(0, 2, 0, 10), "abcde",
+	                           expiry_, &dropped));
+	EXPECT_FALSE(dropped);
+	EXPECT_EQ(assembler.pending(), 1);
+}
+
+TEST_F(ChunkingTest, PendingMessagesLimit) {
+	ChunkAssembler assembler(1024, 1024, 2);
+	bool dropped = false;
+
+	EXPECT_FALSE(assembler.add(makeId(1), makeHeader(0, 2, 0, 4), "ab",
+	                           expiry_));
+	EXPECT_FALSE(assembler.add(makeId(2), makeHeader(0, 2, 0, 4), "cd",
+	                           expiry_));
+	EXPECT_FALSE(assembler.add(makeId(3), makeHeader(0, 2, 0, 4), "ef",
+	                           expiry_, &dropped));
+	EXPECT_TRUE(dropped);
+	EXPECT_EQ(assembler.pending(), 2);
+
+	// Chunks of the pending messages are still taken
+	EXPECT_EQ(assembler.add(makeId(2), makeHeader(1, 2, 2, 4), "gh", expiry_),
+	          "cdgh");
+}
+
+TEST_F(ChunkingTest, ExpiryReleasesPendingSize) {
+	ChunkAssembler assembler(1024, 8);
+
+	EXPECT_FALSE(assembler.add(makeId(1), makeHeader(0, 2, 0, 8), "0123",
+	                           Clock::now() - 1s));
+	EXPECT_EQ(assembler.pendingSize(), 8);
+
+	// Entries expire on the next tick of the table at the earliest
+	std::this_thread::sleep_for(2ms);
+	bool dropped = true;
+	EXPECT_FALSE(assembler.add(makeId(2), makeHeader(0, 2, 0, 8), "abcd",
+	                           expiry_, &dropped));
+	EXPECT_FALSE(dropped);
+	EXPECT_EQ(assembler.pending(), 1);
+	EXPECT_EQ(assembler.pendingSize(), 8);
+}
+
+TEST_F(ChunkingTest, ExpiredMessageDropped) {
+	ChunkAssembler assembler(1024);
+	const auto id = makeId(1);
+
+	EXPECT_FALSE(assembler.add(id, makeHeader(0, 2, 0, 4), "01",
+	                           Clock::now() - 1s));
+	// Any later chunk expires it
+	EXPECT_FALSE(assembler.add(id, makeHeader(1, 2, 2, 4), "23", expiry_));
+	EXPECT_EQ(assembler.pending(), 0);
+}
+
+}  // namespace
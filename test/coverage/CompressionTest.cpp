@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/Compression.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+using uprotocol::transport::Compression;
+using Codec = Compression::Codec;
+
+// Repetitive, like the diagnostic payloads compression is meant for
+std::string makeCompressible() {
+	std::string data;
+	for (int i = 0; i < 200; ++i) {
+		data += R"({"signal":"engine_temp","value":)" + std::to_string(i % 7) +
+		        "},";
+	}
+	return data;
+}
+
+class CompressionTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	CompressionTest() = default;
+	~CompressionTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+
+	// Codecs built into this test, which depend on the build options
+	static std::vector<Codec> availableCodecs() {
+		std::vector<Codec> codecs;
+		for (auto codec : {Codec::LZ4, Codec::ZSTD}) {
+			if (Compression::isAvailable(codec)) {
+				codecs.push_back(codec);
+			}
+		}
+		return codecs;
+	}
+};
+
+TEST_F(CompressionTest, RoundTrip) {
+	const auto data = makeCompressible();
+	for (auto codec : availableCodecs()) {
+		auto compressed = Compression::compress(codec, data);
+		ASSERT_TRUE(compressed.has_value());
+		EXPECT_LT(compressed->size(), data.size() / 4);
+
+		std::string out;
+		ASSERT_TRUE(
+		    Compression::decompress(codec, *compressed, data.size(), out));
+		EXPECT_EQ(out, data);
+	}
+}
+
+TEST_F(CompressionTest, DoesNotGrow) {
+	for (auto codec : availableCodecs()) {
+		EXPECT_FALSE(Compression::compress(codec, "abc").has_value());
+	}
+}
+
+TEST_F(CompressionTest, MalformedRejected) {
+	const auto data = makeCompressible();
+	for (auto codec : availableCodecs()) {
+		auto compressed = Compression::compress(codec, data);
+		ASSERT_TRUE(compressed.has_value());
+
+		std::string out;
+		EXPECT_FALSE(Compression::decompress(codec, *compressed,
+		                                     data.size() + 1, out));
+		EXPECT_FALSE(Compression::decompress(codec, "garbage", 64, out));
+	}
+}
+
+TEST_F(CompressionTest, Levels) {
+	EXPECT_TRUE(Compression::isValidLevel(Codec::LZ4, 1000));
+	if (!Compression::isAvailable(Codec::ZSTD)) {
+		return;
+	}
+	EXPECT_TRUE(Compression::isValidLevel(Codec::ZSTD, 0));
+	EXPECT_FALSE(Compression::isValidLevel(Codec::ZSTD, 1000));
+
+	// Negative levels are the fast modes of zstd
+	ASSERT_TRUE(Compression::isValidLevel(Codec::ZSTD, -1));
+	const auto data = makeCompressible();
+	auto compressed = Compression::compress(Codec::ZSTD, data, -1);
+	ASSERT_TRUE(compressed.has_value());
+	std::string out;
+	ASSERT_TRUE(Compression::decompress(Codec::ZSTD, *compressed, data.size(),
+	                                    out));
+	EXPECT_EQ(out, data);
+}
+
+TEST_F(CompressionTest, UnavailableCodec) {
+	EXPECT_FALSE(Compression::isAvailable(Codec::NONE));
+	EXPECT_FALSE(Compression::compress(Codec::NONE, makeCompressible()));
+
+	std::string out;
+	EXPECT_FALSE(Compression::decompress(Codec::NONE, "data", 4, out));
+}
+
+TEST_F(CompressionTest, HeaderRoundTrip) {
+	const Compression::Header header{Codec::ZSTD, 0x123456789};
+	const auto encoded = header.encode();
+	EXPECT_EQ(encoded.size(), Compression::Header::ENCODED_SIZE);
+
+	auto decoded = Compression::Header::decode(encoded);
+	ASSERT_TRUE(decoded.has_value());
+	EXPECT_EQ(decoded->codec, Codec::ZSTD);
+	EXPECT_EQ(decoded->size, 0x123456789);
+	EXPECT_FALSE(Compression::Header::decode("short").has_value());
+}
+
+}  // namespace
@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/Dispatcher.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using uprotocol::transport::Dispatcher;
+
+class DispatcherTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	DispatcherTest() = default;
+	~DispatcherTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(DispatcherTest, NeedsThreads) {
+	EXPECT_THROW(Dispatcher(0), std::invalid_argument);
+}
+
+TEST_F(DispatcherTest, ShardForIsStable) {
+	Dispatcher dispatcher(4);
+	EXPECT_EQ(dispatcher.threads(), 4);
+	EXPECT_EQ(dispatcher.shardFor("up/a/1/1/8001"),
+	          dispatcher.shardFor("up/a/1/1/8001"));
+	EXPECT_LT(dispatcher.shardFor("up/a/1/1/8001"), 4);
+}
+
+TEST_F(DispatcherTest, KeepsOrderWithinShard) {
+	std::mutex mutex;
+	std::vector<int> order;
+	{
+		Dispatcher dispatcher(4);
+		for (int i = 0; i < 1000; ++i) {
+			dispatcher.post(1, [&mutex, &order, i]() {
+				std::lock_guard lock(mutex);
+				order.push_back(i);
+			});
+		}
+	}
+
+	// Destroying the dispatcher runs everything still queued
+	ASSERT_EQ(order.size(), 1000);
+	for (int i = 0; i < 1000; ++i) {
+		EXPECT_EQ(order[i], i);
+	}
+}
+
+TEST_F(DispatcherTest, SlowShardDoesNotBlockOthers) {
+	Dispatcher dispatcher(2);
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	dispatcher.post(0, [released]() { released.wait(); });
+
+	std::promise<void> ran;
+	dispatcher.post(1, [&ran]() { ran.set_value(); });
+	EXPECT_EQ(ran.get_future().wait_for(1s), std::future_status::ready);
+
+	release.set_value();
+}
+
+TEST_F(DispatcherTest, QueuedCountsTasksTakenByTheWorker) {
+	Dispatcher dispatcher(1);
+	std::promise<void> first_release;
+	auto first_released = first_release.get_future().share();
+	dispatcher.post(0, [first_released]() { first_released.wait(); });
+
+	// Queued behind the first task, then taken by the worker all at once
+	std::promise<void> entered;
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	dispatcher.post(0, [&entered, released]() {
+		entered.set_value();
+		released.wait();
+	});
+	for (int i = 0; i < 100; ++i) {
+		dispatcher.post(0, []() {});
+	}
+	first_release.set_value();
+	ASSERT_EQ(entered.get_future().wait_for(1s), std::future_status::ready);
+	EXPECT_EQ(dispatcher.queued(), 101);
+
+	release.set_value();
+	const auto deadline = std::chrono::steady_clock::now() + 1s;
+	while ((dispatcher.queued() != 0) &&
+	       (std::chrono::steady_clock::now() < deadline)) {
+		std::this_thread::yield();
+	}
+	EXPECT_EQ(dispatcher.queued(), 0);
+}
+
+TEST_F(DispatcherTest, ThrowingTaskIsContained) {
+	std::atomic<int> count{0};
+	{
+		Dispatcher dispatcher(1);
+		dispatcher.post(0, []() { throw std::runtime_error("listener"); });
+		dispatcher.post(0, [&count]() { ++count; });
+	}
+	EXPECT_EQ(count, 1);
+}
+
+}  // namespace
@@ -0,0 +1,124 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/KeyExprTable.h>
+
+namespace {
+
+using namespace uprotocol;
+using transport::KeyExprTable;
+
+v1::UUri makeUri(const std::string& authority, uint32_t ue_id,
+                 uint32_t ue_version_major, uint32_t resource_id) {
+	v1::UUri uri;
+	uri.set_authority_name(authority);
+	uri.set_ue_id(ue_id);
+	uri.set_ue_version_major(ue_version_major);
+	uri.set_resource_id(resource_id);
+	return uri;
+}
+
+class KeyExprTableTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	KeyExprTableTest() = default;
+	~KeyExprTableTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(KeyExprTableTest, KeyFormat) {
+	EXPECT_EQ(KeyExprTable::toZenohKeyString(
+	              "local", makeUri("device", 0x10AB, 1, 0x8001)),
+	          "up/device/10AB/1/8001");
+	EXPECT_EQ(KeyExprTable::toZenohKeyString("local",
+	                                         makeUri("", 0x10AB, 1, 0x8001)),
+	          "up/local/10AB/1/8001");
+	EXPECT_EQ(KeyExprTable::toZenohKeyString(
+	              "local", makeUri("*", 0xFFFF, 0xFF, 0xFFFF)),
+	          "up/*/*/*/*");
+}
+
+TEST_F(KeyExprTableTest, SinkAndSource) {
+	const auto sink = makeUri("", 0x10AB, 1, 0);
+	const auto source = makeUri("device", 0x20CD, 2, 0x8001);
+	EXPECT_EQ(KeyExprTable::toZenohKeyString("local", sink, source),
+	          "up/local/10AB/1/0/device/20CD/2/8001");
+
+	KeyExprTable table("local", 8);
+	auto first = table.get(sink, source);
+	ASSERT_NE(first, nullptr);
+	EXPECT_EQ(first->key, "up/local/10AB/1/0/device/20CD/2/8001");
+	EXPECT_EQ(table.get(sink, source), first);
+	EXPECT_NE(table.get(sink), first);
+	EXPECT_EQ(table.size(), 2);
+
+	auto wildcard = table.get(sink, makeUri("*", 0xFFFF, 0xFF, 0xFFFF));
+	ASSERT_NE(wildcard, nullptr);
+	EXPECT_EQ(wildcard->key, "up/local/10AB/1/0/*/*/*/*");
+	EXPECT_EQ(table.size(), 3);
+}
+
+TEST_F(KeyExprTableTest, Validate) {
+	auto valid = KeyExprTable::validate("up/local/10AB/1/0/**");
+	ASSERT_NE(valid, nullptr);
+	EXPECT_EQ(valid->key, "up/local/10AB/1/0/**");
+	EXPECT_EQ(KeyExprTable::validate("up/bad#key"), nullptr);
+}
+
+TEST_F(KeyExprTableTest, InternsOnce) {
+	KeyExprTable table("local", 8);
+
+	auto first = table.get(makeUri("device", 0x10AB, 1, 0x8001));
+	auto second = table.get(makeUri("device", 0x10AB, 1, 0x8001));
+	ASSERT_NE(first, nullptr);
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(first->key, "up/device/10AB/1/8001");
+	EXPECT_EQ(table.size(), 1);
+
+	auto other = table.get(makeUri("device", 0x10AB, 1, 0x8002));
+	ASSERT_NE(other, nullptr);
+	EXPECT_NE(first, other);
+	EXPECT_EQ(table.size(), 2);
+}
+
+TEST_F(KeyExprTableTest, BeyondCapacity) {
+	KeyExprTable table("local", 1);
+
+	auto interned = table.get(makeUri("device", 0x10AB, 1, 0x8001));
+	auto first = table.get(makeUri("device", 0x10AB, 1, 0x8002));
+	auto second = table.get(makeUri("device", 0x10AB, 1, 0x8002));
+	ASSERT_NE(first, nullptr);
+	ASSERT_NE(second, nullptr);
+	EXPECT_NE(first, second);
+	EXPECT_EQ(first->key, second->key);
+	EXPECT_EQ(table.size(), 1);
+	EXPECT_EQ(interned, table.get(makeUri("device", 0x10AB, 1, 0x8001)));
+}
+
+TEST_F(KeyExprTableTest, InvalidKey) {
+	KeyExprTable table("local", 8);
+
+	EXPECT_EQ(table.get(makeUri("bad#authority", 0x10AB, 1, 0x8001)), nullptr);
+	EXPECT_EQ(table.size(), 0);
+}
+
+}  // namespace
@@ -0,0 +1,86 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/LatestCache.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using uprotocol::transport::LatestCache;
+using uprotocol::v1::UMessage;
+
+std::shared_ptr<const UMessage> makeMessage(uint64_t id,
+                                            const std::string& payload) {
+	auto message = std::make_shared<UMessage>();
+	message->mutable_attributes()->mutable_id()->set_lsb(id);
+	message->set_payload(payload);
+	return message;
+}
+
+class LatestCacheTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	LatestCacheTest() = default;
+	~LatestCacheTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(LatestCacheTest, NeedsDepth) {
+	EXPECT_THROW(LatestCache(0, 16), std::invalid_argument);
+}
+
+TEST_F(LatestCacheTest, KeepsLastMessages) {
+	LatestCache cache(2, 16);
+	EXPECT_TRUE(cache.get("up/a/1/1/8001").empty());
+
+	EXPECT_TRUE(cache.add("up/a/1/1/8001", makeMessage(1, "one")));
+	EXPECT_FALSE(cache.add("up/a/1/1/8001", makeMessage(2, "two")));
+	EXPECT_FALSE(cache.add("up/a/1/1/8001", makeMessage(3, "three")));
+	EXPECT_TRUE(cache.add("up/a/1/1/8002", makeMessage(4, "other")));
+	EXPECT_EQ(cache.topics(), 2);
+
+	const auto latest = cache.get("up/a/1/1/8001");
+	ASSERT_EQ(latest.size(), 2);
+	EXPECT_EQ(latest[0]->payload(), "two");
+	EXPECT_EQ(latest[1]->payload(), "three");
+	EXPECT_EQ(cache.get("up/a/1/1/8002").size(), 1);
+}
+
+TEST_F(LatestCacheTest, IgnoresDuplicates) {
+	LatestCache cache(4, 16);
+	cache.add("up/a/1/1/8001", makeMessage(1, "one"));
+	cache.add("up/a/1/1/8001", makeMessage(1, "one"));
+	EXPECT_EQ(cache.get("up/a/1/1/8001").size(), 1);
+}
+
+TEST_F(LatestCacheTest, LimitsTopics) {
+	LatestCache cache(1, 1);
+	EXPECT_TRUE(cache.add("up/a/1/1/8001", makeMessage(1, "one")));
+	EXPECT_FALSE(cache.add("up/a/1/1/8002", makeMessage(2, "two")));
+	EXPECT_EQ(cache.topics(), 1);
+	EXPECT_TRUE(cache.get("up/a/1/1/8002").empty());
+}
+
+}  // namespace
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/LruCache.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+using Cache = uprotocol::transport::LruCache<std::string, int>;
+
+class LruCacheTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	LruCacheTest() = default;
+	~LruCacheTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(LruCacheTest, HitAndMiss) {
+	Cache cache(2);
+	EXPECT_EQ(cache.find("a"), nullptr);
+
+	ASSERT_NE(cache.insert("a", 1), nullptr);
+	auto* value = cache.find("a");
+	ASSERT_NE(value, nullptr);
+	EXPECT_EQ(*value, 1);
+
+	auto stats = cache.stats();
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.misses, 1);
+	EXPECT_EQ(stats.evictions, 0);
+	EXPECT_EQ(stats.size, 1);
+	EXPECT_EQ(stats.capacity, 2);
+}
+
+TEST_F(LruCacheTest, EvictsLeastRecentlyUsed) {
+	Cache cache(2);
+	cache.insert("a", 1);
+	cache.insert("b", 2);
+
+	// Touching "a" makes "b" the least recently used entry
+	ASSERT_NE(cache.find("a"), nullptr);
+	cache.insert("c", 3);
+
+	EXPECT_NE(cache.find("a"), nullptr);
+	EXPECT_EQ(cache.find("b"), nullptr);
+	EXPECT_NE(cache.find("c"), nullptr);
+	EXPECT_EQ(cache.stats().evictions, 1);
+	EXPECT_EQ(cache.stats().size, 2);
+}
+
+TEST_F(LruCacheTest, InsertReplacesExisting) {
+	Cache cache(2);
+	cache.insert("a", 1);
+	cache.insert("a", 10);
+
+	EXPECT_EQ(*cache.find("a"), 10);
+	EXPECT_EQ(cache.stats().size, 1);
+	EXPECT_EQ(cache.stats().evictions, 0);
+}
+
+TEST_F(LruCacheTest, Erase) {
+	Cache cache(2);
+	cache.insert("a", 1);
+	cache.erase("a");
+	cache.erase("missing");
+
+	EXPECT_EQ(cache.find("a"), nullptr);
+	EXPECT_EQ(cache.stats().size, 0);
+	EXPECT_EQ(cache.stats().evictions, 0);
+}
+
+TEST_F(LruCacheTest, ZeroCapacityCachesNothing) {
+	Cache cache(0);
+	EXPECT_EQ(cache.insert("a", 1), nullptr);
+	EXPECT_EQ(cache.find("a"), nullptr);
+	EXPECT_EQ(cache.stats().size, 0);
+}
+
+TEST_F(LruCacheTest, EvictionReleasesValue) {
+	uprotocol::transport::LruCache<int, std::shared_ptr<int>> cache(1);
+	auto first = std::make_shared<int>(1);
+	cache.insert(1, first);
+	EXPECT_EQ(first.use_count(), 2);
+
+	cache.insert(2, std::make_shared<int>(2));
+	EXPECT_EQ(first.use_count(), 1);
+}
+
+}  // namespace
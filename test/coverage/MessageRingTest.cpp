@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/MessageRing.h>
+
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using uprotocol::transport::MessageRing;
+using uprotocol::v1::UMessage;
+
+UMessage makeMessage(const std::string& payload) {
+	UMessage message;
+	message.set_payload(payload);
+	return message;
+}
+
+class MessageRingTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	MessageRingTest() = default;
+	~MessageRingTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(MessageRingTest, NeedsCapacity) {
+	EXPECT_THROW(MessageRing(0), std::invalid_argument);
+}
+
+TEST_F(MessageRingTest, PopsInOrder) {
+	MessageRing ring(4);
+	std::vector<UMessage> batch(4);
+	EXPECT_EQ(ring.pop(batch.data(), batch.size(), 0ms), 0);
+
+	for (const auto* payload : {"a", "b", "c"}) {
+		EXPECT_TRUE(ring.push(makeMessage(payload)));
+	}
+	EXPECT_EQ(ring.size(), 3);
+
+	ASSERT_EQ(ring.pop(batch.data(), 2, 0ms), 2);
+	EXPECT_EQ(batch[0].payload(), "a");
+	EXPECT_EQ(batch[1].payload(), "b");
+	ASSERT_EQ(ring.pop(batch.data(), batch.size(), 0ms), 1);
+	EXPECT_EQ(batch[0].payload(), "c");
+	EXPECT_EQ(ring.size(), 0);
+	EXPECT_EQ(ring.dropped(), 0);
+}
+
+TEST_F(MessageRingTest, FullRingOverwritesOldest) {
+	MessageRing ring(2);
+	EXPECT_TRUE(ring.push(makeMessage("a")));
+	EXPECT_TRUE(ring.push(makeMessage("b")));
+	EXPECT_FALSE(ring.push(makeMessage("c")));
+	EXPECT_FALSE(ring.push(makeMessage("d")));
+	EXPECT_EQ(ring.size(), 2);
+	EXPECT_EQ(ring.dropped(), 2);
+
+	std::vector<UMessage> batch(2);
+	ASSERT_EQ(ring.pop(batch.data(), batch.size(), 0ms), 2);
+	EXPECT_EQ(batch[0].payload(), "c");
+	EXPECT_EQ(batch[1].payload(), "d");
+}
+
+TEST_F(MessageRingTest, PopWaitsForPush) {
+	MessageRing ring(2);
+	std::thread producer([&ring]() {
+		std::this_thread::sleep_for(10ms);
+		ring.push(makeMessage("late"));
+	});
+
+	UMessage message;
+	EXPECT_EQ(ring.pop(&message, 1, 5s), 1);
+	EXPECT_EQ(message.payload(), "late");
+	producer.join();
+
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(ring.pop(&message, 1, 20ms), 0);
+	EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+}
+
+TEST_F(MessageRingTest, PushWakesEveryWaitingConsumer) {
+	MessageRing ring(4);
+
+	// Each consumer pops one message, so the second push has to wake the
+	// second consumer, while the ring is not empty for the first one yet
+	std::vector<std::future<size_t>> consumers;
+	for (int i = 0; i < 2; ++i) {
+		consumers.push_back(std::async(std::launch::async, [&ring]() {
+			UMessage message;
+			return ring.pop(&message, 1, 5s);
+		}));
+	}
+	std::this_thread::sleep_for(20ms);
+
+	const auto start = std::chrono::steady_clock::now();
+	ring.push(makeMessage("a"));
+	ring.push(makeMessage("b"));
+	for (auto& consumer : consumers) {
+		EXPECT_EQ(consumer.get(), 1);
+	}
+	EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+	EXPECT_EQ(ring.size(), 0);
+}
+
+}  // namespace
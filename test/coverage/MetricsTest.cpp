@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/Metrics.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using uprotocol::transport::LatencyHistogram;
+using uprotocol::transport::MetricsRegistry;
+using uprotocol::transport::MetricsSnapshot;
+using uprotocol::transport::TopicMetrics;
+
+class MetricsTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	MetricsTest() = default;
+	~MetricsTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(MetricsTest, HistogramBuckets) {
+	EXPECT_EQ(LatencyHistogram::upperBound(0), 256ns);
+	EXPECT_EQ(LatencyHistogram::upperBound(2), 1024ns);
+	EXPECT_EQ(LatencyHistogram::bucketFor(0ns), 0);
+	EXPECT_EQ(LatencyHistogram::bucketFor(256ns), 0);
+	EXPECT_EQ(LatencyHistogram::bucketFor(257ns), 1);
+	EXPECT_EQ(LatencyHistogram::bucketFor(1000ns), 2);
+	EXPECT_EQ(LatencyHistogram::bucketFor(1h), LatencyHistogram::BUCKETS - 1);
+}
+
+TEST_F(MetricsTest, HistogramPercentile) {
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.percentile(0.5), 0ns);
+
+	histogram.counts[0] = 98;
+	histogram.counts[3] = 1;
+	histogram.counts[6] = 1;
+	EXPECT_EQ(histogram.count(), 100);
+	EXPECT_EQ(histogram.percentile(0.5), LatencyHistogram::upperBound(0));
+	EXPECT_EQ(histogram.percentile(0.99), LatencyHistogram::upperBound(3));
+	EXPECT_EQ(histogram.percentile(1.0), LatencyHistogram::upperBound(6));
+}
+
+TEST_F(MetricsTest, ShardsAreMerged) {
+	TopicMetrics metrics;
+	constexpr size_t THREADS = TopicMetrics::SHARDS + 3;
+	constexpr size_t UPDATES = 1000;
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < THREADS; ++i) {
+		threads.emplace_back([&metrics]() {
+			for (size_t update = 0; update < UPDATES; ++update) {
+				metrics.add(TopicMetrics::Counter::MESSAGES_SENT);
+				metrics.add(TopicMetrics::Counter::BYTES_SENT, 10);
+				metrics.record(TopicMetrics::Timer::SEND, 300ns);
+			}
+		});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+
+	const auto snapshot = metrics.snapshot("key");
+	EXPECT_EQ(snapshot.key, "key");
+	EXPECT_EQ(snapshot.messages_sent, THREADS * UPDATES);
+	EXPECT_EQ(snapshot.bytes_sent, THREADS * UPDATES * 10);
+	EXPECT_EQ(snapshot.send_time.counts[1], THREADS * UPDATES);
+	EXPECT_EQ(snapshot.send_time.sum, THREADS * UPDATES * 300ns);
+	EXPECT_EQ(snapshot.callback_time.count(), 0);
+}
+
+TEST_F(MetricsTest, RegistryLimitsTopics) {
+	MetricsRegistry registry(2);
+	auto first = registry.get("up/a");
+	EXPECT_EQ(registry.get("up/a"), first);
+	auto second = registry.get("up/b");
+	EXPECT_NE(second, first);
+
+	// Further keys share one entry
+	auto third = registry.get("up/c");
+	EXPECT_EQ(registry.get("up/d"), third);
+	EXPECT_NE(third, first);
+	EXPECT_NE(third, second);
+
+	first->add(TopicMetrics::Counter::MESSAGES_RECEIVED);
+	third->add(TopicMetrics::Counter::MESSAGES_SENT, 2);
+	const auto topics = registry.snapshot();
+	ASSERT_EQ(topics.size(), 3);
+	EXPECT_EQ(topics[0].key, "up/a");
+	EXPECT_EQ(topics[0].messages_received, 1);
+	EXPECT_EQ(topics[1].key, "up/b");
+	EXPECT_EQ(topics[2].key, MetricsRegistry::OTHER_KEY);
+	EXPECT_EQ(topics[2].messages_sent, 2);
+}
+
+TEST_F(MetricsTest, Prometheus) {
+	TopicMetrics metrics;
+	metrics.add(TopicMetrics::Counter::MESSAGES_SENT, 3);
+	metrics.add(TopicMetrics::Counter::MESSAGES_EXPIRED);
+	metrics.record(TopicMetrics::Timer::CALLBACK, 100ns);
+
+	MetricsSnapshot snapshot;
+	snapshot.topics.push_back(metrics.snapshot("up/\"quoted\""));
+	snapshot.dispatch_queued = 5;
+	const auto text = snapshot.toPrometheus();
+
+	EXPECT_NE(text.find("# TYPE up_transport_zenoh_messages_sent_total "
+	                    "counter\n"),
+	          std::string::npos);
+	EXPECT_NE(text.find("up_transport_zenoh_messages_sent_total"
+	                    "{key=\"up/\\\"quoted\\\"\"} 3\n"),
+	          std::string::npos);
+	EXPECT_NE(text.find("up_transport_zenoh_messages_expired_total"
+	                    "{key=\"up/\\\"quoted\\\"\"} 1\n"),
+	          std::string::npos);
+	EXPECT_NE(text.find("up_transport_zenoh_callback_seconds_bucket"
+	                    "{key=\"up/\\\"quoted\\\"\",le=\"+Inf\"} 1\n"),
+	          std::string::npos);
+	EXPECT_NE(text.find("up_transport_zenoh_callback_seconds_count"
+	                    "{key=\"up/\\\"quoted\\\"\"} 1\n"),
+	          std::string::npos);
+	EXPECT_NE(text.find("up_transport_zenoh_dispatch_queued 5\n"),
+	          std::string::npos);
+}
+
+}  // namespace
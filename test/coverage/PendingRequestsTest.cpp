@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/PendingRequests.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using Table = uprotocol::transport::PendingRequests<int>;
+using Clock = Table::Clock;
+
+uprotocol::v1::UUID makeId(uint64_t lsb) {
+	uprotocol::v1::UUID id;
+	id.set_msb(0x0123456789ABCDEF);
+	id.set_lsb(lsb);
+	return id;
+}
+
+class PendingRequestsTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	PendingRequestsTest() = default;
+	~PendingRequestsTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+
+	const Clock::time_point start_{Clock::now()};
+};
+
+TEST_F(PendingRequestsTest, TakeMatchesById) {
+	Table table(start_);
+	table.insert(makeId(1), 10, start_ + 1s);
+	table.insert(makeId(2), 20, start_ + 1s);
+	EXPECT_EQ(table.size(), 2);
+
+	EXPECT_EQ(table.take(makeId(2)), 20);
+	EXPECT_EQ(table.take(makeId(2)), std::nullopt);
+	EXPECT_EQ(table.take(makeId(3)), std::nullopt);
+	EXPECT_EQ(table.size(), 1);
+}
+
+TEST_F(PendingRequestsTest, ExpiresAtDeadline) {
+	Table table(start_);
+	table.insert(makeId(1), 10, start_ + 5ms);
+
+	EXPECT_TRUE(table.expire(start_ + 4ms).empty());
+	EXPECT_EQ(table.expire(start_ + 5ms), std::vector<int>{10});
+	EXPECT_TRUE(table.empty());
+	EXPECT_EQ(table.take(makeId(1)), std::nullopt);
+}
+
+TEST_F(PendingRequestsTest, TakenEntriesDoNotExpire) {
+	Table table(start_);
+	table.insert(makeId(1), 10, start_ + 5ms);
+	table.insert(makeId(2), 20, start_ + 5ms);
+	EXPECT_EQ(table.take(makeId(1)), 10);
+
+	EXPECT_EQ(table.expire(start_ + 10ms), std::vector<int>{20});
+}
+
+TEST_F(PendingRequestsTest, InsertReplacesAndReschedules) {
+	Table table(start_);
+	table.insert(makeId(1), 10, start_ + 5ms);
+	table.insert(makeId(1), 11, start_ + 500ms);
+	EXPECT_EQ(table.size(), 1);
+
+	EXPECT_TRUE(table.expire(start_ + 499ms).empty());
+	EXPECT_EQ(table.expire(start_ + 500ms), std::vector<int>{11});
+}
+
+TEST_F(PendingRequestsTest, PastDeadlineExpiresOnNextTick) {
+	Table table(start_);
+	EXPECT_TRUE(table.expire(start_ + 100ms).empty());
+	table.insert(makeId(1), 10, start_);
+
+	EXPECT_TRUE(table.expire(start_ + 100ms).empty());
+	EXPECT_EQ(table.expire(start_ + 101ms), std::vector<int>{10});
+}
+
+TEST_F(PendingRequestsTest, CascadesThroughLevels) {
+	// One deadline per level, and one past the horizon of the wheel
+	const std::vector<Clock::duration> ttls = {30ms, 3s, 3min, 3h, 10h};
+
+	Table table(start_);
+	for (size_t i = 0; i < ttls.size(); ++i) {
+		table.insert(makeId(i), static_cast<int>(i), start_ + ttls[i]);
+	}
+
+	for (size_t i = 0; i < ttls.size(); ++i) {
+		EXPECT_TRUE(table.expire(start_ + ttls[i] - 1ms).empty());
+		EXPECT_EQ(table.expire(start_ + ttls[i]),
+		          std::vector<int>{static_cast<int>(i)});
+	}
+	EXPECT_TRUE(table.empty());
+}
+
+TEST_F(PendingRequestsTest, ManyOutstanding) {
+	constexpr int COUNT = 20000;
+
+	Table table(start_);
+	for (int i = 0; i < COUNT; ++i) {
+		table.insert(makeId(i), i,
+		             start_ + std::chrono::milliseconds(1 + (i % 997)));
+	}
+	// Every other request is answered
+	for (int i = 0; i < COUNT; i += 2) {
+		EXPECT_EQ(table.take(makeId(i)), i);
+	}
+
+	size_t expired = 0;
+	for (int ms = 1; ms <= 997; ++ms) {
+		for (int i : table.expire(start_ + std::chrono::milliseconds(ms))) {
+			EXPECT_EQ(i % 2, 1);
+			EXPECT_EQ(1 + (i % 997), ms);
+			++expired;
+		}
+	}
+	EXPECT_EQ(expired, COUNT / 2);
+	EXPECT_TRUE(table.empty());
+}
+
+TEST_F(PendingRequestsTest, HoldsMoveOnlyValues) {
+	uprotocol::transport::PendingRequests<std::unique_ptr<int>> table(start_);
+	table.insert(makeId(1), std::make_unique<int>(10), start_ + 1s);
+
+	auto value = table.take(makeId(1));
+	ASSERT_TRUE(value.has_value());
+	EXPECT_EQ(**value, 10);
+}
+
+}  // namespace
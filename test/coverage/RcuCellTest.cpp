@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/RcuCell.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using namespace std::chrono_literals;
+using uprotocol::transport::RcuCell;
+
+class RcuCellTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	RcuCellTest() = default;
+	~RcuCellTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(RcuCellTest, ReadAndUpdate) {
+	RcuCell<std::vector<int>> cell({1, 2});
+	EXPECT_EQ(cell.read([](const std::vector<int>& value) {
+		return value.size();
+	}),
+	          2);
+
+	cell.update([](std::vector<int>& value) { value.push_back(3); });
+	EXPECT_EQ(cell.read([](const std::vector<int>& value) {
+		return value.back();
+	}),
+	          3);
+}
+
+TEST_F(RcuCellTest, UpdateWaitsForReaders) {
+	RcuCell<int> cell(1);
+	std::promise<void> entered;
+	std::promise<void> leave;
+	auto may_leave = leave.get_future();
+
+	std::thread reader([&]() {
+		cell.read([&](const int& value) {
+			entered.set_value();
+			may_leave.wait();
+			EXPECT_EQ(value, 1);
+			return value;
+		});
+	});
+	entered.get_future().wait();
+
+	auto updated = std::async(std::launch::async, [&cell]() {
+		cell.update([](int& value) { value = 2; });
+	});
+	EXPECT_EQ(updated.wait_for(50ms), std::future_status::timeout);
+	// New readers already see the new value
+	EXPECT_EQ(cell.read([](const int& value) { return value; }), 2);
+
+	leave.set_value();
+	EXPECT_EQ(updated.wait_for(1s), std::future_status::ready);
+	reader.join();
+}
+
+TEST_F(RcuCellTest, UpdateWaitsForReadersOfEveryThread) {
+	// More threads than reader shards, so that some share one
+	constexpr int READERS = 12;
+	RcuCell<int> cell(1);
+	std::atomic<int> entered{0};
+	std::promise<void> leave;
+	auto may_leave = leave.get_future().share();
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < READERS; ++i) {
+		readers.emplace_back([&cell, &entered, may_leave]() {
+			cell.read([&entered, &may_leave](const int& value) {
+				++entered;
+				may_leave.wait();
+				return value;
+			});
+		});
+	}
+	while (entered < READERS) {
+		std::this_thread::yield();
+	}
+
+	auto updated = std::async(std::launch::async, [&cell]() {
+		cell.update([](int& value) { value = 2; });
+	});
+	EXPECT_EQ(updated.wait_for(50ms), std::future_status::timeout);
+
+	leave.set_value();
+	EXPECT_EQ(updated.wait_for(1s), std::future_status::ready);
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	EXPECT_EQ(cell.read([](const int& value) { return value; }), 2);
+}
+
+TEST_F(RcuCellTest, ConcurrentReadersSeeWholeSnapshots) {
+	constexpr int UPDATES = 200;
+	RcuCell<std::vector<int>> cell(std::vector<int>(16, 0));
+	std::atomic<bool> done{false};
+	std::atomic<int> torn{0};
+
+	std::vector<std::thread> readers;
+	for (int i = 0; i < 4; ++i) {
+		readers.emplace_back([&]() {
+			while (!done) {
+				cell.read([&torn](const std::vector<int>& value) {
+					for (int element : value) {
+						if (element != value.front()) {
+							++torn;
+						}
+					}
+					return 0;
+				});
+			}
+		});
+	}
+
+	for (int update = 1; update <= UPDATES; ++update) {
+		cell.update([update](std::vector<int>& value) {
+			for (auto& element : value) {
+				element = update;
+			}
+		});
+	}
+	done = true;
+	for (auto& reader : readers) {
+		reader.join();
+	}
+
+	EXPECT_EQ(torn, 0);
+	EXPECT_EQ(cell.read([](const std::vector<int>& value) {
+		return value.front();
+	}),
+	          UPDATES);
+}
+
+}  // namespace
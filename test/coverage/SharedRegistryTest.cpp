@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/SharedRegistry.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+using Registry = uprotocol::transport::SharedRegistry<std::string, int>;
+
+class SharedRegistryTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	SharedRegistryTest() = default;
+	~SharedRegistryTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+
+	auto counting(int value) {
+		return [this, value]() {
+			++created_;
+			return std::make_shared<int>(value);
+		};
+	}
+
+	int created_{0};
+};
+
+TEST_F(SharedRegistryTest, SameKeyShares) {
+	Registry registry;
+	auto first = registry.acquire("a", counting(1));
+	auto second = registry.acquire("a", counting(2));
+	EXPECT_EQ(first, second);
+	EXPECT_EQ(*second, 1);
+	EXPECT_EQ(created_, 1);
+
+	auto other = registry.acquire("b", counting(3));
+	EXPECT_NE(first, other);
+	EXPECT_EQ(created_, 2);
+	EXPECT_EQ(registry.size(), 2);
+}
+
+TEST_F(SharedRegistryTest, RecreatedAfterRelease) {
+	Registry registry;
+	auto first = registry.acquire("a", counting(1));
+	std::weak_ptr<int> watch = first;
+	first.reset();
+	EXPECT_TRUE(watch.expired());
+	EXPECT_EQ(registry.size(), 0);
+
+	auto second = registry.acquire("a", counting(2));
+	EXPECT_EQ(*second, 2);
+	EXPECT_EQ(created_, 2);
+}
+
+TEST_F(SharedRegistryTest, FailedCreation) {
+	Registry registry;
+	EXPECT_THROW(registry.acquire("a",
+	                              []() -> std::shared_ptr<int> {
+		                              throw std::runtime_error("failed");
+	                              }),
+	             std::runtime_error);
+	EXPECT_EQ(registry.size(), 0);
+
+	EXPECT_EQ(*registry.acquire("a", counting(1)), 1);
+}
+
+}  // namespace
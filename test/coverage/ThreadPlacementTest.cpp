@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <sched.h>
+#include <up-transport-zenoh-cpp/Dispatcher.h>
+#include <up-transport-zenoh-cpp/ThreadPlacement.h>
+
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using uprotocol::transport::Dispatcher;
+using uprotocol::transport::ScopedThreadPlacement;
+using uprotocol::transport::ThreadPlacement;
+
+// CPUs the calling thread may run on
+std::vector<size_t> allowedCpus() {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	std::vector<size_t> cpus;
+	if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+		for (size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+			if (CPU_ISSET(cpu, &set)) {
+				cpus.push_back(cpu);
+			}
+		}
+	}
+	return cpus;
+}
+
+class ThreadPlacementTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	ThreadPlacementTest() = default;
+	~ThreadPlacementTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(ThreadPlacementTest, ParseCpuList) {
+	EXPECT_EQ(ThreadPlacement::parseCpuList("0-3,8"),
+	          (std::vector<size_t>{0, 1, 2, 3, 8}));
+	EXPECT_EQ(ThreadPlacement::parseCpuList("5"), (std::vector<size_t>{5}));
+	EXPECT_EQ(ThreadPlacement::parseCpuList(""), std::vector<size_t>());
+	for (const auto* list : {"a", "1-", "3-1", "1,,2", "1 "}) {
+		EXPECT_FALSE(ThreadPlacement::parseCpuList(list).has_value())
+		    << list;
+	}
+}
+
+TEST_F(ThreadPlacementTest, Empty) {
+	EXPECT_TRUE(ThreadPlacement().empty());
+
+	ThreadPlacement pinned;
+	pinned.cpus = {1};
+	EXPECT_FALSE(pinned.empty());
+
+	ThreadPlacement on_node;
+	on_node.numa_node = 0;
+	EXPECT_FALSE(on_node.empty());
+}
+
+TEST_F(ThreadPlacementTest, PinsThread) {
+	const auto cpus = allowedCpus();
+	ASSERT_FALSE(cpus.empty());
+
+	std::thread([&cpus]() {
+		ThreadPlacement placement;
+		placement.cpus = {cpus.back()};
+		EXPECT_TRUE(placement.apply("test"));
+		EXPECT_EQ(allowedCpus(), placement.cpus);
+	}).join();
+
+	// Applied to that thread only
+	EXPECT_EQ(allowedCpus(), cpus);
+}
+
+TEST_F(ThreadPlacementTest, ScopedRestores) {
+	const auto cpus = allowedCpus();
+	ASSERT_FALSE(cpus.empty());
+
+	std::thread([&cpus]() {
+		ThreadPlacement placement;
+		placement.cpus = {cpus.front()};
+		std::vector<size_t> inherited;
+		{
+			const ScopedThreadPlacement scoped(placement, "test");
+			EXPECT_EQ(allowedCpus(), placement.cpus);
+			// Threads started meanwhile keep it
+			std::thread([&inherited]() { inherited = allowedCpus(); }).join();
+		}
+		EXPECT_EQ(inherited, placement.cpus);
+		EXPECT_EQ(allowedCpus(), cpus);
+	}).join();
+}
+
+TEST_F(ThreadPlacementTest, MissingNodeFails) {
+	std::thread([]() {
+		ThreadPlacement placement;
+		placement.numa_node = 1000;
+		EXPECT_FALSE(placement.apply("test"));
+	}).join();
+}
+
+TEST_F(ThreadPlacementTest, DispatcherWorkers) {
+	const auto cpus = allowedCpus();
+	ASSERT_FALSE(cpus.empty());
+
+	ThreadPlacement placement;
+	placement.cpus = {cpus.back()};
+	Dispatcher dispatcher(2, placement);
+	for (size_t shard = 0; shard < dispatcher.threads(); ++shard) {
+		std::promise<std::vector<size_t>> worker_cpus;
+		dispatcher.post(shard, [&worker_cpus]() {
+			worker_cpus.set_value(allowedCpus());
+		});
+		EXPECT_EQ(worker_cpus.get_future().get(), placement.cpus);
+	}
+}
+
+}  // namespace
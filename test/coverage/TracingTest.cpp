@@ -0,0 +1,125 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/Tracing.h>
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace tracing = uprotocol::transport::tracing;
+
+using Events = std::vector<std::pair<tracing::Stage, tracing::Event>>;
+
+void record(tracing::Stage stage, tracing::Event event, void* context) {
+	static_cast<Events*>(context)->emplace_back(stage, event);
+}
+
+class TracingTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override { tracing::setHook(nullptr); }
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	TracingTest() = default;
+	~TracingTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(TracingTest, ScopesNest) {
+	Events events;
+	tracing::setHook(record, &events);
+	{
+		tracing::Scope receive(tracing::Stage::RECEIVE);
+		tracing::Scope decode(tracing::Stage::DECODE);
+	}
+
+	const Events expected{
+	    {tracing::Stage::RECEIVE, tracing::Event::BEGIN},
+	    {tracing::Stage::DECODE, tracing::Event::BEGIN},
+	    {tracing::Stage::DECODE, tracing::Event::END},
+	    {tracing::Stage::RECEIVE, tracing::Event::END}};
+	EXPECT_EQ(events, expected);
+}
+
+TEST_F(TracingTest, EndGoesToTheBeginHook) {
+	Events first;
+	Events second;
+	tracing::setHook(record, &first);
+	{
+		tracing::Scope put(tracing::Stage::PUT);
+		tracing::setHook(record, &second);
+	}
+	EXPECT_EQ(first.size(), 2);
+	EXPECT_TRUE(second.empty());
+
+	tracing::setHook(nullptr);
+	{ tracing::Scope put(tracing::Stage::PUT); }
+	EXPECT_EQ(first.size(), 2);
+	EXPECT_TRUE(second.empty());
+}
+
+std::atomic<int> first_context;
+std::atomic<int> second_context;
+std::atomic<int> mismatched{0};
+
+// Hooks checking that they are called with their own context
+void expectFirst(tracing::Stage, tracing::Event, void* context) {
+	if (context != &first_context) {
+		++mismatched;
+	}
+}
+
+void expectSecond(tracing::Stage, tracing::Event, void* context) {
+	if (context != &second_context) {
+		++mismatched;
+	}
+}
+
+TEST_F(TracingTest, HookAndContextChangeTogether) {
+	std::atomic<bool> done{false};
+	std::thread tracer([&done]() {
+		while (!done) {
+			tracing::Scope put(tracing::Stage::PUT);
+		}
+	});
+
+	for (int i = 0; i < 10000; ++i) {
+		tracing::setHook(expectFirst, &first_context);
+		tracing::setHook(expectSecond, &second_context);
+	}
+	done = true;
+	tracer.join();
+	EXPECT_EQ(mismatched, 0);
+}
+
+TEST_F(TracingTest, StageNames) {
+	EXPECT_EQ(tracing::toString(tracing::Stage::KEY_EXPR), "key_expr");
+	EXPECT_EQ(tracing::toString(tracing::Stage::SERIALIZE), "serialize");
+	EXPECT_EQ(tracing::toString(tracing::Stage::PUT), "put");
+	EXPECT_EQ(tracing::toString(tracing::Stage::RECEIVE), "receive");
+	EXPECT_EQ(tracing::toString(tracing::Stage::DECODE), "decode");
+	EXPECT_EQ(tracing::toString(tracing::Stage::FILTER), "filter");
+	EXPECT_EQ(tracing::toString(tracing::Stage::DISPATCH), "dispatch");
+}
+
+}  // namespace
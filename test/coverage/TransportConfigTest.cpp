@@ -0,0 +1,450 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/TransportConfig.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using uprotocol::transport::TransportConfig;
+
+class TransportConfigTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	TransportConfigTest() = default;
+	~TransportConfigTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(TransportConfigTest, EmptySectionKeepsDefaults) {
+	auto config = TransportConfig::fromJson("{}");
+	const TransportConfig defaults;
+
+	EXPECT_EQ(config.attributes_encoding,
+	          uprotocol::transport::AttributesCodec::Format::PROTOBUF);
+	EXPECT_FALSE(config.shared_memory.enabled);
+	EXPECT_EQ(config.shared_memory.segment_size,
+	          defaults.shared_memory.segment_size);
+	EXPECT_EQ(config.shared_memory.threshold,
+	          defaults.shared_memory.threshold);
+	EXPECT_EQ(config.publisher_cache.capacity,
+	          defaults.publisher_cache.capacity);
+	EXPECT_EQ(config.key_expr_table.capacity,
+	          defaults.key_expr_table.capacity);
+	EXPECT_FALSE(config.async_send.enabled);
+	EXPECT_EQ(config.async_send.overflow,
+	          TransportConfig::AsyncSend::Overflow::BLOCK);
+}
+
+TEST_F(TransportConfigTest, PublisherCache) {
+	EXPECT_EQ(
+	    TransportConfig::fromJson(R"({"publisher_cache": {"capacity": 8}})")
+	        .publisher_cache.capacity,
+	    8);
+	EXPECT_EQ(
+	    TransportConfig::fromJson(R"({"publisher_cache": {"capacity": 0}})")
+	        .publisher_cache.capacity,
+	    0);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"publisher_cache": {"size": 8}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, KeyExprTable) {
+	EXPECT_EQ(
+	    TransportConfig::fromJson(R"({"key_expr_table": {"capacity": 16}})")
+	        .key_expr_table.capacity,
+	    16);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"key_expr_table": {"capacity": "16"}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, AsyncSend) {
+	using Overflow = TransportConfig::AsyncSend::Overflow;
+
+	auto config = TransportConfig::fromJson(R"({
+		"async_send": {
+			"enabled": true,
+			"queue_capacity": 64,
+			"overflow": "drop_oldest"
+		}
+	})");
+	EXPECT_TRUE(config.async_send.enabled);
+	EXPECT_EQ(config.async_send.queue_capacity, 64);
+	EXPECT_EQ(config.async_send.overflow, Overflow::DROP_OLDEST);
+
+	EXPECT_EQ(TransportConfig::fromJson(
+	              R"({"async_send": {"overflow": "fail_fast"}})")
+	              .async_send.overflow,
+	          Overflow::FAIL_FAST);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"async_send": {"overflow": "drop"}})"),
+	    std::invalid_argument);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(
+	        R"({"async_send": {"enabled": true, "queue_capacity": 0}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Dispatch) {
+	EXPECT_EQ(TransportConfig().dispatch.threads, 0);
+	EXPECT_EQ(TransportConfig::fromJson(R"({"dispatch": {"threads": 4}})")
+	              .dispatch.threads,
+	          4);
+	EXPECT_THROW(TransportConfig::fromJson(R"({"dispatch": {"threads": -1}})"),
+	             std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Rpc) {
+	EXPECT_TRUE(TransportConfig().rpc.queries);
+	EXPECT_FALSE(TransportConfig::fromJson(R"({"rpc": {"queries": false}})")
+	                 .rpc.queries);
+	EXPECT_THROW(TransportConfig::fromJson(R"({"rpc": {"queries": 1}})"),
+	             std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Qos) {
+	using Qos = TransportConfig::Qos;
+
+	const TransportConfig defaults;
+	EXPECT_EQ(defaults.qos.lanes[0].priority, Qos::Priority::BACKGROUND);
+	EXPECT_EQ(defaults.qos.lanes[0].congestion_control,
+	          Qos::CongestionControl::DROP);
+	EXPECT_EQ(defaults.qos.lanes[6].priority, Qos::Priority::REAL_TIME);
+	EXPECT_EQ(defaults.qos.lanes[6].congestion_control,
+	          Qos::CongestionControl::BLOCK);
+
+	auto config = TransportConfig::fromJson(R"({
+		"qos": {
+			"cs1": {"priority": "interactive_high"},
+			"cs5": {"priority": "data_low", "congestion_control": "drop"}
+		}
+	})");
+	EXPECT_EQ(config.qos.lanes[1].priority, Qos::Priority::INTERACTIVE_HIGH);
+	EXPECT_EQ(config.qos.lanes[1].congestion_control,
+	          defaults.qos.lanes[1].congestion_control);
+	EXPECT_EQ(config.qos.lanes[5].priority, Qos::Priority::DATA_LOW);
+	EXPECT_EQ(config.qos.lanes[5].congestion_control,
+	          Qos::CongestionControl::DROP);
+	EXPECT_EQ(config.qos.lanes[6].priority, defaults.qos.lanes[6].priority);
+
+	EXPECT_THROW(TransportConfig::fromJson(R"({"qos": {"cs7": {}}})"),
+	             std::invalid_argument);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"qos": {"cs0": {"priority": "low"}}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, ReceiveArenas) {
+	auto config = TransportConfig::fromJson(
+	    R"({"receive_arenas": {"count": 4, "block_size": 1024}})");
+	EXPECT_EQ(config.receive_arenas.count, 4);
+	EXPECT_EQ(config.receive_arenas.block_size, 1024);
+
+	EXPECT_EQ(TransportConfig::fromJson(R"({"receive_arenas": {"count": 0}})")
+	              .receive_arenas.block_size,
+	          TransportConfig().receive_arenas.block_size);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"receive_arenas": {"size": 4}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Chunking) {
+	EXPECT_EQ(TransportConfig().chunking.chunk_size, 0);
+
+	auto config = TransportConfig::fromJson(
+	    R"({"chunking": {"chunk_size": 1024, "max_message_size": 4096}})");
+	EXPECT_EQ(config.chunking.chunk_size, 1024);
+	EXPECT_EQ(config.chunking.max_message_size, 4096);
+	EXPECT_EQ(config.chunking.max_pending_messages, 1024);
+
+	config = TransportConfig::fromJson(
+	    R"({"chunking": {"max_pending_messages": 8,)"
+	    R"( "max_pending_size": 65536}})");
+	EXPECT_EQ(config.chunking.max_pending_messages, 8);
+	EXPECT_EQ(config.chunking.max_pending_size, 65536);
+
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"chunking": {"chunk_size": -1}})"),
+	    std::invalid_argument);
+	EXPECT_THROW(TransportConfig::fromJson(R"({"chunking": {"size": 4}})"),
+	             std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Compression) {
+	using Codec = uprotocol::transport::Compression::Codec;
+
+	EXPECT_TRUE(TransportConfig().compression.rules.empty());
+
+	auto config = TransportConfig::fromJson(R"({
+		"compression": {
+			"max_decompressed_size": 65536,
+			"rules": [
+				{"pattern": "//*/10AB/*/8001", "codec": "lz4"},
+				{"pattern": "/*/*/*", "codec": "zstd", "level": 9,
+				 "threshold": 4096}
+			]
+		}
+	})");
+	EXPECT_EQ(config.compression.max_decompressed_size, 65536);
+	ASSERT_EQ(config.compression.rules.size(), 2);
+	const auto& first = config.compression.rules[0];
+	EXPECT_EQ(first.pattern.authority_name(), "*");
+	EXPECT_EQ(first.pattern.ue_id(), 0x10AB);
+	EXPECT_EQ(first.pattern.resource_id(), 0x8001);
+	EXPECT_EQ(first.codec, Codec::LZ4);
+	EXPECT_EQ(first.threshold, 1024);
+	const auto& second = config.compression.rules[1];
+	EXPECT_EQ(second.codec, Codec::ZSTD);
+	EXPECT_EQ(second.level, 9);
+	EXPECT_EQ(second.threshold, 4096);
+
+	// Negative zstd levels are its fast modes
+	config = TransportConfig::fromJson(
+	    R"({"compression": {"rules": [{"pattern": "/*/*/*", "codec": "zstd",)"
+	    R"( "level": -5}]}})");
+	EXPECT_EQ(config.compression.rules[0].level, -5);
+	if (uprotocol::transport::Compression::isAvailable(Codec::ZSTD)) {
+		EXPECT_THROW(TransportConfig::fromJson(
+		                 R"({"compression": {"rules": [{"pattern": "/*/*/*",)"
+		                 R"( "codec": "zstd", "level": 1000}]}})"),
+		             std::invalid_argument);
+	}
+
+	for (const auto* json : {
+	         R"({"compression": {"rules": {"codec": "lz4"}}})",
+	         R"({"compression": {"rules": [{"codec": "lz4"}]}})",
+	         R"({"compression": {"rules": [{"pattern": "x",
+	                                        "codec": "lz4"}]}})",
+	         R"({"compression": {"rules": [{"pattern": "/1/1/1",
+	                                        "codec": "gzip"}]}})",
+	         R"({"compression": {"rules": [{"pattern": "/1/1/1",
+	                                        "codec": "zstd",
+	                                        "level": 1.5}]}})"}) {
+		EXPECT_THROW(TransportConfig::fromJson(json), std::invalid_argument)
+		    << json;
+	}
+}
+
+TEST_F(TransportConfigTest, Reliability) {
+	using Mode = TransportConfig::Reliability::Mode;
+
+	EXPECT_TRUE(TransportConfig().reliability.rules.empty());
+
+	auto config = TransportConfig::fromJson(R"({
+		"reliability": {
+			"rules": [
+				{"pattern": "//*/10AB/*/8001", "mode": "best_effort"},
+				{"pattern": "/*/*/*", "mode": "reliable"}
+			]
+		}
+	})");
+	ASSERT_EQ(config.reliability.rules.size(), 2);
+	EXPECT_EQ(config.reliability.rules[0].pattern.ue_id(), 0x10AB);
+	EXPECT_EQ(config.reliability.rules[0].mode, Mode::BEST_EFFORT);
+	EXPECT_EQ(config.reliability.rules[1].mode, Mode::RELIABLE);
+
+	for (const auto* json : {
+	         R"({"reliability": {"rules": [{"mode": "reliable"}]}})",
+	         R"({"reliability": {"rules": [{"pattern": "/1/1/1"}]}})",
+	         R"({"reliability": {"rules": [{"pattern": "/1/1/1",
+	                                        "mode": "lossy"}]}})"}) {
+		EXPECT_THROW(TransportConfig::fromJson(json), std::invalid_argument)
+		    << json;
+	}
+}
+
+TEST_F(TransportConfigTest, Threads) {
+	EXPECT_TRUE(TransportConfig().threads.dispatch.empty());
+	EXPECT_TRUE(TransportConfig().threads.async_send.empty());
+	EXPECT_TRUE(TransportConfig().threads.zenoh.empty());
+
+	auto config = TransportConfig::fromJson(R"({
+		"threads": {
+			"dispatch": {"cpus": [2, 3], "fifo_priority": 20},
+			"zenoh": {"numa_node": 1}
+		}
+	})");
+	EXPECT_EQ(config.threads.dispatch.cpus, (std::vector<size_t>{2, 3}));
+	EXPECT_EQ(config.threads.dispatch.fifo_priority, 20);
+	EXPECT_FALSE(config.threads.dispatch.numa_node.has_value());
+	EXPECT_TRUE(config.threads.async_send.empty());
+	EXPECT_EQ(config.threads.zenoh.numa_node, 1);
+
+	for (const auto* json : {
+	         R"({"threads": {"dispatch": {"cpus": 2}}})",
+	         R"({"threads": {"dispatch": {"cpus": [-1]}}})",
+	         R"({"threads": {"dispatch": {"fifo_priority": 100}}})",
+	         R"({"threads": {"zenoh": {"numa_node": "0"}}})",
+	         R"({"threads": {"rx": {}}})"}) {
+		EXPECT_THROW(TransportConfig::fromJson(json), std::invalid_argument)
+		    << json;
+	}
+}
+
+TEST_F(TransportConfigTest, Matching) {
+	EXPECT_FALSE(TransportConfig().matching.skip_unmatched);
+	EXPECT_TRUE(
+	    TransportConfig::fromJson(R"({"matching": {"skip_unmatched": true}})")
+	        .matching.skip_unmatched);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"matching": {"skip_unmatched": 1}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Session) {
+	EXPECT_FALSE(TransportConfig().session.shared);
+	EXPECT_FALSE(TransportConfig().session.lazy);
+	EXPECT_TRUE(TransportConfig::fromJson(R"({"session": {"lazy": true}})")
+	                .session.lazy);
+	EXPECT_TRUE(TransportConfig::fromJson(R"({"session": {"shared": true}})")
+	                .session.shared);
+	EXPECT_THROW(TransportConfig::fromJson(R"({"session": {"shared": 1}})"),
+	             std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Metrics) {
+	EXPECT_FALSE(TransportConfig().metrics.enabled);
+	EXPECT_EQ(TransportConfig().metrics.max_topics, 1024);
+
+	auto config = TransportConfig::fromJson(
+	    R"({"metrics": {"enabled": true, "max_topics": 16}})");
+	EXPECT_TRUE(config.metrics.enabled);
+	EXPECT_EQ(config.metrics.max_topics, 16);
+
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"metrics": {"histograms": true}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, Loopback) {
+	EXPECT_FALSE(TransportConfig::fromJson("{}").loopback.enabled);
+	EXPECT_TRUE(TransportConfig::fromJson(R"({"loopback": {"enabled": true}})")
+	                .loopback.enabled);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"loopback": {"remote": false}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, LatestCache) {
+	auto defaults = TransportConfig::fromJson("{}");
+	EXPECT_EQ(defaults.latest_cache.depth, 0);
+	EXPECT_EQ(defaults.latest_cache.max_topics, 1024);
+	EXPECT_FALSE(defaults.latest_cache.query);
+
+	auto config = TransportConfig::fromJson(R"({
+		"latest_cache": { "depth": 4, "max_topics": 16, "query": true }
+	})");
+	EXPECT_EQ(config.latest_cache.depth, 4);
+	EXPECT_EQ(config.latest_cache.max_topics, 16);
+	EXPECT_TRUE(config.latest_cache.query);
+
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"latest_cache": {"query": true}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, SharedMemory) {
+	auto config = TransportConfig::fromJson(R"({
+		"shared_memory": {
+			"enabled": true,
+			"segment_size": 1048576,
+			"threshold": 4096
+		}
+	})");
+
+	EXPECT_TRUE(config.shared_memory.enabled);
+	EXPECT_EQ(config.shared_memory.segment_size, 1048576);
+	EXPECT_EQ(config.shared_memory.threshold, 4096);
+}
+
+TEST_F(TransportConfigTest, AttributesEncoding) {
+	using uprotocol::transport::AttributesCodec;
+
+	EXPECT_EQ(TransportConfig::fromJson(R"({"attributes_encoding": "compact"})")
+	              .attributes_encoding,
+	          AttributesCodec::Format::COMPACT);
+	EXPECT_EQ(
+	    TransportConfig::fromJson(R"({"attributes_encoding": "protobuf"})")
+	        .attributes_encoding,
+	    AttributesCodec::Format::PROTOBUF);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"attributes_encoding": "cbor"})"),
+	    std::invalid_argument);
+	EXPECT_THROW(TransportConfig::fromJson(R"({"attributes_encoding": 2})"),
+	             std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, KeyFormat) {
+	using KeyFormat = TransportConfig::KeyFormat;
+
+	EXPECT_EQ(TransportConfig::fromJson("{}").key_format,
+	          KeyFormat::DESTINATION);
+	EXPECT_EQ(TransportConfig::fromJson(
+	              R"({"key_format": "destination_and_source"})")
+	              .key_format,
+	          KeyFormat::DESTINATION_AND_SOURCE);
+	EXPECT_EQ(TransportConfig::fromJson(R"({"key_format": "destination"})")
+	              .key_format,
+	          KeyFormat::DESTINATION);
+	EXPECT_THROW(TransportConfig::fromJson(R"({"key_format": "source"})"),
+	             std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, SharedMemoryNeedsSegment) {
+	EXPECT_THROW(
+	    TransportConfig::fromJson(
+	        R"({"shared_memory": {"enabled": true, "segment_size": 0}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, MalformedJsonThrows) {
+	EXPECT_THROW(TransportConfig::fromJson("{"), std::invalid_argument);
+	EXPECT_THROW(TransportConfig::fromJson("[]"), std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, UnknownSettingThrows) {
+	EXPECT_THROW(TransportConfig::fromJson(R"({"shared_memroy": {}})"),
+	             std::invalid_argument);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"shared_memory": {"enable": true}})"),
+	    std::invalid_argument);
+}
+
+TEST_F(TransportConfigTest, WrongTypeThrows) {
+	EXPECT_THROW(TransportConfig::fromJson(R"({"shared_memory": true})"),
+	             std::invalid_argument);
+	EXPECT_THROW(
+	    TransportConfig::fromJson(R"({"shared_memory": {"enabled": 1}})"),
+	    std::invalid_argument);
+	EXPECT_THROW(TransportConfig::fromJson(
+	                 R"({"shared_memory": {"threshold": -1}})"),
+	             std::invalid_argument);
+	EXPECT_THROW(TransportConfig::fromJson(
+	                 R"({"shared_memory": {"threshold": 1.5}})"),
+	             std::invalid_argument);
+}
+
+}  // namespace
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2024 Contributors to the Eclipse Foundation
+//
+// See the NOTICE file(s) distributed with this work for additional
+// information regarding copyright ownership.
+//
+// This program and the accompanying materials are made available under the
+// terms of the Apache License Version 2.0 which is available at
+// https://www.apache.org/licenses/LICENSE-2.0
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/UriFilter.h>
+
+namespace {
+
+using namespace uprotocol;
+using transport::UriFilter;
+
+v1::UUri makeUri(const std::string& authority, uint32_t ue_id,
+                 uint32_t ue_version_major, uint32_t resource_id) {
+	v1::UUri uri;
+	uri.set_authority_name(authority);
+	uri.set_ue_id(ue_id);
+	uri.set_ue_version_major(ue_version_major);
+	uri.set_resource_id(resource_id);
+	return uri;
+}
+
+class UriFilterTest : public testing::Test {
+protected:
+	// Run once per TEST_F.
+	// Used to set up clean environments per test.
+	void SetUp() override {}
+	void TearDown() override {}
+
+	// Run once per execution of the test application.
+	// Used for setup of all tests. Has access to this instance.
+	UriFilterTest() = default;
+	~UriFilterTest() = default;
+
+	// Run once per execution of the test application.
+	// Used only for global setup outside of tests.
+	static void SetUpTestSuite() {}
+	static void TearDownTestSuite() {}
+};
+
+TEST_F(UriFilterTest, ExactMatch) {
+	const UriFilter filter("local", makeUri("device", 0x10AB, 1, 0x8001));
+
+	EXPECT_TRUE(filter.matches(makeUri("device", 0x10AB, 1, 0x8001)));
+	EXPECT_FALSE(filter.matches(makeUri("other", 0x10AB, 1, 0x8001)));
+	EXPECT_FALSE(filter.matches(makeUri("device", 0x10AC, 1, 0x8001)));
+	EXPECT_FALSE(filter.matches(makeUri("device", 0x10AB, 2, 0x8001)));
+	EXPECT_FALSE(filter.matches(makeUri("device", 0x10AB, 1, 0x8002)));
+}
+
+TEST_F(UriFilterTest, Wildcards) {
+	const UriFilter filter(
+	    "local", makeUri("*", UriFilter::WILDCARD_ENTITY_ID,
+	                     UriFilter::WILDCARD_ENTITY_VERSION,
+	                     UriFilter::WILDCARD_RESOURCE_ID));
+
+	EXPECT_TRUE(filter.matches(makeUri("device", 0x10AB, 1, 0x8001)));
+	EXPECT_TRUE(filter.matches(makeUri("", 0x20CD, 3, 0)));
+}
+
+TEST_F(UriFilterTest, PartialWildcard) {
+	const UriFilter filter(
+	    "local",
+	    makeUri("device", 0x10AB, 1, UriFilter::WILDCARD_RESOURCE_ID));
+
+	EXPECT_TRUE(filter.matches(makeUri("device", 0x10AB, 1, 0x8001)));
+	EXPECT_TRUE(filter.matches(makeUri("device", 0x10AB, 1, 0x8002)));
+	EXPECT_FALSE(filter.matches(makeUri("device", 0x10AC, 1, 0x8001)));
+}
+
+TEST_F(UriFilterTest, EmptyAuthorityIsDefault) {
+	const UriFilter local_filter("local", makeUri("", 0x10AB, 1, 0x8001));
+	EXPECT_TRUE(local_filter.matches(makeUri("local", 0x10AB, 1, 0x8001)));
+	EXPECT_TRUE(local_filter.matches(makeUri("", 0x10AB, 1, 0x8001)));
+	EXPECT_FALSE(local_filter.matches(makeUri("device", 0x10AB, 1, 0x8001)));
+
+	const UriFilter named_filter("local", makeUri("local", 0x10AB, 1, 0x8001));
+	EXPECT_TRUE(named_filter.matches(makeUri("", 0x10AB, 1, 0x8001)));
+}
+
+TEST_F(UriFilterTest, Parse) {
+	auto uri = UriFilter::parse("//device/10AB/1/8001");
+	ASSERT_TRUE(uri.has_value());
+	EXPECT_EQ(uri->SerializeAsString(),
+	          makeUri("device", 0x10AB, 1, 0x8001).SerializeAsString());
+
+	uri = UriFilter::parse("up://*/*/*/*");
+	ASSERT_TRUE(uri.has_value());
+	EXPECT_EQ(uri->SerializeAsString(),
+	          makeUri("*", UriFilter::WILDCARD_ENTITY_ID,
+	                  UriFilter::WILDCARD_ENTITY_VERSION,
+	                  UriFilter::WILDCARD_RESOURCE_ID)
+	              .SerializeAsString());
+
+	uri = UriFilter::parse("/1000A/2/1");
+	ASSERT_TRUE(uri.has_value());
+	EXPECT_EQ(uri->SerializeAsString(),
+	          makeUri("", 0x1000A, 2, 1).SerializeAsString());
+}
+
+TEST_F(UriFilterTest, ParseRejectsMalformed) {
+	for (const auto* text :
+	     {"", "//device", "//device/10AB/1", "//device/10AB/1/8001/2",
+	      "///10AB/1/8001", "//device/10AB/100/8001", "//device/10AB/1/10000",
+	      "//device/xyz/1/8001", "//device/10AB//8001", "device/10AB/1/1"}) {
+		EXPECT_FALSE(UriFilter::parse(text).has_value()) << text;
+	}
+}
+
+}  // namespace
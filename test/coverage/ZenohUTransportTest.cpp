@@ -10,29 +10,1297 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include <gtest/gtest.h>
+#include <up-transport-zenoh-cpp/Tracing.h>
 #include <up-transport-zenoh-cpp/ZenohUTransport.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace {
 
-class TestFixture : public testing::Test {
+using namespace uprotocol;
+using namespace std::chrono_literals;
+
+constexpr auto RECEIVE_TIMEOUT = 1s;
+
+// Exposes sendImpl() so tests can hand the transport messages directly,
+// without going through the validation in UTransport::send().
+struct TestTransport : public transport::ZenohUTransport {
+	using transport::ZenohUTransport::sendImpl;
+	using transport::ZenohUTransport::ZenohUTransport;
+};
+
+// Collects messages delivered to a listener on the Zenoh receive thread
+class Receiver {
+public:
+	auto callback() {
+		return [this](const v1::UMessage& message) {
+			std::lock_guard lock(mutex_);
+			messages_.push_back(message);
+			cv_.notify_all();
+		};
+	}
+
+	bool waitFor(size_t count) {
+		std::unique_lock lock(mutex_);
+		return cv_.wait_for(lock, RECEIVE_TIMEOUT, [this, count]() {
+			return messages_.size() >= count;
+		});
+	}
+
+	std::vector<v1::UMessage> messages() {
+		std::lock_guard lock(mutex_);
+		return messages_;
+	}
+
+private:
+	std::mutex mutex_;
+	std::condition_variable cv_;
+	std::vector<v1::UMessage> messages_;
+};
+
+v1::UUri makeUri(const std::string& authority, uint32_t ue_id,
+                 uint32_t resource_id) {
+	v1::UUri uri;
+	uri.set_authority_name(authority);
+	uri.set_ue_id(ue_id);
+	uri.set_ue_version_major(1);
+	uri.set_resource_id(resource_id);
+	return uri;
+}
+
+v1::UMessage makePublish(const v1::UUri& topic, const std::string& payload) {
+	v1::UMessage message;
+	auto* attributes = message.mutable_attributes();
+	attributes->set_type(v1::UMessageType::UMESSAGE_TYPE_PUBLISH);
+	attributes->mutable_id()->set_msb(0x0123456789ABCDEF);
+	attributes->mutable_id()->set_lsb(0xFEDCBA9876543210);
+	attributes->set_priority(v1::UPriority::UPRIORITY_CS1);
+	*attributes->mutable_source() = topic;
+	message.set_payload(payload);
+	return message;
+}
+
+v1::UMessage makeRequest(const v1::UUri& source, const v1::UUri& method,
+                         const std::string& payload) {
+	v1::UMessage message;
+	auto* attributes = message.mutable_attributes();
+	attributes->set_type(v1::UMessageType::UMESSAGE_TYPE_REQUEST);
+	attributes->mutable_id()->set_msb(0x0123456789ABCDEF);
+	attributes->mutable_id()->set_lsb(0x1111111111111111);
+	attributes->set_priority(v1::UPriority::UPRIORITY_CS4);
+	attributes->set_ttl(1000);
+	*attributes->mutable_source() = source;
+	*attributes->mutable_sink() = method;
+	message.set_payload(payload);
+	return message;
+}
+
+v1::UMessage makeResponse(const v1::UMessage& request,
+                          const std::string& payload) {
+	v1::UMessage message;
+	auto* attributes = message.mutable_attributes();
+	attributes->set_type(v1::UMessageType::UMESSAGE_TYPE_RESPONSE);
+	attributes->mutable_id()->set_msb(0x0123456789ABCDEF);
+	attributes->mutable_id()->set_lsb(0x2222222222222222);
+	attributes->set_priority(request.attributes().priority());
+	*attributes->mutable_reqid() = request.attributes().id();
+	*attributes->mutable_source() = request.attributes().sink();
+	*attributes->mutable_sink() = request.attributes().source();
+	message.set_payload(payload);
+	return message;
+}
+
+class ZenohUTransportTest : public testing::Test {
 protected:
 	// Run once per TEST_F.
 	// Used to set up clean environments per test.
-	void SetUp() override {}
-	void TearDown() override {}
+	void SetUp() override {
+		transport_ = std::make_shared<TestTransport>(
+		    makeUri("test_device", 0x10AB, 0), ZENOH_CONFIG_FILE);
+	}
+	void TearDown() override { transport_.reset(); }
 
 	// Run once per execution of the test application.
 	// Used for setup of all tests. Has access to this instance.
-	TestFixture() = default;
-	~TestFixture() = default;
+	ZenohUTransportTest() = default;
+	~ZenohUTransportTest() = default;
 
 	// Run once per execution of the test application.
 	// Used only for global setup outside of tests.
 	static void SetUpTestSuite() {}
 	static void TearDownTestSuite() {}
+
+	std::shared_ptr<TestTransport> transport_;
 };
 
-// TODO replace
-TEST_F(TestFixture, SomeTestName) {}
+TEST_F(ZenohUTransportTest, ConstructDestroy) {
+	EXPECT_EQ(transport_->getDefaultSource().authority_name(), "test_device");
+}
+
+TEST_F(ZenohUTransportTest, MissingConfigThrows) {
+	EXPECT_ANY_THROW(TestTransport(makeUri("test_device", 0x10AB, 0),
+	                               "/nonexistent/ZenohUTransport.json5"));
+}
+
+TEST_F(ZenohUTransportTest, PublishSubscribe) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	const auto sent = makePublish(topic, "hello");
+	EXPECT_EQ(transport_->sendImpl(sent).code(), v1::UCode::OK);
+
+	ASSERT_TRUE(receiver.waitFor(1));
+	const auto received = receiver.messages().front();
+	EXPECT_EQ(received.payload(), sent.payload());
+	EXPECT_EQ(received.attributes().SerializeAsString(),
+	          sent.attributes().SerializeAsString());
+}
+
+TEST_F(ZenohUTransportTest, WildcardSinkFilter) {
+	Receiver receiver;
+	auto handle = transport_->registerListener(
+	    makeUri("test_device", 0x10AB, 0xFFFF), receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	EXPECT_EQ(transport_
+	              ->sendImpl(makePublish(makeUri("test_device", 0x10AB, 0x8001),
+	                                     "one"))
+	              .code(),
+	          v1::UCode::OK);
+	EXPECT_EQ(transport_
+	              ->sendImpl(makePublish(makeUri("test_device", 0x10AB, 0x8002),
+	                                     "two"))
+	              .code(),
+	          v1::UCode::OK);
+
+	EXPECT_TRUE(receiver.waitFor(2));
+}
+
+TEST_F(ZenohUTransportTest, SourceFilter) {
+	const auto sink = makeUri("test_device", 0x10AB, 0);
+	Receiver receiver;
+	auto handle = transport_->registerListener(
+	    sink, receiver.callback(), makeUri("other_device", 0x20CD, 0xFFFF));
+	ASSERT_TRUE(handle.has_value());
+
+	auto wanted = makePublish(makeUri("other_device", 0x20CD, 0x8001), "yes");
+	auto unwanted = makePublish(makeUri("third_device", 0x30EF, 0x8001), "no");
+	for (auto* message : {&unwanted, &wanted}) {
+		message->mutable_attributes()->set_type(
+		    v1::UMessageType::UMESSAGE_TYPE_NOTIFICATION);
+		*message->mutable_attributes()->mutable_sink() = sink;
+		EXPECT_EQ(transport_->sendImpl(*message).code(), v1::UCode::OK);
+	}
+
+	ASSERT_TRUE(receiver.waitFor(1));
+	const auto received = receiver.messages();
+	ASSERT_EQ(received.size(), 1);
+	EXPECT_EQ(received.front().payload(), "yes");
+}
+
+TEST_F(ZenohUTransportTest, SourceFilterInKey) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "SourceInKey.json5");
+	const auto sink = makeUri("test_device", 0x10AB, 0);
+	Receiver filtered;
+	Receiver unfiltered;
+	auto filtered_handle = transport.registerListener(
+	    sink, filtered.callback(), makeUri("other_device", 0x20CD, 0xFFFF));
+	auto unfiltered_handle =
+	    transport.registerListener(sink, unfiltered.callback());
+	ASSERT_TRUE(filtered_handle.has_value());
+	ASSERT_TRUE(unfiltered_handle.has_value());
+
+	auto wanted = makePublish(makeUri("other_device", 0x20CD, 0x8001), "yes");
+	auto unwanted = makePublish(makeUri("third_device", 0x30EF, 0x8001), "no");
+	for (auto* message : {&unwanted, &wanted}) {
+		message->mutable_attributes()->set_type(
+		    v1::UMessageType::UMESSAGE_TYPE_NOTIFICATION);
+		*message->mutable_attributes()->mutable_sink() = sink;
+		EXPECT_EQ(transport.sendImpl(*message).code(), v1::UCode::OK);
+	}
+
+	ASSERT_TRUE(filtered.waitFor(1));
+	ASSERT_TRUE(unfiltered.waitFor(2));
+	ASSERT_EQ(filtered.messages().size(), 1);
+	EXPECT_EQ(filtered.messages().front().payload(), "yes");
+
+	// The unwanted source never reached the filtered subscription
+	const auto metrics = transport.getMetrics();
+	ASSERT_TRUE(metrics.has_value());
+	const auto& topics = metrics->topics;
+	auto subscription = std::find_if(
+	    topics.begin(), topics.end(), [](const auto& topic) {
+		    return topic.key == "up/test_device/10AB/1/0/other_device/20CD/1/*";
+	    });
+	ASSERT_NE(subscription, topics.end());
+	EXPECT_EQ(subscription->messages_received, 1);
+
+	// Published messages carry no sink, and still reach their topic
+	const auto topic = makeUri("other_device", 0x20CD, 0x8001);
+	Receiver subscriber;
+	auto subscriber_handle =
+	    transport.registerListener(topic, subscriber.callback());
+	ASSERT_TRUE(subscriber_handle.has_value());
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "topic")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(subscriber.waitFor(1));
+	EXPECT_EQ(filtered.messages().size(), 1);
+}
+
+TEST_F(ZenohUTransportTest, SharedSubscription) {
+	const auto sink = makeUri("test_device", 0x10AB, 0);
+	Receiver any_source;
+	Receiver wanted_source;
+	Receiver other_source;
+	auto any_handle = transport_->registerListener(sink, any_source.callback());
+	auto wanted_handle =
+	    transport_->registerListener(sink, wanted_source.callback(),
+	                                 makeUri("other_device", 0x20CD, 0xFFFF));
+	auto other_handle =
+	    transport_->registerListener(sink, other_source.callback(),
+	                                 makeUri("third_device", 0x30EF, 0xFFFF));
+	ASSERT_TRUE(any_handle.has_value());
+	ASSERT_TRUE(wanted_handle.has_value());
+	ASSERT_TRUE(other_handle.has_value());
+	EXPECT_EQ(transport_->getSubscriptionCount(), 1);
+
+	auto message = makePublish(makeUri("other_device", 0x20CD, 0x8001), "x");
+	message.mutable_attributes()->set_type(
+	    v1::UMessageType::UMESSAGE_TYPE_NOTIFICATION);
+	*message.mutable_attributes()->mutable_sink() = sink;
+	EXPECT_EQ(transport_->sendImpl(message).code(), v1::UCode::OK);
+
+	EXPECT_TRUE(any_source.waitFor(1));
+	EXPECT_TRUE(wanted_source.waitFor(1));
+	EXPECT_TRUE(other_source.messages().empty());
+
+	// The subscriber stays until its last listener is cleaned up
+	any_handle.value().reset();
+	other_handle.value().reset();
+	EXPECT_EQ(transport_->getSubscriptionCount(), 1);
+	EXPECT_EQ(transport_->sendImpl(message).code(), v1::UCode::OK);
+	EXPECT_TRUE(wanted_source.waitFor(2));
+	EXPECT_EQ(any_source.messages().size(), 1);
+
+	wanted_handle.value().reset();
+	EXPECT_EQ(transport_->getSubscriptionCount(), 0);
+}
+
+TEST_F(ZenohUTransportTest, RegisterListeners) {
+	const auto first_topic = makeUri("test_device", 0x10AB, 0x8001);
+	const auto second_topic = makeUri("test_device", 0x10AB, 0x8002);
+	Receiver first;
+	Receiver second;
+	Receiver any_topic;
+	Receiver invalid;
+
+	std::vector<transport::ZenohUTransport::ListenerRegistration>
+	    registrations;
+	registrations.push_back({first_topic, first.callback()});
+	registrations.push_back(
+	    {makeUri("test_device", 0x10AB, 0xFFFF), any_topic.callback()});
+	registrations.push_back({second_topic, second.callback()});
+	registrations.push_back(
+	    {makeUri("bad#device", 0x10AB, 0x8001), invalid.callback()});
+	auto handles = transport_->registerListeners(std::move(registrations));
+
+	ASSERT_EQ(handles.size(), 4);
+	EXPECT_TRUE(handles[0].has_value());
+	EXPECT_TRUE(handles[1].has_value());
+	EXPECT_TRUE(handles[2].has_value());
+	ASSERT_FALSE(handles[3].has_value());
+	EXPECT_EQ(handles[3].error().code(), v1::UCode::INVALID_ARGUMENT);
+	// Both topics are covered by the wildcard
+	EXPECT_EQ(transport_->getSubscriptionCount(), 1);
+
+	EXPECT_EQ(transport_->sendImpl(makePublish(first_topic, "one")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(first.waitFor(1));
+	ASSERT_TRUE(any_topic.waitFor(1));
+	EXPECT_TRUE(second.messages().empty());
+
+	// The merged listeners keep the wildcard subscription
+	handles[1].value().reset();
+	EXPECT_EQ(transport_->getSubscriptionCount(), 1);
+	EXPECT_EQ(transport_->sendImpl(makePublish(second_topic, "two")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(second.waitFor(1));
+	EXPECT_EQ(first.messages().size(), 1);
+	EXPECT_EQ(any_topic.messages().size(), 1);
+
+	handles[0].value().reset();
+	handles[2].value().reset();
+	EXPECT_EQ(transport_->getSubscriptionCount(), 0);
+}
+
+TEST_F(ZenohUTransportTest, FanOutSharesMessage) {
+	for (const auto* config : {"ZenohUTransportTest.json5", "Dispatch.json5"}) {
+		TestTransport transport(
+		    makeUri("test_device", 0x10AB, 0),
+		    std::filesystem::path(TEST_CONFIG_DIR) / config);
+		const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+
+		std::mutex mutex;
+		std::vector<const v1::UMessage*> seen;
+		Receiver receiver;
+		auto record = [&mutex, &seen,
+		               callback = receiver.callback()](const v1::UMessage& m) {
+			{
+				std::lock_guard lock(mutex);
+				seen.push_back(&m);
+			}
+			callback(m);
+		};
+		auto first = transport.registerListener(topic, record);
+		auto second = transport.registerListener(topic, record);
+		ASSERT_TRUE(first.has_value());
+		ASSERT_TRUE(second.has_value());
+
+		EXPECT_EQ(transport.sendImpl(makePublish(topic, "hello")).code(),
+		          v1::UCode::OK);
+		ASSERT_TRUE(receiver.waitFor(2));
+
+		std::lock_guard lock(mutex);
+		ASSERT_EQ(seen.size(), 2);
+		EXPECT_EQ(seen[0], seen[1]) << config;
+	}
+}
+
+TEST_F(ZenohUTransportTest, ReceivedOnArena) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	std::promise<bool> on_arena;
+	auto handle = transport_->registerListener(
+	    topic, [&on_arena](const v1::UMessage& message) {
+		    on_arena.set_value(message.GetArena() != nullptr);
+	    });
+	ASSERT_TRUE(handle.has_value());
+
+	EXPECT_EQ(transport_->sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::OK);
+
+	auto received = on_arena.get_future();
+	ASSERT_EQ(received.wait_for(RECEIVE_TIMEOUT), std::future_status::ready);
+	EXPECT_TRUE(received.get());
+}
+
+TEST_F(ZenohUTransportTest, CompactAttributes) {
+	TestTransport compact(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "CompactAttributes.json5");
+
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	auto sent = makePublish(topic, "hello");
+	sent.mutable_attributes()->set_ttl(500);
+	sent.mutable_attributes()->set_traceparent("trace");
+	EXPECT_EQ(compact.sendImpl(sent).code(), v1::UCode::OK);
+
+	ASSERT_TRUE(receiver.waitFor(1));
+	const auto received = receiver.messages().front();
+	EXPECT_EQ(received.payload(), sent.payload());
+	EXPECT_EQ(received.attributes().SerializeAsString(),
+	          sent.attributes().SerializeAsString());
+}
+
+TEST_F(ZenohUTransportTest, PublisherCache) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "SmallPublisherCache.json5");
+
+	Receiver receiver;
+	auto handle = transport_->registerListener(
+	    makeUri("test_device", 0x10AB, 0xFFFF), receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	// The cache holds two publishers: the third topic evicts the first one
+	for (uint32_t resource_id : {0x8001, 0x8001, 0x8002, 0x8003, 0x8001}) {
+		EXPECT_EQ(transport
+		              .sendImpl(makePublish(
+		                  makeUri("test_device", 0x10AB, resource_id), "data"))
+		              .code(),
+		          v1::UCode::OK);
+	}
+	EXPECT_TRUE(receiver.waitFor(5));
+
+	const auto stats = transport.getPublisherCacheStats();
+	EXPECT_EQ(stats.hits, 1);
+	EXPECT_EQ(stats.misses, 4);
+	EXPECT_EQ(stats.evictions, 2);
+	EXPECT_EQ(stats.size, 2);
+	EXPECT_EQ(stats.capacity, 2);
+}
+
+TEST_F(ZenohUTransportTest, PublisherPerPriority) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	// Unspecified is sent as CS1, so it shares that publisher
+	for (auto priority :
+	     {v1::UPriority::UPRIORITY_CS1, v1::UPriority::UPRIORITY_CS6,
+	      v1::UPriority::UPRIORITY_UNSPECIFIED}) {
+		auto message = makePublish(topic, "data");
+		message.mutable_attributes()->set_priority(priority);
+		EXPECT_EQ(transport_->sendImpl(message).code(), v1::UCode::OK);
+	}
+	ASSERT_TRUE(receiver.waitFor(3));
+
+	const auto stats = transport_->getPublisherCacheStats();
+	EXPECT_EQ(stats.size, 2);
+	EXPECT_EQ(stats.hits, 1);
+}
+
+TEST_F(ZenohUTransportTest, SendBatch) {
+	Receiver receiver;
+	auto handle = transport_->registerListener(
+	    makeUri("test_device", 0x10AB, 0xFFFF), receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	const std::vector<v1::UMessage> batch{
+	    makePublish(makeUri("test_device", 0x10AB, 0x8001), "one"),
+	    makePublish(makeUri("bad#device", 0x10AB, 0x8001), "invalid"),
+	    makePublish(makeUri("test_device", 0x10AB, 0x8002), "two"),
+	    makePublish(makeUri("test_device", 0x10AB, 0x8001), "three")};
+
+	const auto statuses = transport_->sendBatch(batch);
+	ASSERT_EQ(statuses.size(), batch.size());
+	EXPECT_EQ(statuses[0].code(), v1::UCode::OK);
+	EXPECT_EQ(statuses[1].code(), v1::UCode::INVALID_ARGUMENT);
+	EXPECT_EQ(statuses[2].code(), v1::UCode::OK);
+	EXPECT_EQ(statuses[3].code(), v1::UCode::OK);
+
+	ASSERT_TRUE(receiver.waitFor(3));
+	const auto received = receiver.messages();
+	ASSERT_EQ(received.size(), 3);
+	EXPECT_EQ(received[0].payload(), "one");
+	EXPECT_EQ(received[1].payload(), "two");
+	EXPECT_EQ(received[2].payload(), "three");
+
+	EXPECT_TRUE(transport_->sendBatch(nullptr, 0).empty());
+}
+
+TEST_F(ZenohUTransportTest, AsyncSend) {
+	auto transport = std::make_unique<TestTransport>(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "AsyncSend.json5");
+	EXPECT_FALSE(transport_->getAsyncSendStats().has_value());
+	ASSERT_TRUE(transport->getAsyncSendStats().has_value());
+	EXPECT_EQ(transport->getAsyncSendStats()->capacity, 16);
+
+	Receiver receiver;
+	auto handle = transport_->registerListener(
+	    makeUri("test_device", 0x10AB, 0xFFFF), receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	EXPECT_EQ(transport
+	              ->sendImpl(makePublish(makeUri("test_device", 0x10AB, 0x8001),
+	                                     "one"))
+	              .code(),
+	          v1::UCode::OK);
+	const auto statuses = transport->sendBatch(
+	    {makePublish(makeUri("test_device", 0x10AB, 0x8002), "two"),
+	     makePublish(makeUri("bad#device", 0x10AB, 0x8002), "invalid")});
+	EXPECT_EQ(statuses[0].code(), v1::UCode::OK);
+	EXPECT_EQ(statuses[1].code(), v1::UCode::INVALID_ARGUMENT);
+
+	// Destroying the transport publishes whatever is still queued
+	transport.reset();
+	ASSERT_TRUE(receiver.waitFor(2));
+	const auto received = receiver.messages();
+	EXPECT_EQ(received[0].payload(), "one");
+	EXPECT_EQ(received[1].payload(), "two");
+}
+
+TEST_F(ZenohUTransportTest, DispatchThreads) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Dispatch.json5");
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+
+	// The first callback blocks its dispatch thread until released
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	Receiver receiver;
+	auto callback = receiver.callback();
+	auto handle = transport.registerListener(
+	    topic, [released, callback](const v1::UMessage& message) {
+		    released.wait();
+		    callback(message);
+	    });
+	ASSERT_TRUE(handle.has_value());
+
+	// Neither Zenoh nor the sender waits for the blocked callback
+	for (const auto* payload : {"one", "two", "three"}) {
+		EXPECT_EQ(transport.sendImpl(makePublish(topic, payload)).code(),
+		          v1::UCode::OK);
+	}
+	EXPECT_TRUE(receiver.messages().empty());
+
+	release.set_value();
+	ASSERT_TRUE(receiver.waitFor(3));
+	const auto received = receiver.messages();
+	EXPECT_EQ(received[0].payload(), "one");
+	EXPECT_EQ(received[1].payload(), "two");
+	EXPECT_EQ(received[2].payload(), "three");
+}
+
+// Gives a message a UUID created some time ago, and a TTL. The UUID is a
+// uProtocol (version 8) one unless another version is given.
+void setAge(v1::UMessage& message, std::chrono::milliseconds age,
+            std::chrono::milliseconds ttl, uint64_t version = 8) {
+	const auto created = std::chrono::duration_cast<std::chrono::milliseconds>(
+	    std::chrono::system_clock::now().time_since_epoch() - age);
+	auto* attributes = message.mutable_attributes();
+	attributes->mutable_id()->set_msb(
+	    (static_cast<uint64_t>(created.count()) << 16) | (version << 12));
+	attributes->set_ttl(static_cast<uint32_t>(ttl.count()));
+}
+
+TEST_F(ZenohUTransportTest, ExpiredNotSent) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Metrics.json5");
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport.registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	auto expired = makePublish(topic, "expired");
+	setAge(expired, 5s, 1s);
+	EXPECT_EQ(transport.sendImpl(expired).code(),
+	          v1::UCode::DEADLINE_EXCEEDED);
+	EXPECT_EQ(transport.sendBatch(&expired, 1).front().code(),
+	          v1::UCode::DEADLINE_EXCEEDED);
+
+	// Standard version 7 UUIDs hold their time the same way
+	auto expired_v7 = makePublish(topic, "expired v7");
+	setAge(expired_v7, 5s, 1s, 7);
+	EXPECT_EQ(transport.sendImpl(expired_v7).code(),
+	          v1::UCode::DEADLINE_EXCEEDED);
+
+	// Other versions hold no time, and never expire
+	auto untimed = makePublish(topic, "untimed");
+	setAge(untimed, 5s, 1s, 4);
+	EXPECT_EQ(transport.sendImpl(untimed).code(), v1::UCode::OK);
+
+	auto fresh = makePublish(topic, "fresh");
+	setAge(fresh, 0s, 5s);
+	EXPECT_EQ(transport.sendImpl(fresh).code(), v1::UCode::OK);
+	ASSERT_TRUE(receiver.waitFor(2));
+	EXPECT_EQ(receiver.messages().size(), 2);
+	EXPECT_EQ(receiver.messages()[0].payload(), "untimed");
+	EXPECT_EQ(receiver.messages()[1].payload(), "fresh");
+
+	const auto metrics = transport.getMetrics();
+	ASSERT_TRUE(metrics.has_value());
+	ASSERT_EQ(metrics->topics.size(), 1);
+	EXPECT_EQ(metrics->topics[0].messages_expired, 3);
+	EXPECT_EQ(metrics->topics[0].messages_sent, 2);
+}
+
+TEST_F(ZenohUTransportTest, ExpiredWhileDispatching) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Dispatch.json5");
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	Receiver receiver;
+	auto callback = receiver.callback();
+	auto handle = transport.registerListener(
+	    topic, [released, callback](const v1::UMessage& message) {
+		    released.wait();
+		    callback(message);
+	    });
+	ASSERT_TRUE(handle.has_value());
+
+	// The second message expires while it waits behind the first one
+	auto short_lived = makePublish(topic, "short lived");
+	setAge(short_lived, 0s, 20ms);
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "one")).code(),
+	          v1::UCode::OK);
+	EXPECT_EQ(transport.sendImpl(short_lived).code(), v1::UCode::OK);
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "two")).code(),
+	          v1::UCode::OK);
+	std::this_thread::sleep_for(50ms);
+
+	release.set_value();
+	ASSERT_TRUE(receiver.waitFor(2));
+	const auto received = receiver.messages();
+	ASSERT_EQ(received.size(), 2);
+	EXPECT_EQ(received[0].payload(), "one");
+	EXPECT_EQ(received[1].payload(), "two");
+}
+
+// Serves echo requests on method, replying from within the listener
+auto echoServer(TestTransport& transport, const v1::UUri& method) {
+	return transport.registerListener(
+	    method, [&transport](const v1::UMessage& request) {
+		    transport.sendImpl(
+		        makeResponse(request, "echo " + request.payload()));
+	    });
+}
+
+TEST_F(ZenohUTransportTest, RpcOverQuery) {
+	const auto method = makeUri("test_device", 0x20CD, 0x0001);
+	const auto client = makeUri("test_device", 0x10AB, 0);
+	auto server = echoServer(*transport_, method);
+	ASSERT_TRUE(server.has_value());
+
+	Receiver responses;
+	auto handle = transport_->registerListener(client, responses.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	const auto request = makeRequest(client, method, "hello");
+	EXPECT_EQ(transport_->sendImpl(request).code(), v1::UCode::OK);
+
+	ASSERT_TRUE(responses.waitFor(1));
+	const auto response = responses.messages().front();
+	EXPECT_EQ(response.payload(), "echo hello");
+	EXPECT_EQ(response.attributes().type(),
+	          v1::UMessageType::UMESSAGE_TYPE_RESPONSE);
+	EXPECT_EQ(response.attributes().reqid().SerializeAsString(),
+	          request.attributes().id().SerializeAsString());
+}
+
+TEST_F(ZenohUTransportTest, RpcWithoutServer) {
+	const auto method = makeUri("test_device", 0x20CD, 0x0001);
+	const auto client = makeUri("test_device", 0x10AB, 0);
+	Receiver responses;
+	auto handle = transport_->registerListener(client, responses.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	// No queryable answers, so the query completes without a reply
+	EXPECT_EQ(transport_->sendImpl(makeRequest(client, method, "hello"))
+	              .code(),
+	          v1::UCode::OK);
+	EXPECT_FALSE(responses.waitFor(1));
+}
+
+TEST_F(ZenohUTransportTest, RpcOverPublish) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "PubSubRpc.json5");
+
+	const auto method = makeUri("test_device", 0x20CD, 0x0001);
+	const auto client = makeUri("test_device", 0x10AB, 0);
+	auto server = echoServer(transport, method);
+	ASSERT_TRUE(server.has_value());
+
+	Receiver responses;
+	auto handle = transport.registerListener(client, responses.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	EXPECT_EQ(transport.sendImpl(makeRequest(client, method, "hello")).code(),
+	          v1::UCode::OK);
+
+	ASSERT_TRUE(responses.waitFor(1));
+	EXPECT_EQ(responses.messages().front().payload(), "echo hello");
+}
+
+TEST_F(ZenohUTransportTest, ChunkedPublish) {
+	TestTransport chunking(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Chunking.json5");
+
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	std::mutex mutex;
+	std::vector<std::string> chunks;
+	std::vector<uint64_t> offsets;
+	auto chunk_handle = transport_->registerChunkListener(
+	    topic, [&](const transport::MessageChunk& chunk) {
+		    std::lock_guard lock(mutex);
+		    chunks.push_back(chunk.message.payload());
+		    offsets.push_back(chunk.header.offset);
+		    EXPECT_EQ(chunk.header.count, 3);
+		    EXPECT_EQ(chunk.header.total_size, 10);
+	    });
+	ASSERT_TRUE(chunk_handle.has_value());
+
+	const auto sent = makePublish(topic, "0123456789");
+	EXPECT_EQ(chunking.sendImpl(sent).code(), v1::UCode::OK);
+
+	ASSERT_TRUE(receiver.waitFor(1));
+	ASSERT_EQ(receiver.messages().size(), 1);
+	EXPECT_EQ(receiver.messages().front().payload(), sent.payload());
+	EXPECT_EQ(receiver.messages().front().attributes().SerializeAsString(),
+	          sent.attributes().SerializeAsString());
+
+	std::lock_guard lock(mutex);
+	EXPECT_EQ(chunks, (std::vector<std::string>{"0123", "4567", "89"}));
+	EXPECT_EQ(offsets, (std::vector<uint64_t>{0, 4, 8}));
+}
+
+TEST_F(ZenohUTransportTest, ChunkListenerUnchunked) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	std::promise<std::pair<std::string, uint32_t>> received;
+	auto handle = transport_->registerChunkListener(
+	    topic, [&received](const transport::MessageChunk& chunk) {
+		    received.set_value({chunk.message.payload(), chunk.header.count});
+	    });
+	ASSERT_TRUE(handle.has_value());
+	EXPECT_EQ(transport_->getSubscriptionCount(), 1);
+
+	EXPECT_EQ(transport_->sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::OK);
+
+	auto chunk = received.get_future();
+	ASSERT_EQ(chunk.wait_for(RECEIVE_TIMEOUT), std::future_status::ready);
+	EXPECT_EQ(chunk.get(), std::make_pair(std::string("hello"), 1U));
+
+	handle->reset();
+	EXPECT_EQ(transport_->getSubscriptionCount(), 0);
+}
+
+TEST_F(ZenohUTransportTest, PullListener) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	EXPECT_FALSE(transport_->registerPullListener(topic, 0).has_value());
+
+	auto subscription = transport_->registerPullListener(topic, 3);
+	ASSERT_TRUE(subscription.has_value());
+	EXPECT_EQ(transport_->getSubscriptionCount(), 1);
+
+	std::vector<v1::UMessage> batch(2);
+	EXPECT_EQ(subscription->receive(batch, 0ms), 0);
+
+	for (const auto* payload : {"a", "b", "c", "d"}) {
+		EXPECT_EQ(transport_->sendImpl(makePublish(topic, payload)).code(),
+		          v1::UCode::OK);
+	}
+	ASSERT_EQ(subscription->receive(batch, RECEIVE_TIMEOUT), 2);
+	// The oldest message was overwritten by the fourth
+	EXPECT_EQ(batch[0].payload(), "b");
+	EXPECT_EQ(batch[1].payload(), "c");
+	EXPECT_EQ(subscription->dropped(), 1);
+	EXPECT_EQ(subscription->pending(), 1);
+	ASSERT_EQ(subscription->receive(batch, RECEIVE_TIMEOUT), 1);
+	EXPECT_EQ(batch[0].payload(), "d");
+
+	subscription->reset();
+	EXPECT_EQ(transport_->getSubscriptionCount(), 0);
+	EXPECT_EQ(subscription->receive(batch, 0ms), 0);
+}
+
+TEST_F(ZenohUTransportTest, CompressedPublish) {
+	const auto config =
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Compression.json5";
+	if (!transport::Compression::isAvailable(
+	        transport::Compression::Codec::ZSTD)) {
+		EXPECT_THROW(TestTransport(makeUri("test_device", 0x10AB, 0), config),
+		             std::invalid_argument);
+		return;
+	}
+	TestTransport compressing(makeUri("test_device", 0x10AB, 0), config);
+
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+
+	std::string large;
+	for (int i = 0; i < 100; ++i) {
+		large += R"({"dtc":"P0300","count":)" + std::to_string(i % 3) + "}";
+	}
+	EXPECT_EQ(compressing.sendImpl(makePublish(topic, large)).code(),
+	          v1::UCode::OK);
+	EXPECT_EQ(compressing.sendImpl(makePublish(topic, "small")).code(),
+	          v1::UCode::OK);
+
+	ASSERT_TRUE(receiver.waitFor(2));
+	const auto messages = receiver.messages();
+	EXPECT_EQ(messages[0].payload(), large);
+	EXPECT_EQ(messages[1].payload(), "small");
+}
+
+TEST_F(ZenohUTransportTest, Reliability) {
+	const auto config =
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Reliability.json5";
+	TestTransport reliable(makeUri("test_device", 0x10AB, 0), config);
+
+	// Listeners of different reliability get subscribers of their own,
+	// and messages of either reliability are still delivered
+	const auto best_effort = makeUri("test_device", 0x10AB, 0x8001);
+	const auto other = makeUri("test_device", 0x10AB, 0x8002);
+	Receiver wildcard_receiver;
+	Receiver topic_receiver;
+	auto wildcard_handle = reliable.registerListener(
+	    makeUri("test_device", 0x10AB, 0xFFFF),
+	    wildcard_receiver.callback());
+	auto topic_handle =
+	    reliable.registerListener(best_effort, topic_receiver.callback());
+	ASSERT_TRUE(wildcard_handle.has_value());
+	ASSERT_TRUE(topic_handle.has_value());
+
+	EXPECT_EQ(reliable.sendImpl(makePublish(best_effort, "dropped if late"))
+	              .code(),
+	          v1::UCode::OK);
+	EXPECT_EQ(reliable.sendImpl(makePublish(other, "never dropped")).code(),
+	          v1::UCode::OK);
+
+	ASSERT_TRUE(topic_receiver.waitFor(1));
+	ASSERT_TRUE(wildcard_receiver.waitFor(2));
+	EXPECT_EQ(topic_receiver.messages()[0].payload(), "dropped if late");
+	EXPECT_EQ(wildcard_receiver.messages()[1].payload(), "never dropped");
+}
+
+TEST_F(ZenohUTransportTest, SharedSession) {
+	const auto config_dir = std::filesystem::path(TEST_CONFIG_DIR);
+	auto subscriber = std::make_unique<TestTransport>(
+	    makeUri("test_device", 0x10AB, 0), config_dir / "SharedSession.json5");
+	// Same file, named differently
+	TestTransport publisher(makeUri("test_device", 0x20CD, 0),
+	                        config_dir / "." / "SharedSession.json5");
+
+	const auto topic = makeUri("test_device", 0x20CD, 0x8001);
+	Receiver receiver;
+	auto handle = subscriber->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	EXPECT_EQ(subscriber->getSubscriptionCount(), 1);
+	EXPECT_EQ(publisher.getSubscriptionCount(), 0);
+
+	EXPECT_EQ(publisher.sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(receiver.waitFor(1));
+	EXPECT_EQ(receiver.messages().front().payload(), "hello");
+
+	// The session outlives the instance that opened it
+	handle.value().reset();
+	subscriber.reset();
+	EXPECT_EQ(publisher.sendImpl(makePublish(topic, "again")).code(),
+	          v1::UCode::OK);
+}
+
+TEST_F(ZenohUTransportTest, LazySession) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "LazySession.json5");
+
+	// Whether or not the session is open yet, both go through
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport.registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "early")).code(),
+	          v1::UCode::OK);
+
+	auto ready = transport.getReadyFuture();
+	ASSERT_EQ(ready.wait_for(RECEIVE_TIMEOUT), std::future_status::ready);
+	EXPECT_EQ(ready.get().code(), v1::UCode::OK);
+
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "late")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(receiver.waitFor(2));
+	EXPECT_EQ(receiver.messages()[0].payload(), "early");
+	EXPECT_EQ(receiver.messages()[1].payload(), "late");
+
+	// Called right away once the session is open
+	bool called = false;
+	transport.onReady([&called](const v1::UStatus& status) {
+		called = (status.code() == v1::UCode::OK);
+	});
+	EXPECT_TRUE(called);
+}
+
+TEST_F(ZenohUTransportTest, ReadyWithoutLazySession) {
+	auto ready = transport_->getReadyFuture();
+	ASSERT_EQ(ready.wait_for(0s), std::future_status::ready);
+	EXPECT_EQ(ready.get().code(), v1::UCode::OK);
+}
+
+TEST_F(ZenohUTransportTest, Metrics) {
+	EXPECT_FALSE(transport_->getMetrics().has_value());
+
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Metrics.json5");
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver first;
+	Receiver second;
+	auto first_handle = transport.registerListener(topic, first.callback());
+	auto second_handle = transport.registerListener(topic, second.callback());
+	ASSERT_TRUE(first_handle.has_value());
+	ASSERT_TRUE(second_handle.has_value());
+
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(first.waitFor(1));
+	ASSERT_TRUE(second.waitFor(1));
+
+	auto metrics = transport.getMetrics();
+	ASSERT_TRUE(metrics.has_value());
+	ASSERT_EQ(metrics->topics.size(), 1);
+	const auto& topic_metrics = metrics->topics.front();
+	EXPECT_EQ(topic_metrics.key, "up/test_device/10AB/1/8001");
+	EXPECT_EQ(topic_metrics.messages_sent, 1);
+	EXPECT_EQ(topic_metrics.bytes_sent, 5);
+	EXPECT_EQ(topic_metrics.messages_received, 1);
+	EXPECT_EQ(topic_metrics.bytes_received, 5);
+	EXPECT_EQ(topic_metrics.serialize_time.count(), 1);
+	EXPECT_EQ(topic_metrics.send_time.count(), 1);
+	EXPECT_EQ(topic_metrics.decode_time.count(), 1);
+	EXPECT_EQ(topic_metrics.messages_dropped, 0);
+	// Counted once a callback returns, which may be after the receivers
+	// have been woken up
+	for (int i = 0; (i < 100) && (metrics->topics.front().messages_delivered <
+	                              2);
+	     ++i) {
+		std::this_thread::sleep_for(10ms);
+		metrics = transport.getMetrics();
+	}
+	EXPECT_EQ(metrics->topics.front().messages_delivered, 2);
+	EXPECT_EQ(metrics->topics.front().callback_time.count(), 2);
+
+	EXPECT_NE(metrics->toPrometheus().find(
+	              "up_transport_zenoh_messages_sent_total"
+	              "{key=\"up/test_device/10AB/1/8001\"} 1\n"),
+	          std::string::npos);
+}
+
+TEST_F(ZenohUTransportTest, Tracing) {
+	namespace tracing = transport::tracing;
+	struct Trace {
+		std::mutex mutex;
+		std::set<tracing::Stage> begun;
+		std::set<tracing::Stage> ended;
+	} trace;
+	tracing::setHook(
+	    [](tracing::Stage stage, tracing::Event event, void* context) {
+		    auto& seen = *static_cast<Trace*>(context);
+		    std::lock_guard lock(seen.mutex);
+		    (event == tracing::Event::BEGIN ? seen.begun : seen.ended)
+		        .insert(stage);
+	    },
+	    &trace);
+
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	EXPECT_EQ(transport_->sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(receiver.waitFor(1));
+	// The callback may still be returning
+	const auto dispatched = [&trace]() {
+		std::lock_guard lock(trace.mutex);
+		return trace.ended.count(tracing::Stage::DISPATCH) > 0;
+	};
+	for (int i = 0; tracing::ENABLED && (i < 100) && !dispatched(); ++i) {
+		std::this_thread::sleep_for(10ms);
+	}
+	tracing::setHook(nullptr);
+
+	std::lock_guard lock(trace.mutex);
+	if constexpr (tracing::ENABLED) {
+		const std::set<tracing::Stage> stages{
+		    tracing::Stage::KEY_EXPR, tracing::Stage::SERIALIZE,
+		    tracing::Stage::PUT,      tracing::Stage::RECEIVE,
+		    tracing::Stage::DECODE,   tracing::Stage::FILTER,
+		    tracing::Stage::DISPATCH};
+		EXPECT_EQ(trace.begun, stages);
+		EXPECT_EQ(trace.ended, stages);
+	} else {
+		EXPECT_TRUE(trace.begun.empty());
+		EXPECT_TRUE(trace.ended.empty());
+	}
+}
+
+TEST_F(ZenohUTransportTest, Loopback) {
+	const auto config =
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Loopback.json5";
+	TestTransport transport(makeUri("test_device", 0x10AB, 0), config);
+	TestTransport sibling(makeUri("test_device", 0x20CD, 0), config);
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver local;
+	Receiver on_sibling;
+	Receiver remote;
+	auto local_handle = transport.registerListener(topic, local.callback());
+	auto sibling_handle =
+	    sibling.registerListener(topic, on_sibling.callback());
+	auto remote_handle = transport_->registerListener(topic, remote.callback());
+	ASSERT_TRUE(local_handle.has_value());
+	ASSERT_TRUE(sibling_handle.has_value());
+	ASSERT_TRUE(remote_handle.has_value());
+
+	const auto sent = makePublish(topic, "hello");
+	EXPECT_EQ(transport.sendImpl(sent).code(), v1::UCode::OK);
+	ASSERT_TRUE(local.waitFor(1));
+	ASSERT_TRUE(on_sibling.waitFor(1));
+	ASSERT_TRUE(remote.waitFor(1));
+	EXPECT_EQ(local.messages().front().SerializeAsString(),
+	          sent.SerializeAsString());
+	EXPECT_EQ(remote.messages().front().payload(), "hello");
+
+	// Handed over as sent, never decoded from Zenoh, and only once
+	std::this_thread::sleep_for(50ms);
+	EXPECT_EQ(local.messages().size(), 1);
+	EXPECT_EQ(on_sibling.messages().size(), 1);
+	for (const auto* receiving : {&transport, &sibling}) {
+		const auto metrics = receiving->getMetrics();
+		ASSERT_TRUE(metrics.has_value());
+		ASSERT_EQ(metrics->topics.size(), 1);
+		EXPECT_EQ(metrics->topics.front().messages_received, 1);
+		EXPECT_EQ(metrics->topics.front().decode_time.count(), 0);
+	}
+}
+
+TEST_F(ZenohUTransportTest, LoopbackOnlyAccepted) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "LoopbackAsyncSend.json5");
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver local;
+	auto local_handle = transport.registerListener(topic, local.callback());
+	ASSERT_TRUE(local_handle.has_value());
+
+	// The remote listener holds up the I/O thread, so that the queue of one
+	// message fills up
+	std::promise<void> release;
+	auto released = release.get_future().share();
+	Receiver remote;
+	auto remote_callback = remote.callback();
+	auto remote_handle = transport_->registerListener(
+	    topic, [released, remote_callback](const v1::UMessage& message) {
+		    released.wait();
+		    remote_callback(message);
+	    });
+	ASSERT_TRUE(remote_handle.has_value());
+
+	std::vector<v1::UStatus> statuses;
+	for (int i = 0; i < 4; ++i) {
+		statuses.push_back(transport.sendImpl(makePublish(topic, "single")));
+	}
+	const std::vector<v1::UMessage> batch(2, makePublish(topic, "batch"));
+	for (auto& status : transport.sendBatch(batch.data(), batch.size())) {
+		statuses.push_back(std::move(status));
+	}
+	release.set_value();
+
+	size_t accepted = 0;
+	size_t exhausted = 0;
+	for (const auto& status : statuses) {
+		if (status.code() == v1::UCode::OK) {
+			++accepted;
+		} else if (status.code() == v1::UCode::RESOURCE_EXHAUSTED) {
+			++exhausted;
+		}
+	}
+	EXPECT_EQ(accepted + exhausted, statuses.size());
+	EXPECT_GT(exhausted, 0);
+
+	// Messages the queue turned away never reach local listeners
+	ASSERT_TRUE(local.waitFor(accepted));
+	ASSERT_TRUE(remote.waitFor(accepted));
+	std::this_thread::sleep_for(50ms);
+	EXPECT_EQ(local.messages().size(), accepted);
+	EXPECT_EQ(remote.messages().size(), accepted);
+}
+
+TEST_F(ZenohUTransportTest, LatestCache) {
+	const auto config =
+	    std::filesystem::path(TEST_CONFIG_DIR) / "LatestCache.json5";
+	TestTransport publisher(makeUri("test_device", 0x10AB, 0), config);
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	for (uint64_t i = 1; i <= 3; ++i) {
+		auto message = makePublish(topic, "value " + std::to_string(i));
+		message.mutable_attributes()->mutable_id()->set_lsb(i);
+		EXPECT_EQ(publisher.sendImpl(message).code(), v1::UCode::OK);
+	}
+
+	// A late joiner is handed the last two values without waiting for the
+	// next publish
+	TestTransport subscriber(makeUri("test_device", 0x20CD, 0), config);
+	EXPECT_TRUE(subscriber.getLatest(topic).empty());
+	Receiver receiver;
+	auto handle = subscriber.registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	ASSERT_TRUE(receiver.waitFor(2));
+	EXPECT_EQ(receiver.messages()[0].payload(), "value 2");
+	EXPECT_EQ(receiver.messages()[1].payload(), "value 3");
+
+	auto message = makePublish(topic, "value 4");
+	message.mutable_attributes()->mutable_id()->set_lsb(4);
+	EXPECT_EQ(publisher.sendImpl(message).code(), v1::UCode::OK);
+	ASSERT_TRUE(receiver.waitFor(3));
+
+	const auto latest = subscriber.getLatest(topic);
+	ASSERT_EQ(latest.size(), 2);
+	EXPECT_EQ(latest[0]->payload(), "value 3");
+	EXPECT_EQ(latest[1]->payload(), "value 4");
+
+	// The fixture transport has no cache
+	EXPECT_TRUE(transport_->getLatest(topic).empty());
+}
+
+TEST_F(ZenohUTransportTest, LatestCacheSkipsStaleReplies) {
+	const auto config =
+	    std::filesystem::path(TEST_CONFIG_DIR) / "LatestCache.json5";
+	const auto source = makeUri("test_device", 0x10AB, 0);
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+
+	// Two instances of the same publisher, the second one having kept an
+	// older value as well as the newest one
+	auto newest = makePublish(topic, "newest");
+	setAge(newest, 0s, 60s);
+	auto older = makePublish(topic, "older");
+	setAge(older, 5s, 60s);
+	TestTransport first(source, config);
+	EXPECT_EQ(first.sendImpl(newest).code(), v1::UCode::OK);
+	TestTransport second(source, config);
+	EXPECT_EQ(second.sendImpl(older).code(), v1::UCode::OK);
+	EXPECT_EQ(second.sendImpl(newest).code(), v1::UCode::OK);
+
+	TestTransport subscriber(makeUri("test_device", 0x20CD, 0), config);
+	Receiver receiver;
+	auto handle = subscriber.registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	ASSERT_TRUE(receiver.waitFor(1));
+	std::this_thread::sleep_for(50ms);
+
+	// Whichever instance replies first, the newest value comes last and
+	// only once
+	const auto received = receiver.messages();
+	ASSERT_LE(received.size(), 2);
+	EXPECT_EQ(received.back().payload(), "newest");
+	EXPECT_EQ(received.front().payload(),
+	          (received.size() == 2) ? "older" : "newest");
+}
+
+TEST_F(ZenohUTransportTest, LatestCacheLazySession) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	TestTransport publisher(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "LatestCache.json5");
+	EXPECT_EQ(publisher.sendImpl(makePublish(topic, "current")).code(),
+	          v1::UCode::OK);
+
+	// Queried once the session is open, if it is not yet
+	TestTransport subscriber(
+	    makeUri("test_device", 0x20CD, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "LazyLatestCache.json5");
+	Receiver receiver;
+	auto handle = subscriber.registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	ASSERT_TRUE(receiver.waitFor(1));
+	EXPECT_EQ(receiver.messages().front().payload(), "current");
+
+	// Counted like any other delivery
+	const auto metrics = subscriber.getMetrics();
+	ASSERT_TRUE(metrics.has_value());
+	ASSERT_EQ(metrics->topics.size(), 1);
+	EXPECT_EQ(metrics->topics[0].messages_delivered, 1);
+}
+
+TEST_F(ZenohUTransportTest, MatchingListener) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	EXPECT_FALSE(transport_->hasSubscribers(topic).has_value());
+
+	std::mutex mutex;
+	std::vector<bool> statuses;
+	auto record = [&mutex, &statuses](bool matching) {
+		std::lock_guard lock(mutex);
+		statuses.push_back(matching);
+	};
+	auto handle = transport_->registerMatchingListener(topic, record);
+	ASSERT_TRUE(handle.has_value());
+	EXPECT_EQ(transport_->hasSubscribers(topic), false);
+
+	// Subscribers of another session count as well
+	TestTransport subscriber(makeUri("test_device", 0x20CD, 0),
+	                         ZENOH_CONFIG_FILE);
+	Receiver receiver;
+	auto listener = subscriber.registerListener(topic, receiver.callback());
+	ASSERT_TRUE(listener.has_value());
+	EXPECT_EQ(transport_->hasSubscribers(topic), true);
+
+	listener->reset();
+	EXPECT_EQ(transport_->hasSubscribers(topic), false);
+	{
+		std::lock_guard lock(mutex);
+		EXPECT_EQ(statuses, (std::vector<bool>{false, true, false}));
+	}
+
+	// A second callback starts with the current status
+	bool second_status = true;
+	auto second = transport_->registerMatchingListener(
+	    topic, [&second_status](bool matching) { second_status = matching; });
+	ASSERT_TRUE(second.has_value());
+	EXPECT_FALSE(second_status);
+
+	handle->reset();
+	second->reset();
+	EXPECT_FALSE(transport_->hasSubscribers(topic).has_value());
+}
+
+TEST_F(ZenohUTransportTest, SkipUnmatched) {
+	TestTransport transport(
+	    makeUri("test_device", 0x10AB, 0),
+	    std::filesystem::path(TEST_CONFIG_DIR) / "Matching.json5");
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+
+	// Unwatched topics are always sent
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "sent")).code(),
+	          v1::UCode::OK);
+
+	auto handle = transport.registerMatchingListener(topic, [](bool) {});
+	ASSERT_TRUE(handle.has_value());
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "skipped")).code(),
+	          v1::UCode::UNAVAILABLE);
+
+	Receiver receiver;
+	auto listener = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(listener.has_value());
+	EXPECT_EQ(transport.sendImpl(makePublish(topic, "received")).code(),
+	          v1::UCode::OK);
+	ASSERT_TRUE(receiver.waitFor(1));
+	EXPECT_EQ(receiver.messages()[0].payload(), "received");
+}
+
+TEST_F(ZenohUTransportTest, InvalidKeyRejected) {
+	const auto topic = makeUri("bad#device", 0x10AB, 0x8001);
+	EXPECT_EQ(transport_->sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::INVALID_ARGUMENT);
+
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_FALSE(handle.has_value());
+	EXPECT_EQ(handle.error().code(), v1::UCode::INVALID_ARGUMENT);
+}
+
+TEST_F(ZenohUTransportTest, NoDeliveryAfterCleanup) {
+	const auto topic = makeUri("test_device", 0x10AB, 0x8001);
+	Receiver receiver;
+	auto handle = transport_->registerListener(topic, receiver.callback());
+	ASSERT_TRUE(handle.has_value());
+	handle.value().reset();
+
+	EXPECT_EQ(transport_->sendImpl(makePublish(topic, "hello")).code(),
+	          v1::UCode::OK);
+	EXPECT_FALSE(receiver.waitFor(1));
+}
 
 }  // namespace